@@ -0,0 +1,52 @@
+# Builds the web target with the browser loop and with ASYNCIFY, then prints their download sizes side by side
+# Usage: cmake -DBUILD_ROOT=<dir> -P cmake/CompareWebBuilds.cmake   (needs emcmake from the Emscripten SDK on PATH)
+
+if(NOT BUILD_ROOT)
+    set(BUILD_ROOT "${CMAKE_CURRENT_LIST_DIR}/../build-web-compare")
+endif()
+
+get_filename_component(SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+get_filename_component(BUILD_ROOT "${BUILD_ROOT}" ABSOLUTE)
+
+find_program(EMCMAKE emcmake)
+if(NOT EMCMAKE)
+    message(FATAL_ERROR "emcmake not found, activate the Emscripten SDK first")
+endif()
+
+foreach(VARIANT browser asyncify)
+    set(BUILD_DIR "${BUILD_ROOT}/${VARIANT}")
+    if(VARIANT STREQUAL "asyncify")
+        set(ASYNCIFY ON)
+    else()
+        set(ASYNCIFY OFF)
+    endif()
+
+    execute_process(
+        COMMAND ${EMCMAKE} ${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${BUILD_DIR}" -DPLATFORM_WEB=ON -DCMAKE_BUILD_TYPE=Release -DWEB_ASYNCIFY=${ASYNCIFY}
+        RESULT_VARIABLE RESULT)
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "Configuring the ${VARIANT} build failed")
+    endif()
+
+    execute_process(COMMAND ${CMAKE_COMMAND} --build "${BUILD_DIR}" --target index RESULT_VARIABLE RESULT)
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "Building the ${VARIANT} build failed")
+    endif()
+
+    file(SIZE "${BUILD_DIR}/index.wasm" ${VARIANT}_WASM)
+    file(SIZE "${BUILD_DIR}/index.js" ${VARIANT}_JS)
+    math(EXPR ${VARIANT}_WASM_KB "${${VARIANT}_WASM} / 1024")
+    math(EXPR ${VARIANT}_JS_KB "${${VARIANT}_JS} / 1024")
+endforeach()
+
+math(EXPR WASM_SAVED_KB "${asyncify_WASM_KB} - ${browser_WASM_KB}")
+math(EXPR JS_SAVED_KB "${asyncify_JS_KB} - ${browser_JS_KB}")
+
+message("")
+message("| Loop     | index.wasm | index.js |")
+message("|----------|------------|----------|")
+message("| browser  | ${browser_WASM_KB} KiB | ${browser_JS_KB} KiB |")
+message("| asyncify | ${asyncify_WASM_KB} KiB | ${asyncify_JS_KB} KiB |")
+message("| saved    | ${WASM_SAVED_KB} KiB | ${JS_SAVED_KB} KiB |")
+message("")
+message("Serve ${BUILD_ROOT}/<variant> and open index.html. The console logs the average frame CPU time every 10 s.")
@@ -0,0 +1,17 @@
+# Prints the size of the linked wasm module, used as a POST_BUILD step for web builds
+# Usage: cmake -DWASM_FILE=<path> -DVARIANT=<name> -P ReportWasmSize.cmake
+
+if(NOT EXISTS "${WASM_FILE}")
+    message(STATUS "wasm size (${VARIANT}): ${WASM_FILE} not found")
+    return()
+endif()
+
+if(CMAKE_VERSION VERSION_LESS 3.14)
+    message(STATUS "wasm size (${VARIANT}): needs CMake 3.14 or newer")
+    return()
+endif()
+
+file(SIZE "${WASM_FILE}" WASM_SIZE)
+math(EXPR WASM_SIZE_KB "${WASM_SIZE} / 1024")
+
+message(STATUS "wasm size (${VARIANT}): ${WASM_SIZE} bytes (${WASM_SIZE_KB} KiB)")
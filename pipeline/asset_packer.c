@@ -0,0 +1,285 @@
+// Asset archive packer
+// Decodes the textures and sounds listed in assets/archive_manifest.txt and writes them into one archive the desktop
+// build maps at startup, so no file is opened or decoded one by one. Runs at build time after the atlas target,
+// see the archive target in CMakeLists.txt. The file layout is described in sources/asset_archive.h.
+//
+// Usage: asset_packer <manifest> <assets dir> <atlas dir> <output file>
+//
+// Manifest lines:
+//   texture <path>   PNG under the assets directory, stored as RGB8 when every pixel is opaque and as RGBA8 otherwise
+//   sound <path>     WAV under the assets directory, stored as 16 bit PCM
+//   atlas <dir>      every page in <atlas dir>/<dir>/atlas_regions.txt, named atlas/<dir>/<file>
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "asset_archive.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include "stb_image.h"
+
+#define DR_WAV_IMPLEMENTATION
+#include "dr_wav.h"
+
+#define PACKER_MAX_ENTRIES 256
+#define PACKER_PATH_LENGTH 512
+
+typedef struct PackedAsset {
+    ArchiveEntry entry;
+    void* data;
+    bool isWave;    // Allocated by dr_wav instead of stb_image
+} PackedAsset;
+
+PackedAsset assets[PACKER_MAX_ENTRIES];
+int assetCount = 0;
+int opaqueTextureCount = 0;
+
+PackedAsset* AddAsset(const char* name)
+{
+    if (assetCount >= PACKER_MAX_ENTRIES)
+    {
+        fprintf(stderr, "asset_packer: more than %d assets\n", PACKER_MAX_ENTRIES);
+        return NULL;
+    }
+
+    if (strlen(name) >= ASSET_ARCHIVE_NAME_LENGTH)
+    {
+        fprintf(stderr, "asset_packer: name %s is longer than %d characters\n", name, ASSET_ARCHIVE_NAME_LENGTH - 1);
+        return NULL;
+    }
+
+    PackedAsset* asset = &assets[assetCount];
+    memset(asset, 0, sizeof(PackedAsset));
+    strcpy(asset->entry.name, name);
+    return asset;
+}
+
+bool PackTexture(const char* name, const char* path)
+{
+    PackedAsset* asset = AddAsset(name);
+    if (asset == NULL)
+        return false;
+
+    int width, height, channels;
+    asset->data = stbi_load(path, &width, &height, &channels, 4);
+    if (asset->data == NULL)
+    {
+        fprintf(stderr, "asset_packer: cannot load %s (%s)\n", path, stbi_failure_reason());
+        return false;
+    }
+
+    // Backgrounds have no transparent pixel, dropping their alpha channel saves a quarter of their size
+    unsigned char* pixels = (unsigned char*)asset->data;
+    size_t pixelCount = (size_t)width * height;
+    bool opaque = true;
+    for (size_t i = 0; i < pixelCount && opaque; i++)
+        opaque = pixels[i * 4 + 3] == 255;
+
+    if (opaque)
+    {
+        for (size_t i = 0; i < pixelCount; i++)
+            memmove(&pixels[i * 3], &pixels[i * 4], 3);
+        opaqueTextureCount++;
+    }
+
+    asset->entry.kind = ARCHIVE_TEXTURE;
+    asset->entry.width = (uint32_t)width;
+    asset->entry.height = (uint32_t)height;
+    asset->entry.format = opaque ? ASSET_ARCHIVE_PIXELFORMAT_RGB8 : ASSET_ARCHIVE_PIXELFORMAT_RGBA8;
+    asset->entry.size = (uint64_t)pixelCount * (opaque ? 3 : 4);
+    assetCount++;
+    return true;
+}
+
+bool PackSound(const char* name, const char* path)
+{
+    PackedAsset* asset = AddAsset(name);
+    if (asset == NULL)
+        return false;
+
+    unsigned int channels, sampleRate;
+    drwav_uint64 frameCount;
+    asset->data = drwav_open_file_and_read_pcm_frames_s16(path, &channels, &sampleRate, &frameCount, NULL);
+    if (asset->data == NULL)
+    {
+        fprintf(stderr, "asset_packer: cannot load %s\n", path);
+        return false;
+    }
+
+    asset->isWave = true;
+    asset->entry.kind = ARCHIVE_SOUND;
+    asset->entry.frameCount = (uint32_t)frameCount;
+    asset->entry.sampleRate = sampleRate;
+    asset->entry.channels = channels;
+    asset->entry.size = (uint64_t)frameCount * channels * 2;
+    assetCount++;
+    return true;
+}
+
+bool PackAtlasPages(const char* atlasDir, const char* dir)
+{
+    char path[PACKER_PATH_LENGTH * 2];
+    snprintf(path, sizeof(path), "%s/%s/atlas_regions.txt", atlasDir, dir);
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "asset_packer: cannot open %s, build the atlas target first\n", path);
+        return false;
+    }
+
+    char line[1024];
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), file) != NULL)
+    {
+        int page;
+        char pageFile[PACKER_PATH_LENGTH];
+        if (sscanf(line, "page %d %511s", &page, pageFile) != 2)
+            continue;
+
+        // Same name the game builds from ATLAS_PATH
+        char name[PACKER_PATH_LENGTH * 2];
+        if (strcmp(dir, ".") == 0)
+            snprintf(name, sizeof(name), "atlas/%s", pageFile);
+        else
+            snprintf(name, sizeof(name), "atlas/%s/%s", dir, pageFile);
+
+        snprintf(path, sizeof(path), "%s/%s/%s", atlasDir, dir, pageFile);
+        ok = PackTexture(name, path);
+    }
+
+    fclose(file);
+    return ok;
+}
+
+bool ReadManifest(const char* manifestPath, const char* assetsDir, const char* atlasDir)
+{
+    FILE* file = fopen(manifestPath, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "asset_packer: cannot open manifest %s\n", manifestPath);
+        return false;
+    }
+
+    char line[1024];
+    int lineNumber = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+
+        char* text = line;
+        while (*text == ' ' || *text == '\t')
+            text++;
+
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0')
+            continue;
+
+        char kind[16];
+        char name[PACKER_PATH_LENGTH];
+        if (sscanf(text, "%15s %511s", kind, name) != 2)
+        {
+            fprintf(stderr, "asset_packer: %s:%d: expected <kind> <path>\n", manifestPath, lineNumber);
+            ok = false;
+            break;
+        }
+
+        char path[PACKER_PATH_LENGTH * 2];
+        snprintf(path, sizeof(path), "%s/%s", assetsDir, name);
+
+        if (strcmp(kind, "texture") == 0)
+            ok = PackTexture(name, path);
+        else if (strcmp(kind, "sound") == 0)
+            ok = PackSound(name, path);
+        else if (strcmp(kind, "atlas") == 0)
+            ok = PackAtlasPages(atlasDir, name);
+        else
+        {
+            fprintf(stderr, "asset_packer: %s:%d: unknown kind %s\n", manifestPath, lineNumber, kind);
+            ok = false;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + ASSET_ARCHIVE_ALIGNMENT - 1) / ASSET_ARCHIVE_ALIGNMENT * ASSET_ARCHIVE_ALIGNMENT;
+}
+
+bool WriteArchive(const char* outputPath)
+{
+    uint64_t offset = sizeof(ArchiveHeader) + (uint64_t)assetCount * sizeof(ArchiveEntry);
+    for (int i = 0; i < assetCount; i++)
+    {
+        offset = AlignOffset(offset);
+        assets[i].entry.offset = offset;
+        offset += assets[i].entry.size;
+    }
+
+    FILE* file = fopen(outputPath, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "asset_packer: cannot write %s\n", outputPath);
+        return false;
+    }
+
+    ArchiveHeader header = { 0 };
+    memcpy(header.magic, ASSET_ARCHIVE_MAGIC, sizeof(ASSET_ARCHIVE_MAGIC));
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = (uint32_t)assetCount;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; ok && i < assetCount; i++)
+        ok = fwrite(&assets[i].entry, sizeof(ArchiveEntry), 1, file) == 1;
+
+    static const unsigned char padding[ASSET_ARCHIVE_ALIGNMENT] = { 0 };
+    for (int i = 0; ok && i < assetCount; i++)
+    {
+        long position = ftell(file);
+        size_t gap = (size_t)(assets[i].entry.offset - (uint64_t)position);
+        ok = (gap == 0 || fwrite(padding, 1, gap, file) == gap)
+            && fwrite(assets[i].data, 1, (size_t)assets[i].entry.size, file) == (size_t)assets[i].entry.size;
+    }
+
+    if (fclose(file) != 0 || !ok)
+    {
+        fprintf(stderr, "asset_packer: cannot write %s\n", outputPath);
+        remove(outputPath);
+        return false;
+    }
+
+    printf("asset_packer: %d assets (%d textures stored without alpha), %.1f MB\n", assetCount, opaqueTextureCount, offset / (1024.0 * 1024.0));
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 5)
+    {
+        fprintf(stderr, "Usage: %s <manifest> <assets dir> <atlas dir> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = ReadManifest(argv[1], argv[2], argv[3])
+        && WriteArchive(argv[4]);
+
+    for (int i = 0; i < assetCount; i++)
+    {
+        if (assets[i].isWave)
+            drwav_free(assets[i].data, NULL);
+        else
+            stbi_image_free(assets[i].data);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,462 @@
+// Texture atlas packer
+// Packs the images listed in assets/atlas_manifest.txt into a few atlas pages and writes a region table
+// the game loads at startup. Runs at build time, see the atlas target in CMakeLists.txt.
+//
+// Usage: atlas_packer <manifest> <assets dir> <output dir> [page size] [scale]
+//
+// Manifest lines are <name> <frames> <source> [<source> ...]. With a single source the frames are laid out
+// left to right in it, with several sources each one is a frame. Scale resizes every frame before packing,
+// it is how the customer tiers are made from the full size art.
+//
+// Output:
+//   <output dir>/atlas_<n>.png        atlas pages
+//   <output dir>/atlas_regions.txt    one line per page and per region:
+//     page <index> <file> <width> <height>
+//     region <name> <page> <x> <y> <width> <height> <frames> <columns> <frame width> <frame height> <source width> <source height>
+//   The source size is the unscaled size of all frames side by side, so the game draws every tier at the same size.
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include "stb_image.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "stb_rect_pack.h"
+
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include "stb_image_resize2.h"
+
+#define ATLAS_MAX_ENTRIES 256
+#define ATLAS_MAX_PAGES 16
+#define ATLAS_NAME_LENGTH 64
+#define ATLAS_PATH_LENGTH 512
+#define ATLAS_MAX_SOURCES 8
+#define ATLAS_DEFAULT_PAGE_SIZE 2048
+
+// Transparent gap between regions so bilinear filtering never picks up a neighbour
+#define ATLAS_PADDING 2
+
+typedef struct AtlasEntry {
+    char name[ATLAS_NAME_LENGTH];
+    char sources[ATLAS_MAX_SOURCES][ATLAS_PATH_LENGTH];
+    int sourceCount;
+    int frames;
+
+    unsigned char* pixels; // Frames side by side, already scaled
+    int sourceWidth;
+    int sourceHeight;
+
+    int frameWidth;
+    int frameHeight;
+    int columns;
+    int width;
+    int height;
+
+    int page;
+    int x;
+    int y;
+} AtlasEntry;
+
+typedef struct AtlasPage {
+    int width;
+    int height;
+    unsigned char* pixels;
+} AtlasPage;
+
+AtlasEntry entries[ATLAS_MAX_ENTRIES];
+int entryCount = 0;
+
+AtlasPage pages[ATLAS_MAX_PAGES];
+int pageCount = 0;
+
+bool ReadManifest(const char* manifestPath)
+{
+    FILE* file = fopen(manifestPath, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "atlas_packer: cannot open manifest %s\n", manifestPath);
+        return false;
+    }
+
+    char line[1024];
+    int lineNumber = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+
+        char* text = line;
+        while (*text == ' ' || *text == '\t')
+            text++;
+
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0')
+            continue;
+
+        if (entryCount >= ATLAS_MAX_ENTRIES)
+        {
+            fprintf(stderr, "atlas_packer: more than %d entries in manifest\n", ATLAS_MAX_ENTRIES);
+            fclose(file);
+            return false;
+        }
+
+        AtlasEntry* entry = &entries[entryCount];
+        int consumed = 0;
+        if (sscanf(text, "%63s %d%n", entry->name, &entry->frames, &consumed) != 2 || entry->frames < 1)
+        {
+            fprintf(stderr, "atlas_packer: %s:%d: expected <name> <frames> <source>\n", manifestPath, lineNumber);
+            fclose(file);
+            return false;
+        }
+
+        text += consumed;
+        entry->sourceCount = 0;
+        while (entry->sourceCount < ATLAS_MAX_SOURCES && sscanf(text, "%511s%n", entry->sources[entry->sourceCount], &consumed) == 1)
+        {
+            entry->sourceCount++;
+            text += consumed;
+        }
+
+        if (entry->sourceCount == 0 || (entry->sourceCount > 1 && entry->sourceCount != entry->frames))
+        {
+            fprintf(stderr, "atlas_packer: %s:%d: %s needs one source, or one source per frame\n", manifestPath, lineNumber, entry->name);
+            fclose(file);
+            return false;
+        }
+
+        entryCount++;
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Loads every source of an entry into one strip of frames, unscaled
+unsigned char* LoadSourceStrip(AtlasEntry* entry, const char* assetsPath)
+{
+    char path[ATLAS_PATH_LENGTH * 2];
+    unsigned char* images[ATLAS_MAX_SOURCES] = { 0 };
+    int widths[ATLAS_MAX_SOURCES] = { 0 };
+    unsigned char* strip = NULL;
+    bool ok = true;
+
+    entry->sourceWidth = 0;
+    entry->sourceHeight = 0;
+
+    for (int i = 0; i < entry->sourceCount && ok; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", assetsPath, entry->sources[i]);
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        images[i] = stbi_load(path, &width, &height, &channels, 4);
+        if (images[i] == NULL)
+        {
+            fprintf(stderr, "atlas_packer: cannot load %s (%s)\n", path, stbi_failure_reason());
+            ok = false;
+        }
+        else if (i > 0 && height != entry->sourceHeight)
+        {
+            fprintf(stderr, "atlas_packer: %s is %d high, the other frames of %s are %d\n", entry->sources[i], height, entry->name, entry->sourceHeight);
+            ok = false;
+        }
+
+        widths[i] = width;
+        entry->sourceWidth += width;
+        entry->sourceHeight = height;
+    }
+
+    if (ok && entry->sourceCount == 1)
+    {
+        strip = images[0];
+        images[0] = NULL;
+    }
+    else if (ok)
+    {
+        strip = malloc((size_t)entry->sourceWidth * entry->sourceHeight * 4);
+
+        int x = 0;
+        for (int i = 0; strip != NULL && i < entry->sourceCount; i++)
+        {
+            for (int row = 0; row < entry->sourceHeight; row++)
+                memcpy(strip + ((size_t)row * entry->sourceWidth + x) * 4, images[i] + (size_t)row * widths[i] * 4, (size_t)widths[i] * 4);
+            x += widths[i];
+        }
+    }
+
+    for (int i = 0; i < entry->sourceCount; i++)
+        stbi_image_free(images[i]);
+
+    return strip;
+}
+
+bool LoadEntries(const char* assetsPath, int pageSize, float scale)
+{
+    for (int i = 0; i < entryCount; i++)
+    {
+        AtlasEntry* entry = &entries[i];
+
+        unsigned char* strip = LoadSourceStrip(entry, assetsPath);
+        if (strip == NULL)
+            return false;
+
+        if (entry->sourceWidth % entry->frames != 0)
+            fprintf(stderr, "atlas_packer: warning: %s is %d wide, not a multiple of %d frames\n", entry->name, entry->sourceWidth, entry->frames);
+
+        int sourceFrameWidth = entry->sourceWidth / entry->frames;
+
+        entry->frameWidth = (int)(sourceFrameWidth * scale + 0.5f);
+        entry->frameHeight = (int)(entry->sourceHeight * scale + 0.5f);
+        if (entry->frameWidth < 1)
+            entry->frameWidth = 1;
+        if (entry->frameHeight < 1)
+            entry->frameHeight = 1;
+
+        if (entry->frameWidth == sourceFrameWidth && entry->frameHeight == entry->sourceHeight && entry->sourceWidth == entry->frames * sourceFrameWidth)
+        {
+            entry->pixels = strip;
+        }
+        else
+        {
+            // Frames are resized one by one so neighbouring frames never bleed into each other
+            int stripWidth = entry->frames * entry->frameWidth;
+            entry->pixels = malloc((size_t)stripWidth * entry->frameHeight * 4);
+            if (entry->pixels == NULL)
+            {
+                free(strip);
+                return false;
+            }
+
+            for (int frame = 0; frame < entry->frames; frame++)
+            {
+                stbir_resize_uint8_srgb(strip + (size_t)frame * sourceFrameWidth * 4, sourceFrameWidth, entry->sourceHeight, entry->sourceWidth * 4,
+                    entry->pixels + (size_t)frame * entry->frameWidth * 4, entry->frameWidth, entry->frameHeight, stripWidth * 4, STBIR_RGBA);
+            }
+
+            free(strip);
+        }
+
+        // Long strips (the kettle has 17 frames) are wrapped into rows so they fit on a page
+        entry->columns = entry->frames;
+        while (entry->columns > 1 && entry->columns * entry->frameWidth + ATLAS_PADDING > pageSize)
+            entry->columns--;
+
+        int rows = (entry->frames + entry->columns - 1) / entry->columns;
+        entry->width = entry->columns * entry->frameWidth;
+        entry->height = rows * entry->frameHeight;
+
+        if (entry->width + ATLAS_PADDING > pageSize || entry->height + ATLAS_PADDING > pageSize)
+        {
+            fprintf(stderr, "atlas_packer: %s (%dx%d) does not fit on a %dx%d page\n", entry->name, entry->width, entry->height, pageSize, pageSize);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PackEntries(int pageSize)
+{
+    stbrp_rect* rects = calloc(entryCount, sizeof(stbrp_rect));
+    stbrp_node* nodes = calloc(pageSize, sizeof(stbrp_node));
+    if (rects == NULL || nodes == NULL)
+    {
+        free(rects);
+        free(nodes);
+        return false;
+    }
+
+    for (int i = 0; i < entryCount; i++)
+        entries[i].page = -1;
+
+    int remaining = entryCount;
+
+    while (remaining > 0)
+    {
+        if (pageCount >= ATLAS_MAX_PAGES)
+        {
+            fprintf(stderr, "atlas_packer: more than %d pages needed\n", ATLAS_MAX_PAGES);
+            free(rects);
+            free(nodes);
+            return false;
+        }
+
+        int rectCount = 0;
+        for (int i = 0; i < entryCount; i++)
+        {
+            if (entries[i].page != -1)
+                continue;
+
+            rects[rectCount].id = i;
+            rects[rectCount].w = entries[i].width + ATLAS_PADDING;
+            rects[rectCount].h = entries[i].height + ATLAS_PADDING;
+            rectCount++;
+        }
+
+        stbrp_context context;
+        stbrp_init_target(&context, pageSize, pageSize, nodes, pageSize);
+        stbrp_pack_rects(&context, rects, rectCount);
+
+        int page = pageCount++;
+        int usedHeight = 0;
+        int packed = 0;
+
+        for (int r = 0; r < rectCount; r++)
+        {
+            if (!rects[r].was_packed)
+                continue;
+
+            AtlasEntry* entry = &entries[rects[r].id];
+            entry->page = page;
+            entry->x = rects[r].x;
+            entry->y = rects[r].y;
+            packed++;
+
+            if (entry->y + entry->height > usedHeight)
+                usedHeight = entry->y + entry->height;
+        }
+
+        if (packed == 0)
+        {
+            fprintf(stderr, "atlas_packer: could not place any of the remaining %d images\n", remaining);
+            free(rects);
+            free(nodes);
+            return false;
+        }
+
+        remaining -= packed;
+
+        // Trim the unused bottom of the page, mostly matters for the last one
+        pages[page].width = pageSize;
+        pages[page].height = (usedHeight + 3) & ~3;
+    }
+
+    free(rects);
+    free(nodes);
+    return true;
+}
+
+void BlitEntry(AtlasEntry* entry)
+{
+    AtlasPage* page = &pages[entry->page];
+    int stripWidth = entry->frames * entry->frameWidth;
+
+    for (int frame = 0; frame < entry->frames; frame++)
+    {
+        int sourceX = frame * entry->frameWidth;
+        int destX = entry->x + (frame % entry->columns) * entry->frameWidth;
+        int destY = entry->y + (frame / entry->columns) * entry->frameHeight;
+
+        for (int row = 0; row < entry->frameHeight; row++)
+        {
+            const unsigned char* source = entry->pixels + ((size_t)row * stripWidth + sourceX) * 4;
+            unsigned char* dest = page->pixels + ((size_t)(destY + row) * page->width + destX) * 4;
+            memcpy(dest, source, (size_t)entry->frameWidth * 4);
+        }
+    }
+}
+
+bool WritePages(const char* outputPath)
+{
+    char path[ATLAS_PATH_LENGTH * 2];
+
+    for (int p = 0; p < pageCount; p++)
+    {
+        pages[p].pixels = calloc((size_t)pages[p].width * pages[p].height, 4);
+        if (pages[p].pixels == NULL)
+            return false;
+    }
+
+    for (int i = 0; i < entryCount; i++)
+        BlitEntry(&entries[i]);
+
+    for (int p = 0; p < pageCount; p++)
+    {
+        snprintf(path, sizeof(path), "%s/atlas_%d.png", outputPath, p);
+        if (!stbi_write_png(path, pages[p].width, pages[p].height, 4, pages[p].pixels, pages[p].width * 4))
+        {
+            fprintf(stderr, "atlas_packer: cannot write %s\n", path);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool WriteRegions(const char* outputPath)
+{
+    char path[ATLAS_PATH_LENGTH * 2];
+    snprintf(path, sizeof(path), "%s/atlas_regions.txt", outputPath);
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "atlas_packer: cannot write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "# Generated by atlas_packer, do not edit\n");
+
+    for (int p = 0; p < pageCount; p++)
+        fprintf(file, "page %d atlas_%d.png %d %d\n", p, p, pages[p].width, pages[p].height);
+
+    for (int i = 0; i < entryCount; i++)
+    {
+        AtlasEntry* entry = &entries[i];
+        fprintf(file, "region %s %d %d %d %d %d %d %d %d %d %d %d\n",
+            entry->name, entry->page, entry->x, entry->y, entry->width, entry->height,
+            entry->frames, entry->columns, entry->frameWidth, entry->frameHeight, entry->sourceWidth, entry->sourceHeight);
+    }
+
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        fprintf(stderr, "Usage: %s <manifest> <assets dir> <output dir> [page size] [scale]\n", argv[0]);
+        return 1;
+    }
+
+    int pageSize = argc > 4 ? atoi(argv[4]) : ATLAS_DEFAULT_PAGE_SIZE;
+    if (pageSize <= 0)
+        pageSize = ATLAS_DEFAULT_PAGE_SIZE;
+
+    float scale = argc > 5 ? (float)atof(argv[5]) : 1.0f;
+    if (scale <= 0.0f)
+        scale = 1.0f;
+
+    bool ok = ReadManifest(argv[1])
+        && LoadEntries(argv[2], pageSize, scale)
+        && PackEntries(pageSize)
+        && WritePages(argv[3])
+        && WriteRegions(argv[3]);
+
+    long packedPixels = 0;
+    long pagePixels = 0;
+    for (int i = 0; i < entryCount; i++)
+        packedPixels += (long)entries[i].width * entries[i].height;
+    for (int p = 0; p < pageCount; p++)
+        pagePixels += (long)pages[p].width * pages[p].height;
+
+    if (ok)
+        printf("atlas_packer: %d images packed into %d pages (%.1f%% used)\n", entryCount, pageCount, pagePixels > 0 ? 100.0 * packedPixels / pagePixels : 0.0);
+
+    for (int i = 0; i < entryCount; i++)
+        free(entries[i].pixels);
+    for (int p = 0; p < pageCount; p++)
+        free(pages[p].pixels);
+
+    return ok ? 0 : 1;
+}
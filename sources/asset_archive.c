@@ -0,0 +1,260 @@
+// madvise is not part of strict C99 with glibc
+#define _DEFAULT_SOURCE
+
+#include "asset_archive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#define ARCHIVE_MAPPING 1
+#elif defined(__EMSCRIPTEN__)
+// The preloaded file system lives in memory already, mapping it would only copy it again
+#define ARCHIVE_MAPPING 0
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARCHIVE_MAPPING 1
+#endif
+
+struct AssetArchive {
+    const unsigned char* data;
+    size_t size;
+    bool mapped;
+
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    const ArchiveEntry* entries;
+    uint32_t entryCount;
+};
+
+static bool MapArchive(AssetArchive* archive, const char* path)
+{
+#if defined(_WIN32)
+    archive->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (archive->file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(archive->file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(archive->file);
+        return false;
+    }
+
+    archive->mapping = CreateFileMappingA(archive->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (archive->mapping == NULL)
+    {
+        CloseHandle(archive->file);
+        return false;
+    }
+
+    archive->data = (const unsigned char*)MapViewOfFile(archive->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (archive->data == NULL)
+    {
+        CloseHandle(archive->mapping);
+        CloseHandle(archive->file);
+        return false;
+    }
+
+    archive->size = (size_t)size.QuadPart;
+    archive->mapped = true;
+    return true;
+#elif ARCHIVE_MAPPING
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size <= 0)
+    {
+        close(file);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps the file alive
+    close(file);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    archive->data = (const unsigned char*)data;
+    archive->size = (size_t)info.st_size;
+    archive->mapped = true;
+    return true;
+#else
+    (void)archive;
+    (void)path;
+    return false;
+#endif
+}
+
+static bool ReadArchive(AssetArchive* archive, const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = size > 0 ? (unsigned char*)malloc((size_t)size) : NULL;
+    if (data == NULL || fread(data, 1, (size_t)size, file) != (size_t)size)
+    {
+        free(data);
+        fclose(file);
+        return false;
+    }
+
+    fclose(file);
+    archive->data = data;
+    archive->size = (size_t)size;
+    archive->mapped = false;
+    return true;
+}
+
+static void ReleaseArchive(AssetArchive* archive)
+{
+    if (archive->data == NULL)
+        return;
+
+    if (!archive->mapped)
+        free((void*)archive->data);
+#if defined(_WIN32)
+    else
+    {
+        UnmapViewOfFile(archive->data);
+        CloseHandle(archive->mapping);
+        CloseHandle(archive->file);
+    }
+#elif ARCHIVE_MAPPING
+    else
+        munmap((void*)archive->data, archive->size);
+#endif
+
+    archive->data = NULL;
+}
+
+// Every entry has to lie inside the file and match its own description, the data is handed to the GPU unchecked
+static bool ValidateArchive(AssetArchive* archive)
+{
+    if (archive->size < sizeof(ArchiveHeader))
+        return false;
+
+    const ArchiveHeader* header = (const ArchiveHeader*)archive->data;
+    if (memcmp(header->magic, ASSET_ARCHIVE_MAGIC, sizeof(ASSET_ARCHIVE_MAGIC)) != 0 || header->version != ASSET_ARCHIVE_VERSION)
+        return false;
+
+    if (header->entryCount > (archive->size - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry))
+        return false;
+
+    archive->entries = (const ArchiveEntry*)(archive->data + sizeof(ArchiveHeader));
+    archive->entryCount = header->entryCount;
+
+    for (uint32_t i = 0; i < archive->entryCount; i++)
+    {
+        const ArchiveEntry* entry = &archive->entries[i];
+
+        if (memchr(entry->name, '\0', ASSET_ARCHIVE_NAME_LENGTH) == NULL)
+            return false;
+        if (entry->offset > archive->size || entry->size > archive->size - entry->offset)
+            return false;
+
+        uint64_t expected = 0;
+        if (entry->kind == ARCHIVE_TEXTURE && entry->format == ASSET_ARCHIVE_PIXELFORMAT_RGB8)
+            expected = (uint64_t)entry->width * entry->height * 3;
+        else if (entry->kind == ARCHIVE_TEXTURE && entry->format == ASSET_ARCHIVE_PIXELFORMAT_RGBA8)
+            expected = (uint64_t)entry->width * entry->height * 4;
+        else if (entry->kind == ARCHIVE_SOUND)
+            expected = (uint64_t)entry->frameCount * entry->channels * 2;
+
+        if (expected == 0 || expected != entry->size)
+            return false;
+    }
+
+    return true;
+}
+
+AssetArchive* OpenAssetArchive(const char* path)
+{
+    AssetArchive* archive = (AssetArchive*)calloc(1, sizeof(AssetArchive));
+    if (archive == NULL)
+        return NULL;
+
+    if (!MapArchive(archive, path) && !ReadArchive(archive, path))
+    {
+        free(archive);
+        return NULL;
+    }
+
+    if (!ValidateArchive(archive))
+    {
+        CloseAssetArchive(archive);
+        return NULL;
+    }
+
+    return archive;
+}
+
+void CloseAssetArchive(AssetArchive* archive)
+{
+    if (archive == NULL)
+        return;
+
+    ReleaseArchive(archive);
+    free(archive);
+}
+
+const ArchiveEntry* FindArchiveEntry(const AssetArchive* archive, const char* name)
+{
+    if (archive == NULL)
+        return NULL;
+
+    for (uint32_t i = 0; i < archive->entryCount; i++)
+    {
+        if (strcmp(archive->entries[i].name, name) == 0)
+            return &archive->entries[i];
+    }
+
+    return NULL;
+}
+
+const void* GetArchiveEntryData(const AssetArchive* archive, const ArchiveEntry* entry)
+{
+    return archive->data + entry->offset;
+}
+
+size_t GetAssetArchiveSize(const AssetArchive* archive)
+{
+    return archive != NULL ? archive->size : 0;
+}
+
+bool IsAssetArchiveMapped(const AssetArchive* archive)
+{
+    return archive != NULL && archive->mapped;
+}
+
+void DiscardAssetArchivePages(AssetArchive* archive)
+{
+    if (archive == NULL || !archive->mapped)
+        return;
+
+#if defined(_WIN32)
+    // Unlocking pages that were never locked just trims them from the working set
+    VirtualUnlock((LPVOID)archive->data, archive->size);
+#elif ARCHIVE_MAPPING
+    madvise((void*)archive->data, archive->size, MADV_DONTNEED);
+#endif
+}
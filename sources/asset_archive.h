@@ -0,0 +1,71 @@
+// Asset archive, one file holding decoded textures and sounds, written at build time by pipeline/asset_packer.c
+// The packer includes this header for the file layout.
+//
+// Layout, little endian:
+//   ArchiveHeader
+//   ArchiveEntry[entryCount]
+//   data, every entry starts on an ASSET_ARCHIVE_ALIGNMENT boundary
+// Textures are stored as RGB8 pixels when fully opaque and as RGBA8 otherwise, sounds as interleaved 16 bit PCM, so
+// both can be handed to raylib as they are.
+
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASSET_ARCHIVE_MAGIC "MEOWPAK"
+#define ASSET_ARCHIVE_VERSION 2
+#define ASSET_ARCHIVE_NAME_LENGTH 100
+#define ASSET_ARCHIVE_ALIGNMENT 64
+
+// Same values as raylib's PIXELFORMAT_UNCOMPRESSED_R8G8B8 and PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+#define ASSET_ARCHIVE_PIXELFORMAT_RGB8 4
+#define ASSET_ARCHIVE_PIXELFORMAT_RGBA8 7
+
+typedef enum {
+    ARCHIVE_TEXTURE = 1,
+    ARCHIVE_SOUND = 2
+} ArchiveEntryKind;
+
+typedef struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+} ArchiveHeader;
+
+typedef struct ArchiveEntry {
+    // Path relative to the assets directory, atlas pages are under atlas/
+    char name[ASSET_ARCHIVE_NAME_LENGTH];
+    uint32_t kind;
+
+    // Textures
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;    // ASSET_ARCHIVE_PIXELFORMAT_*
+
+    // Sounds
+    uint32_t frameCount;
+    uint32_t sampleRate;
+    uint32_t channels;  // Samples are always 16 bit
+
+    uint64_t offset;    // From the start of the file
+    uint64_t size;
+} ArchiveEntry;
+
+typedef struct AssetArchive AssetArchive;
+
+// Maps the archive on desktop, reads it into memory where mapping is not available. NULL when missing or invalid.
+AssetArchive* OpenAssetArchive(const char* path);
+void CloseAssetArchive(AssetArchive* archive);
+
+const ArchiveEntry* FindArchiveEntry(const AssetArchive* archive, const char* name);
+const void* GetArchiveEntryData(const AssetArchive* archive, const ArchiveEntry* entry);
+size_t GetAssetArchiveSize(const AssetArchive* archive);
+bool IsAssetArchiveMapped(const AssetArchive* archive);
+
+// Lets the system drop the mapped pages once their contents were uploaded, they are read back from disk if needed again
+void DiscardAssetArchivePages(AssetArchive* archive);
+
+#endif
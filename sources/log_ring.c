@@ -0,0 +1,319 @@
+// nanosleep and localtime_r are not part of strict C99 with glibc
+#define _DEFAULT_SOURCE
+
+#include "log_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef HANDLE RingThread;
+
+#define RING_THREADS 1
+#elif defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+// Single threaded web build, the main thread flushes every frame
+typedef int RingThread;
+
+#define RING_THREADS 0
+#else
+#include <pthread.h>
+
+typedef pthread_t RingThread;
+
+#define RING_THREADS 1
+#endif
+
+#define LOG_RING_MASK (LOG_RING_CAPACITY - 1)
+
+typedef struct LogSlot {
+    // Position + 1 once written, position + LOG_RING_CAPACITY once flushed and free for the next lap
+    volatile uint32_t sequence;
+    LogRecord record;
+} LogSlot;
+
+struct LogRing {
+    LogSlot slots[LOG_RING_CAPACITY];
+    volatile uint32_t writeIndex;
+    volatile uint32_t dropped;
+    volatile uint32_t stopping;
+
+    // Only touched by whoever flushes
+    uint32_t readIndex;
+    uint32_t droppedReported;
+    int64_t formattedTime;
+    char timeText[32];
+
+    FILE* output;
+    RingThread thread;
+    bool threaded;
+};
+
+static uint32_t LoadAcquire(volatile uint32_t* value)
+{
+#if defined(_WIN32)
+    return (uint32_t)InterlockedOr((volatile LONG*)value, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void StoreRelease(volatile uint32_t* value, uint32_t desired)
+{
+#if defined(_WIN32)
+    InterlockedExchange((volatile LONG*)value, (LONG)desired);
+#else
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+#endif
+}
+
+// On failure expected receives the current value
+static bool CompareExchange(volatile uint32_t* value, uint32_t* expected, uint32_t desired)
+{
+#if defined(_WIN32)
+    uint32_t previous = (uint32_t)InterlockedCompareExchange((volatile LONG*)value, (LONG)desired, (LONG)*expected);
+    if (previous == *expected)
+        return true;
+    *expected = previous;
+    return false;
+#else
+    return __atomic_compare_exchange_n(value, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void Increment(volatile uint32_t* value)
+{
+#if defined(_WIN32)
+    InterlockedIncrement((volatile LONG*)value);
+#else
+    __atomic_add_fetch(value, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static void AcquireFence(void)
+{
+#if defined(_WIN32)
+    MemoryBarrier();
+#else
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+}
+
+static void SleepMilliseconds(int milliseconds)
+{
+#if defined(_WIN32)
+    Sleep((DWORD)milliseconds);
+#elif RING_THREADS
+    struct timespec duration = { milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L };
+    nanosleep(&duration, NULL);
+#else
+    (void)milliseconds;
+#endif
+}
+
+const char* GetLogLevelPrefix(int level)
+{
+    switch (level)
+    {
+        case LOG_RING_DEBUG: return "[DEBUG]: ";
+        case LOG_RING_INFO: return "[INFO] : ";
+        case LOG_RING_WARNING: return "[WARN] : ";
+        case LOG_RING_ERROR: return "[ERROR]: ";
+        case LOG_RING_FATAL: return "[FATAL]: ";
+        default: return "";
+    }
+}
+
+// Messages mostly arrive in bursts within the same second, the time is only formatted again when it changes
+static const char* FormatLogTime(LogRing* ring, int64_t seconds)
+{
+    if (seconds == ring->formattedTime && ring->timeText[0] != '\0')
+        return ring->timeText;
+
+    time_t now = (time_t)seconds;
+    struct tm local;
+#if defined(_WIN32)
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+
+    strftime(ring->timeText, sizeof(ring->timeText), "%Y-%m-%d %H:%M:%S", &local);
+    ring->formattedTime = seconds;
+    return ring->timeText;
+}
+
+// Only one thread may drain at a time, the flush thread or the caller of FlushLogRing and DestroyLogRing
+static int DrainLogRing(LogRing* ring)
+{
+    int written = 0;
+
+    for (;;)
+    {
+        LogSlot* slot = &ring->slots[ring->readIndex & LOG_RING_MASK];
+        if (LoadAcquire(&slot->sequence) != ring->readIndex + 1)
+            break;
+
+        fprintf(ring->output, "[%s] %s%s\n", FormatLogTime(ring, slot->record.time), GetLogLevelPrefix(slot->record.level), slot->record.text);
+
+        StoreRelease(&slot->sequence, ring->readIndex + LOG_RING_CAPACITY);
+        ring->readIndex++;
+        written++;
+    }
+
+    uint32_t dropped = LoadAcquire(&ring->dropped);
+    if (dropped != ring->droppedReported)
+    {
+        fprintf(ring->output, "%s%u log messages dropped, the ring was full\n", GetLogLevelPrefix(LOG_RING_WARNING), dropped - ring->droppedReported);
+        ring->droppedReported = dropped;
+        written++;
+    }
+
+    if (written > 0)
+        fflush(ring->output);
+
+    return written;
+}
+
+#if RING_THREADS
+#if defined(_WIN32)
+static DWORD WINAPI FlushWorker(LPVOID argument)
+#else
+static void* FlushWorker(void* argument)
+#endif
+{
+    LogRing* ring = (LogRing*)argument;
+
+    for (;;)
+    {
+        // Read before draining, so everything written before the stop request is still flushed
+        bool stopping = LoadAcquire(&ring->stopping) != 0;
+
+        if (DrainLogRing(ring) == 0 && !stopping)
+            SleepMilliseconds(LOG_RING_FLUSH_INTERVAL_MS);
+
+        if (stopping)
+            break;
+    }
+
+    return 0;
+}
+#endif
+
+LogRing* CreateLogRing(FILE* output)
+{
+    LogRing* ring = (LogRing*)calloc(1, sizeof(LogRing));
+    if (ring == NULL)
+        return NULL;
+
+    for (uint32_t i = 0; i < LOG_RING_CAPACITY; i++)
+        ring->slots[i].sequence = i;
+
+    ring->output = output != NULL ? output : stdout;
+
+#if defined(_WIN32)
+    ring->thread = CreateThread(NULL, 0, FlushWorker, ring, 0, NULL);
+    ring->threaded = ring->thread != NULL;
+#elif RING_THREADS
+    ring->threaded = pthread_create(&ring->thread, NULL, FlushWorker, ring) == 0;
+#endif
+
+    return ring;
+}
+
+void DestroyLogRing(LogRing* ring)
+{
+    if (ring == NULL)
+        return;
+
+    StoreRelease(&ring->stopping, 1);
+
+    if (ring->threaded)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(ring->thread, INFINITE);
+        CloseHandle(ring->thread);
+#elif RING_THREADS
+        pthread_join(ring->thread, NULL);
+#endif
+    }
+
+    DrainLogRing(ring);
+    free(ring);
+}
+
+bool WriteLogRing(LogRing* ring, int level, const char* format, va_list args)
+{
+    uint32_t position = LoadAcquire(&ring->writeIndex);
+    LogSlot* slot;
+
+    for (;;)
+    {
+        slot = &ring->slots[position & LOG_RING_MASK];
+        int32_t lag = (int32_t)(LoadAcquire(&slot->sequence) - position);
+
+        if (lag == 0)
+        {
+            if (CompareExchange(&ring->writeIndex, &position, position + 1))
+                break;
+        }
+        else if (lag < 0)
+        {
+            // The slot still holds a message from the previous lap that was not written out
+            Increment(&ring->dropped);
+            return false;
+        }
+        else
+            position = LoadAcquire(&ring->writeIndex);
+    }
+
+    slot->record.level = level;
+    slot->record.time = (int64_t)time(NULL);
+    vsnprintf(slot->record.text, LOG_RING_MESSAGE_LENGTH, format, args);
+
+    StoreRelease(&slot->sequence, position + 1);
+    return true;
+}
+
+void FlushLogRing(LogRing* ring)
+{
+    if (ring != NULL && !ring->threaded)
+        DrainLogRing(ring);
+}
+
+int ReadRecentLogs(LogRing* ring, LogRecord* records, int count)
+{
+    if (ring == NULL)
+        return 0;
+
+    uint32_t end = LoadAcquire(&ring->writeIndex);
+    uint32_t available = end < LOG_RING_CAPACITY ? end : LOG_RING_CAPACITY;
+    int found = 0;
+
+    for (uint32_t i = 0; i < available && found < count; i++)
+    {
+        uint32_t position = end - 1 - i;
+        LogSlot* slot = &ring->slots[position & LOG_RING_MASK];
+
+        // Skip messages that are still being formatted
+        uint32_t sequence = LoadAcquire(&slot->sequence);
+        if (sequence != position + 1 && sequence != position + LOG_RING_CAPACITY)
+            continue;
+
+        memcpy(&records[found], &slot->record, sizeof(LogRecord));
+        AcquireFence();
+
+        // A writer claims the slot before filling it again, if it was claimed meanwhile the copy may be torn.
+        // Every older slot was claimed before this one, so there is nothing left to read.
+        if (LoadAcquire(&ring->writeIndex) - position > LOG_RING_CAPACITY)
+            break;
+
+        records[found].text[LOG_RING_MESSAGE_LENGTH - 1] = '\0';
+        found++;
+    }
+
+    return found;
+}
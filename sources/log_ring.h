@@ -0,0 +1,53 @@
+// Log ring, the fixed set of slots every log message is formatted into
+//
+// Any thread can write. A writer claims a slot with one compare and swap and formats straight into it,
+// nothing is allocated and no lock is taken. A flush thread writes finished slots to the output file and
+// hands them back. When every slot is still waiting to be written the message is dropped and counted, the
+// next flush reports how many were lost. Builds without threads (web without pthreads) flush from the main
+// thread with FlushLogRing.
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Must be a power of two
+#define LOG_RING_CAPACITY 2048
+#define LOG_RING_MESSAGE_LENGTH 256
+#define LOG_RING_FLUSH_INTERVAL_MS 10
+
+// Same values as raylib's TraceLogLevel
+#define LOG_RING_DEBUG 2
+#define LOG_RING_INFO 3
+#define LOG_RING_WARNING 4
+#define LOG_RING_ERROR 5
+#define LOG_RING_FATAL 6
+
+typedef struct LogRecord {
+    int level;
+    int64_t time;   // Seconds since the epoch
+    char text[LOG_RING_MESSAGE_LENGTH];
+} LogRecord;
+
+typedef struct LogRing LogRing;
+
+// The output stays owned by the caller and must outlive the ring
+LogRing* CreateLogRing(FILE* output);
+// Stops the flush thread and writes out everything still in the ring
+void DestroyLogRing(LogRing* ring);
+
+// Messages longer than LOG_RING_MESSAGE_LENGTH are cut, returns false when the message was dropped
+bool WriteLogRing(LogRing* ring, int level, const char* format, va_list args);
+// Writes finished messages out on the calling thread, does nothing while a flush thread runs
+void FlushLogRing(LogRing* ring);
+
+// Copies up to count of the latest messages, newest first, whether or not they were written out yet
+int ReadRecentLogs(LogRing* ring, LogRecord* records, int count);
+
+// Prefix written in front of each message, such as "[WARN] : "
+const char* GetLogLevelPrefix(int level);
+
+#endif
@@ -1,16 +1,39 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h> 
 #include <string.h>
 
+#include "asset_archive.h"
+#include "log_ring.h"
+#include "platform_memory.h"
+#include "task_pool.h"
+
+#if defined(PLATFORM_WEB)
+#include <emscripten/emscripten.h>
+#endif
+
 // Web
 #define IS_WEB true
 
+// Browser builds hand the frame loop to emscripten unless built with ASYNCIFY for comparison
+#if defined(PLATFORM_WEB) && !defined(WEB_ASYNCIFY)
+#define USE_BROWSER_MAIN_LOOP 1
+#define MAIN_LOOP_NAME "browser"
+#elif defined(PLATFORM_WEB)
+#define USE_BROWSER_MAIN_LOOP 0
+#define MAIN_LOOP_NAME "asyncify"
+#else
+#define USE_BROWSER_MAIN_LOOP 0
+#define MAIN_LOOP_NAME "native"
+#endif
+
 // Constants
 #define NO_BUTTON -1  // Add this constant for button states
 
@@ -36,18 +59,30 @@ const float gameDuration = 60.0f * 2.0f;
 int DebugFpsHistory[DEBUG_MAX_FPS_HISTORY];
 int DebugFpsHistoryIndex = 0;
 
-// Debug frame time history
+// Debug frame time history, microseconds between the starts of consecutive frames
 int DebugFrameTimeHistory[DEBUG_MAX_FPS_HISTORY];
 int DebugFrameTimeHistoryIndex = 0;
+int DebugFrameTimeHistoryCount = 0;
+double DebugLastFrameStart = 0.0;
+
+// A frame counts as over budget when it takes this much longer than the target frame time, the limiter jitters a little
+#define DEBUG_FRAME_BUDGET_SLACK 1.1
+
+// Every message goes through the log ring, the debug log view reads its latest entries back from it
+LogRing* logRing = NULL;
+FILE* logFile = NULL;
 
-// Debug logs history
-typedef struct DebugLogEntry {
-	int type;
-	char* text;
-} DebugLogEntry;
+// Levels below this are compiled out, release builds drop LogDebug calls entirely
+#if !defined(LOG_COMPILE_LEVEL)
+#if defined(NDEBUG)
+#define LOG_COMPILE_LEVEL LOG_RING_INFO
+#else
+#define LOG_COMPILE_LEVEL LOG_RING_DEBUG
+#endif
+#endif
 
-DebugLogEntry DebugLogs[DEBUG_MAX_LOGS_HISTORY];
-int DebugLogsIndex = 0;
+// Messages below this level are dropped, the headless simulation only keeps warnings
+int minimumLogLevel = LOG_ALL;
 
 // Debug tool toggles states
 typedef struct DebugToolToggles {
@@ -55,13 +90,97 @@ typedef struct DebugToolToggles {
 	bool showStats;
 	bool showGraph;
     bool showObjects;
+    bool showAssets;
+    bool showProfiler;
+    bool showOverdraw;
 } DebugToolToggles;
 
 DebugToolToggles debugToolToggles = { false, true, false, false };
 
+#if LOG_COMPILE_LEVEL > LOG_RING_DEBUG
+#define LogDebug(...) ((void)0)
+#else
 void LogDebug(const char* text, ...);
+#endif
 void Log(int msgType, const char* text, ...);
 
+// Profiler
+// PROFILE_BEGIN and PROFILE_END wrap a phase of the frame, zones nest and are recorded into the current frame's buffer.
+// Nothing is recorded unless the flame view (F6) is open or --trace <file> writes a Chrome trace
+// (chrome://tracing or ui.perfetto.dev). The headless simulation compiles the zones out.
+#define PROFILER_MAX_ZONES 256
+#define PROFILER_MAX_DEPTH 16
+// The flame view holds on to the slowest frame for this long, so a single stutter can be read
+#define PROFILER_HOLD_TIME 2.0
+
+typedef struct ProfileZone {
+    const char* name;   // String literal, never copied
+    double start;
+    double end;
+    int depth;
+} ProfileZone;
+
+typedef struct FrameProfile {
+    ProfileZone zones[PROFILER_MAX_ZONES];
+    int zoneCount;
+    double start;
+    double end;
+} FrameProfile;
+
+typedef struct Profiler {
+    bool recording;
+    FrameProfile frames[2];   // Recording and last finished
+    int current;
+    FrameProfile slowest;
+
+    // Indices into the current frame, -1 for zones that did not fit
+    int stack[PROFILER_MAX_DEPTH];
+    int depth;
+    int droppedZones;
+
+    FILE* trace;
+    int traceEvents;
+    double traceOrigin;
+} Profiler;
+
+Profiler profiler = { 0 };
+
+void BeginProfileZone(const char* name)
+{
+    FrameProfile* frame = &profiler.frames[profiler.current];
+    int index = -1;
+
+    if (frame->zoneCount < PROFILER_MAX_ZONES && profiler.depth < PROFILER_MAX_DEPTH)
+    {
+        index = frame->zoneCount++;
+        frame->zones[index] = (ProfileZone){ name, GetTime(), 0.0, profiler.depth };
+    }
+    else
+        profiler.droppedZones++;
+
+    if (profiler.depth < PROFILER_MAX_DEPTH)
+        profiler.stack[profiler.depth] = index;
+    profiler.depth++;
+}
+
+void EndProfileZone(void)
+{
+    if (profiler.depth == 0)
+        return;
+
+    profiler.depth--;
+    if (profiler.depth < PROFILER_MAX_DEPTH && profiler.stack[profiler.depth] >= 0)
+        profiler.frames[profiler.current].zones[profiler.stack[profiler.depth]].end = GetTime();
+}
+
+#if defined(MEOW_HEADLESS)
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#else
+#define PROFILE_BEGIN(name) do { if (profiler.recording) BeginProfileZone(name); } while (0)
+#define PROFILE_END() do { if (profiler.recording) EndProfileZone(); } while (0)
+#endif
+
 // Runtime resolution
 typedef struct Resolution {
     int x;
@@ -93,3382 +212,6795 @@ typedef struct GameOptions {
 Color MAIN_BROWN = { 150, 104, 81, 255 };
 Color MAIN_ORANGE = { 245, 167, 128, 255 };
 
-// Textures
-Texture2D logoTexture;
-Texture2D splashBackgroundTexture;
-Texture2D splashOverlayTexture;
-Texture2D backgroundTexture;
-Texture2D backgroundOverlayTexture;
-Texture2D backgroundOverlaySidebarTexture;
-Texture2D pawTexture;
+// Asset loader
+// Files are decoded to an Image or Wave on the task pool. The main thread only creates the GPU textures and audio
+// buffers, which raylib can not do from another thread, and stops after a time budget so the splash keeps animating.
+#define ASSET_LOADER_MAX_REQUESTS 128
+#define ASSET_LOADER_FRAME_BUDGET 0.008
+#define ASSET_PATH_LENGTH 256
 
-// UI Elements
-Texture2D checkbox;
-Texture2D checkboxChecked;
-Texture2D left_arrow;
-Texture2D right_arrow;
+typedef enum {
+    ASSET_TEXTURE,
+    ASSET_SOUND,
+    ASSET_MUSIC     // Streamed from disk, never goes through the loader
+} AssetKind;
+
+typedef struct AssetRequest {
+    AssetKind kind;
+    char path[ASSET_PATH_LENGTH];
+    Texture2D* texture;
+    Sound* sound;
+    // Written by the worker
+    Image image;
+    Wave wave;
+    bool archived;  // Points into the asset archive, nothing to unload
+} AssetRequest;
+
+typedef struct AssetLoader {
+    TaskPool* pool;
+    AssetRequest requests[ASSET_LOADER_MAX_REQUESTS];
+    int requestCount;
+    int finishedCount;
+    double startTime;
+    double uploadTime;  // Main thread time spent in FinishAsset
+} AssetLoader;
+
+AssetLoader assetLoader;
+
+// Build outputs, CMakeLists.txt points these at the build directory
+#ifndef ATLAS_PATH
+#define ATLAS_PATH ASSETS_PATH"atlas/"
+#endif
 
-// Customer
-Texture2D customerTexture_first_happy;
-Texture2D customerTexture_second_happy;
-Texture2D customerTexture_third_happy;
-Texture2D customerTexture_first_normal;
-Texture2D customerTexture_second_normal;
-Texture2D customerTexture_third_normal;
-Texture2D customerTexture_first_angry;
-Texture2D customerTexture_second_angry;
-Texture2D customerTexture_third_angry;
-Texture2D bubbles;
+// Decoded textures and sounds packed at build time by pipeline/asset_packer.c, desktop only
+#ifndef ARCHIVE_PATH
+#define ARCHIVE_PATH ASSETS_PATH"assets.pak"
+#endif
 
-// Clouds
-Texture2D cloud1Texture;
-Texture2D cloud2Texture;
-Texture2D cloud3Texture;
+AssetArchive* assetArchive = NULL;
 
-// Stars
-Texture2D star1Texture;
-Texture2D star2Texture;
+// Allocation tracker
+// Counts the textures, render textures, sounds and music streams the game creates and frees, and how much the heap
+// grows during each update. Every load and unload goes through the Track and UnloadTracked functions below.
+// With MEOW_ALLOC_ASSERT=1 the game stops with a fatal error when a round that has settled loads anything or its heap
+// keeps growing, so a soak test with MEOW_AUTOPLAY or meow_sim proves that a long session does not grow.
+//
+// The heap figure covers every thread, so the log flush thread or raylib's audio thread may grow it in the middle of an
+// update. A settled round may therefore grow the heap by ALLOCATION_HEAP_TOLERANCE over what it held when it settled.
+// A leak in the update passes that sooner or later, one-off buffers of the other threads do not.
+#define ALLOCATION_SETTLE_FRAMES 120
+#define ALLOCATION_HEAP_TOLERANCE (256 * 1024)
 
-// Font
-Font meowFont;
+typedef enum {
+    ALLOCATION_TEXTURE,
+    ALLOCATION_RENDER_TEXTURE,
+    ALLOCATION_SOUND,
+    ALLOCATION_MUSIC,
+    ALLOCATION_KIND_COUNT
+} AllocationKind;
+
+typedef struct AllocationTracker {
+    int live[ALLOCATION_KIND_COUNT];
+    size_t liveBytes;
+    size_t peakLiveBytes;
+
+    // Loads plus updates that grew the heap
+    int frameAllocations;
+    int lastFrameAllocations;
+    int peakFrameAllocations;
+
+    // The heap is only measured while the stats overlay is open or the assertion is on
+    bool measureHeap;
+    size_t heapBeforeUpdate;
+    size_t heapBytes;
+    size_t peakHeapBytes;
+    long long lastHeapGrowth;
+    size_t settledHeapBytes;    // 0 until the round settles
+
+    bool assertSteadyState;
+    bool steadyStateScene;  // Current scene must settle, only the game scene
+    int sceneFrames;
+} AllocationTracker;
+
+AllocationTracker allocationTracker = { 0 };
+
+const char* allocationKindNames[ALLOCATION_KIND_COUNT] = { "texture", "render texture", "sound", "music stream" };
+
+// MEOW_ALLOC_ASSERT=1 turns an allocation in a settled round into a fatal error
+void InitAllocationTracker()
+{
+    const char* assertSteadyState = getenv("MEOW_ALLOC_ASSERT");
+    allocationTracker.assertSteadyState = assertSteadyState != NULL && atoi(assertSteadyState) != 0;
+}
 
-// Sounds
-Sound selectFx;
-Sound hoverFx;
-Sound boongFx;
+void CloseLogRing(void);
 
-Sound angry1Fx;
-Sound angry2Fx;
-Sound angry3Fx;
-Sound angry4Fx;
-      
-Sound bottle1Fx;
-Sound bottle2Fx;
-Sound bottle3Fx;
+// The assertion is meant for unattended runs, it logs and exits with an error instead of showing anything
+void FailAllocationCheck(const char* what, long long bytes)
+{
+    Log(LOG_FATAL, "Allocation in a settled round: %s, %lld bytes, %d frames after the round started", what, bytes, allocationTracker.sceneFrames);
+    CloseLogRing();
+    exit(EXIT_FAILURE);
+}
 
-Sound confused1Fx;
-Sound confused2Fx;
-Sound confused3Fx;
-Sound confused4Fx;
+bool IsAllocationSteadyState()
+{
+    return allocationTracker.steadyStateScene && allocationTracker.sceneFrames > ALLOCATION_SETTLE_FRAMES;
+}
 
-Sound correctFx;
+void TrackAllocation(AllocationKind kind, size_t bytes)
+{
+    allocationTracker.live[kind]++;
+    allocationTracker.liveBytes += bytes;
+    if (allocationTracker.liveBytes > allocationTracker.peakLiveBytes)
+        allocationTracker.peakLiveBytes = allocationTracker.liveBytes;
+    allocationTracker.frameAllocations++;
+
+    if (allocationTracker.assertSteadyState && IsAllocationSteadyState())
+        FailAllocationCheck(allocationKindNames[kind], (long long)bytes);
+}
 
-Sound drop1Fx;
-Sound drop2Fx;
-Sound drop3Fx;
+void TrackRelease(AllocationKind kind, size_t bytes)
+{
+    allocationTracker.live[kind]--;
+    allocationTracker.liveBytes -= bytes;
+}
 
-Sound pickup1Fx;
-Sound pickup2Fx;
-Sound pickup3Fx;
+size_t GetTextureBytes(Texture2D texture)
+{
+    return texture.id != 0 ? (size_t)GetPixelDataSize(texture.width, texture.height, texture.format) : 0;
+}
 
-Sound pour1Fx;
-Sound pour2Fx;
-Sound pour3Fx;
+// Sounds are converted to the device format when loaded, the stream describes that format
+size_t GetSoundBytes(Sound sound)
+{
+    return (size_t)sound.frameCount * sound.stream.channels * sound.stream.sampleSize / 8;
+}
 
-Sound stir1Fx;
-Sound stir2Fx;
-Sound stir3Fx;
+// Color plus a 32 bit depth buffer
+size_t GetRenderTextureBytes(RenderTexture2D target)
+{
+    return GetTextureBytes(target.texture) + (size_t)target.texture.width * target.texture.height * 4;
+}
 
-Sound flickFx;
+Texture2D TrackTexture(Texture2D texture)
+{
+    if (texture.id != 0)
+        TrackAllocation(ALLOCATION_TEXTURE, GetTextureBytes(texture));
+    return texture;
+}
 
-typedef enum {
-    FX_HOVER,
-    FX_SELECT,
-    FX_ANGRY,
-    FX_BOTTLE,
-    FX_CONFUSED,
-    FX_CORRECT,
-    FX_DROP,
-    FX_PICKUP,
-    FX_POUR,
-    FX_STIR,
-    FX_BOONG,
-    FX_FLICK
-} SoundFxType;
+void UnloadTrackedTexture(Texture2D texture)
+{
+    if (texture.id != 0)
+        TrackRelease(ALLOCATION_TEXTURE, GetTextureBytes(texture));
+    UnloadTexture(texture);
+}
 
-// BGMs
-Music menuBgm;
+RenderTexture2D TrackRenderTexture(RenderTexture2D target)
+{
+    if (target.id != 0)
+        TrackAllocation(ALLOCATION_RENDER_TEXTURE, GetRenderTextureBytes(target));
+    return target;
+}
 
-// Menu falling items
-Texture2D menuFallingItemTextures[8];
+void UnloadTrackedRenderTexture(RenderTexture2D target)
+{
+    if (target.id != 0)
+        TrackRelease(ALLOCATION_RENDER_TEXTURE, GetRenderTextureBytes(target));
+    UnloadRenderTexture(target);
+}
 
-// Ingredients
-Texture2D teaPowderTexture;
-Texture2D cocoaPowderTexture;
-Texture2D caramelSauceTexture;
-Texture2D chocolateSauceTexture;
-Texture2D condensedMilkTexture;
-Texture2D normalMilkTexture;
-Texture2D marshMellowTexture;
-Texture2D whippedCreamTexture;
-Texture2D hotWaterTexture;
-Texture2D greenChonTexture;
-Texture2D cocoaChonTexture;
+Sound TrackSound(Sound sound)
+{
+    if (sound.frameCount > 0)
+        TrackAllocation(ALLOCATION_SOUND, GetSoundBytes(sound));
+    return sound;
+}
 
+void UnloadTrackedSound(Sound sound)
+{
+    if (sound.frameCount > 0)
+        TrackRelease(ALLOCATION_SOUND, GetSoundBytes(sound));
+    UnloadSound(sound);
+}
 
-// utils
-Texture2D trashCanTexture;
+// Streamed, only the decoder and a few small buffers stay in memory
+Music TrackMusic(Music music)
+{
+    if (music.frameCount > 0)
+        TrackAllocation(ALLOCATION_MUSIC, 0);
+    return music;
+}
 
-static inline char* StringFromDifficultyEnum(Difficulty difficulty)
+void UnloadTrackedMusic(Music music)
 {
-    static const char* strings[] = { "Easy", "Medium", "Hard", "Freeplay (E)", "Freeplay (M)", "Freeplay (H)" };
-    return strings[difficulty];
+    if (music.frameCount > 0)
+        TrackRelease(ALLOCATION_MUSIC, 0);
+    UnloadMusicStream(music);
 }
 
-// Customer textures
-typedef struct {
-    Texture2D happy;
-    Texture2D happyEyesClosed;
-    Texture2D frustrated;
-    Texture2D frustratedEyesClosed;
-    Texture2D angry;
-    Texture2D angryEyesClosed;
-} CustomerImageData;
+// A scene change or a window resize starts the settle period over, the first frames of a round still load things
+void BeginAllocationFrame(bool steadyStateScene, bool restart, bool measureHeap)
+{
+    AllocationTracker* tracker = &allocationTracker;
 
-CustomerImageData customersImageData[3];
+    tracker->lastFrameAllocations = tracker->frameAllocations;
+    if (tracker->frameAllocations > tracker->peakFrameAllocations)
+        tracker->peakFrameAllocations = tracker->frameAllocations;
+    tracker->frameAllocations = 0;
 
-typedef enum {
-    TEXTURE_TYPE_HAPPY,
-    TEXTURE_TYPE_HAPPY_EYES_CLOSED,
-    TEXTURE_TYPE_FRUSTRATED,
-    TEXTURE_TYPE_FRUSTRATED_EYES_CLOSED,
-    TEXTURE_TYPE_ANGRY,
-    TEXTURE_TYPE_ANGRY_EYES_CLOSED
-} CustomerTextureFrameType;
+    if (steadyStateScene != tracker->steadyStateScene || restart)
+    {
+        tracker->sceneFrames = 0;
+        tracker->settledHeapBytes = 0;
+    }
+    tracker->steadyStateScene = steadyStateScene;
+    tracker->sceneFrames++;
 
-// Customer emotions
-typedef enum {
-    EMOTION_HAPPY,
-    EMOTION_FRUSTRATED,
-    EMOTION_ANGRY
-} CustomerEmotion;
+    tracker->measureHeap = measureHeap || tracker->assertSteadyState;
+}
 
-// Order
-// typedef struct Order { //text-based-combinations
-//     char* first;
-//     char* second;
-//     char* third;
-//     char* fourth;
-// } Order;
+void BeginUpdateAllocations()
+{
+    if (allocationTracker.measureHeap)
+        allocationTracker.heapBeforeUpdate = GetHeapBytesInUse();
+}
 
-// Customer
-typedef struct Customer {
-    CustomerEmotion emotion;
-    double blinkTimer;
-    double normalDuration;
-    double blinkDuration;
-    bool eyesClosed;
+// Only growth is seen, memory allocated and freed again within the update does not count. Any growth is shown as an
+// allocation, the assertion only looks at the growth since the round settled.
+void EndUpdateAllocations()
+{
+    AllocationTracker* tracker = &allocationTracker;
+    if (!tracker->measureHeap)
+        return;
 
-    //int patience; //To be removed. 
-    bool visible;
-    char order[20];
-    double currentTime;
-    int orderEnd;
-    Vector2 position;
-    int textureType;
-    bool isDummy;
-    double resetTimer;
-} Customer;
+    tracker->heapBytes = GetHeapBytesInUse();
+    if (tracker->heapBytes > tracker->peakHeapBytes)
+        tracker->peakHeapBytes = tracker->heapBytes;
 
-static inline char* StringFromCustomerEmotionEnum(CustomerEmotion emotion)
+    tracker->lastHeapGrowth = (long long)tracker->heapBytes - (long long)tracker->heapBeforeUpdate;
+    if (tracker->lastHeapGrowth > 0)
+        tracker->frameAllocations++;
+
+    if (!IsAllocationSteadyState())
+        return;
+
+    if (tracker->settledHeapBytes == 0)
+        tracker->settledHeapBytes = tracker->heapBytes;
+    else if (tracker->assertSteadyState && tracker->heapBytes > tracker->settledHeapBytes + ALLOCATION_HEAP_TOLERANCE)
+        FailAllocationCheck("heap growth since the round settled", (long long)(tracker->heapBytes - tracker->settledHeapBytes));
+}
+
+// Archive entries are named by their path under the assets directory, atlas pages by their path under atlas/
+const ArchiveEntry* FindArchivedAsset(const char* path, ArchiveEntryKind kind)
 {
-    static const char* strings[] = { "Happy", "Frustrated", "Angry" };
-    return strings[emotion];
+    if (assetArchive == NULL)
+        return NULL;
+
+    char name[ASSET_ARCHIVE_NAME_LENGTH];
+    size_t atlasPathLength = strlen(ATLAS_PATH);
+    size_t assetsPathLength = strlen(ASSETS_PATH);
+
+    if (strncmp(path, ATLAS_PATH, atlasPathLength) == 0)
+        snprintf(name, sizeof(name), "atlas/%s", path + atlasPathLength);
+    else if (strncmp(path, ASSETS_PATH, assetsPathLength) == 0)
+        snprintf(name, sizeof(name), "%s", path + assetsPathLength);
+    else
+        return NULL;
+
+    const ArchiveEntry* entry = FindArchiveEntry(assetArchive, name);
+    return entry != NULL && entry->kind == kind ? entry : NULL;
 }
 
-double GetRandomDoubleValue(double min, double max)
+// Both point straight at the archive, raylib only reads them when creating the texture or sound.
+// The archive's pixel formats use raylib's values.
+Image GetArchivedImage(const ArchiveEntry* entry)
 {
-    return min + (rand() / (double)RAND_MAX) * (max - min);
+    return (Image) { (void*)GetArchiveEntryData(assetArchive, entry), (int)entry->width, (int)entry->height, 1, (int)entry->format };
 }
 
-void RandomCustomerBlinkTime(Customer* customer) {
-    customer->blinkDuration = GetRandomDoubleValue(0.2, 0.5);
-    customer->normalDuration = GetRandomDoubleValue(2.0, 6.0);
+Wave GetArchivedWave(const ArchiveEntry* entry)
+{
+    return (Wave) { entry->frameCount, entry->sampleRate, 16, entry->channels, (void*)GetArchiveEntryData(assetArchive, entry) };
 }
 
-Customer CreateCustomer(CustomerEmotion emotion, double blinkTimer, double normalDuration, double blinkDuration, bool visible, Vector2 position, int textureType, double resetTimer) {
-    Customer newCustomer;
+Texture2D LoadAssetTexture(const char* path)
+{
+    const ArchiveEntry* entry = FindArchivedAsset(path, ARCHIVE_TEXTURE);
+    if (entry != NULL)
+        return TrackTexture(LoadTextureFromImage(GetArchivedImage(entry)));
 
-    newCustomer.emotion = emotion;
-    newCustomer.blinkTimer = blinkTimer;
-    newCustomer.normalDuration = normalDuration;
-    newCustomer.blinkDuration = blinkDuration;
-    newCustomer.eyesClosed = false;
-    newCustomer.visible = visible;
-	newCustomer.order[0] = '\0';
-    newCustomer.currentTime = 0;
-    newCustomer.orderEnd = 0;
-    newCustomer.position = position;
-    newCustomer.textureType = textureType;
-    newCustomer.isDummy = false;
-    newCustomer.resetTimer = resetTimer;
+    return TrackTexture(LoadTexture(path));
+}
 
-    return newCustomer;
+Sound LoadAssetSound(const char* path)
+{
+    const ArchiveEntry* entry = FindArchivedAsset(path, ARCHIVE_SOUND);
+    if (entry != NULL)
+        return TrackSound(LoadSoundFromWave(GetArchivedWave(entry)));
+
+    return TrackSound(LoadSound(path));
 }
 
-// Customers
-typedef struct Customers {
-    Customer customer1;
-    Customer customer2;
-    Customer customer3;
-} Customers;
+// Runs on a worker, must not touch the GPU, the audio device or TextFormat
+void DecodeAsset(void* data)
+{
+    AssetRequest* request = (AssetRequest*)data;
 
-// Menu falling items
-typedef struct {
-    Vector2 position;
-    float rotation;
-    int textureIndex;
-    float fallingSpeed;
-    float rotationSpeed;
-} MenuFallingItem;
+    // Archived assets are already decoded, the worker only looks them up
+    const ArchiveEntry* entry = FindArchivedAsset(request->path, request->kind == ASSET_TEXTURE ? ARCHIVE_TEXTURE : ARCHIVE_SOUND);
+    if (entry != NULL)
+    {
+        if (request->kind == ASSET_TEXTURE)
+            request->image = GetArchivedImage(entry);
+        else
+            request->wave = GetArchivedWave(entry);
 
-// Moving clouds
-typedef struct {
-	Vector2 position;
-	float speed;
-	float scale;
-	Texture2D texture;
-    bool fromRight;
-} MovingCloud;
+        request->archived = true;
+        return;
+    }
 
-// Moving stars
-typedef struct {
-	Vector2 position;
-	float speed;
-	float scale;
-	Texture2D texture;
-} MovingStar;
+    if (request->kind == ASSET_TEXTURE)
+        request->image = LoadImage(request->path);
+    else
+        request->wave = LoadWave(request->path);
+}
 
-// Ingredient
-typedef enum IngredientType {
-    NONE,
-    GREEN_TEA,
-    COCOA,
-    CONDENSED_MILK,
-    MILK,
-    MARSHMELLOW,
-    WHIPPED_CREAM,
-    CARAMEL,
-    CHOCOLATE
-};
+void FinishAsset(AssetRequest* request)
+{
+    double startTime = GetTime();
 
-typedef struct {
-    Texture2D texture;
-    bool canChangeCupTexture;
-    Vector2 position;
-    Vector2 originalPosition;
-    Rectangle frameRectangle;
-    int totalFrames;
-    int currentFrame; // not use right now but later
-} Ingredient;
-
-// Ingredients
-Ingredient teaPowder, cocoaPowder, normalMilk, condensedMilk, marshMellow, whippedCream, caramelSauce, chocolateSauce, hotWater;
-Ingredient greenChon, cocoaChon;
-
-Ingredient trashCan;
-
-// Cup
-typedef struct {
-    Texture2D texture;
-    Vector2 position;
-    Vector2 originalPosition;
-    Rectangle frameRectangle;
-    // Add properties to represent cup state
-    enum IngredientType powderType;
-    bool hasWater;
-    enum IngredientType creamerType;
-    enum IngredientType toppingType;
-    enum IngredientType sauceType;
-    bool active;
-    char* order[20];
-} Cup;
+    if (request->kind == ASSET_TEXTURE)
+    {
+        if (request->image.data != NULL)
+            *request->texture = TrackTexture(LoadTextureFromImage(request->image));
+        else
+            Log(LOG_ERROR, "Failed to load texture %s", request->path);
 
-// Drop area
-typedef struct {
-    /* data */
-    Texture2D texture;
-    Vector2 position;
-} DropArea;
+        if (!request->archived)
+            UnloadImage(request->image);
+    }
+    else
+    {
+        if (request->wave.data != NULL)
+            *request->sound = TrackSound(LoadSoundFromWave(request->wave));
+        else
+            Log(LOG_ERROR, "Failed to load sound %s", request->path);
 
-DropArea plate;
+        if (!request->archived)
+            UnloadWave(request->wave);
+    }
 
-// Original position
-const Vector2 oricupPosition = { 351,109 };
-const Vector2 oriwaterPosition = { 600, 210 };
+    assetLoader.uploadTime += GetTime() - startTime;
+    assetLoader.finishedCount++;
+}
 
-const Vector2 oricaramelPosition = { -770,108 };
-const Vector2 orichocolatePosition = { -904,138 };
-const Vector2 oriteapowderPosition = { -421,145 };
-const Vector2 oricocoapowderPosition = { -564,177 };
-const Vector2 oriplatePosition = { -175,300 };
-const Vector2 oriplateCupPosition = { -28, 300 };
-const Vector2 oricondensedmilkPosition = { 283,316 };
-const Vector2 orimilkPosition = { 160,342 };
-const Vector2 orimarshmellowPosition = { -481,320 };
-const Vector2 oriwhippedPosition = { -644,320 };
-const Vector2 oricupsPostion = { 390,80 };
-const Vector2 hiddenPosition = { -3000, -3000 };
-Vector2 trashCanPosition = { 0, 0 };
+bool IsAssetLoaderDone()
+{
+    return assetLoader.finishedCount == assetLoader.requestCount;
+}
 
-static int global_score = 0;
+AssetRequest* AddAssetRequest(AssetKind kind, const char* path)
+{
+    // A new batch starts once everything before it was handed out
+    if (IsAssetLoaderDone())
+    {
+        assetLoader.requestCount = 0;
+        assetLoader.finishedCount = 0;
+        assetLoader.startTime = GetTime();
+        assetLoader.uploadTime = 0.0;
+    }
 
-bool triggerHotWater = false;
-double boilingTime = 2.5;
-double lastBoongBoongBoongTime = 0;
-bool dragAndDropLocked = false;
+    AssetRequest* request = &assetLoader.requests[assetLoader.requestCount];
+    *request = (AssetRequest){ 0 };
+    request->kind = kind;
+    strncpy(request->path, path, ASSET_PATH_LENGTH - 1);
+    return request;
+}
 
-void UnloadGlobalAssets();
-void ExitApplication()
+void SubmitAssetRequest(AssetRequest* request)
 {
-    UnloadGlobalAssets();
-    exit(0);
-}
+    assetLoader.requestCount++;
 
-void boilWater(Ingredient* item) {
-    if (!item->canChangeCupTexture) {
-        triggerHotWater = true;
-        boilingTime = GetTime();
+    if (!SubmitTask(assetLoader.pool, DecodeAsset, request))
+    {
+        DecodeAsset(request);
+        FinishAsset(request);
     }
 }
 
-void PlaySoundFx(SoundFxType type);
-void RemoveCustomer(Customer* customer);
-bool validiator(Customer* customer, char* order);
-Texture2D* DragAndDropCup(Cup* cup, const DropArea* dropArea, Camera2D* camera, Customers *customers, Ingredient* trashCan)
-{
-    static bool isObjectBeingDragged = false;
-    static Texture2D* current_dragging = NULL;
-    static float offsetX = 0;
-    static float offsetY = 0;
-
-    Rectangle objectBounds = { cup->position.x, cup->position.y, (float)cup->frameRectangle.width, (float)cup->frameRectangle.height };
-    Rectangle dropBounds = { dropArea->position.x, dropArea->position.y, (float)dropArea->texture.width, (float)dropArea->texture.height };
-
-    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-
-        Rectangle trashCanBond = { trashCan->position.x, trashCan->position.y, trashCan->frameRectangle.width, trashCan->frameRectangle.height };
-        LogDebug("trashCanPosition.x: %f, trashCanPosition.y: %f, trashCanTexture.width: %d, trashCanTexture.height: %d\n", trashCanPosition.x, trashCanPosition.y, trashCanTexture.width, trashCanTexture.height);
-        Rectangle cupBond = { cup->position.x, cup->position.y, cup->texture.width, cup->texture.height };
-        LogDebug("Cup Positon x: %f, y: %f, cupTexture.width: %d, cupTexture.height: %d\n", cup->position.x, cup->position.y, cup->texture.width, cup->texture.height);
-        LogDebug("CheckCollisionRecs(trashCanBond, cupBond) %d\n", CheckCollisionRecs(trashCanBond, cupBond));
-        if(CheckCollisionRecs(trashCanBond, cupBond)){
-            cup->powderType = NONE;
-            cup->creamerType = NONE;
-            cup->toppingType = NONE;
-            cup->sauceType = NONE;
-            cup->hasWater = false;
-            cup->active = false;
-        }
-
-        if (cup->active && CheckCollisionPointRec(mousePos, objectBounds) && (current_dragging == NULL || current_dragging == &cup->texture)) {
-            isObjectBeingDragged = true;
-            offsetX = cup->frameRectangle.width / 2;
-            offsetY = cup->frameRectangle.height / 2;
-            float mouseX = mousePos.x;
-            float mouseY = mousePos.y;
-
-            cup->position.x = mouseX - offsetX;
-            cup->position.y = mouseY - offsetY;
-            current_dragging = &cup->texture;
-            return &cup->texture;
-        }
-        // If being drag from cups, then change the cup position to the cursor
-        else if (!cup->active && CheckCollisionPointRec(mousePos, (Rectangle) { oricupsPostion.x, oricupsPostion.y, cup->texture.width, cup->texture.height })) {
-			// Reset cup state            
-            isObjectBeingDragged = true;
-			offsetX = cup->texture.width / 2;
-			offsetY = cup->texture.height / 2;
-			float mouseX = mousePos.x;
-			float mouseY = mousePos.y;
-
-			cup->position.x = mouseX - offsetX;
-			cup->position.y = mouseY - offsetY;
-            cup->texture = LoadTexture(ASSETS_PATH"combination/EMPTY.png");
-			current_dragging = &cup->texture;
-            cup->powderType = NONE;
-            cup->creamerType = NONE;
-            cup->toppingType = NONE;
-            cup->sauceType = NONE;
-            cup->hasWater = false;
-            cup->active = true;
-			return &cup->texture;
-		}
-
+// The texture is filled in by UpdateAssetLoader, it stays empty until then
+void RequestTexture(const char* path, Texture2D* texture)
+{
+    if (assetLoader.requestCount >= ASSET_LOADER_MAX_REQUESTS)
+    {
+        Log(LOG_WARNING, "Asset loader is full, loading %s right away", path);
+        *texture = LoadAssetTexture(path);
+        return;
     }
 
-    if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
-        isObjectBeingDragged = false;
-        current_dragging = NULL;
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
+    AssetRequest* request = AddAssetRequest(ASSET_TEXTURE, path);
+    request->texture = texture;
+    SubmitAssetRequest(request);
+}
+
+void RequestSound(const char* path, Sound* sound)
+{
+    if (assetLoader.requestCount >= ASSET_LOADER_MAX_REQUESTS)
+    {
+        Log(LOG_WARNING, "Asset loader is full, loading %s right away", path);
+        *sound = LoadAssetSound(path);
+        return;
+    }
 
-        Customer* customerToCheck[3] = { &customers->customer1, &customers->customer2, &customers->customer3, };
+    AssetRequest* request = AddAssetRequest(ASSET_SOUND, path);
+    request->sound = sound;
+    SubmitAssetRequest(request);
+}
 
-        
-        Rectangle cupRect = { cup->position.x, cup->position.y, cup->frameRectangle.width, cup->frameRectangle.height };
+// Uploads decoded assets until the budget runs out, returns how many were finished.
+// Without worker threads (web builds) the decoding happens here as well.
+int UpdateAssetLoader(double budget)
+{
+    double startTime = GetTime();
+    int finished = 0;
+    void* data;
 
-        // Only check if world mouse position is more than y= 15
-        if (mousePos.y <= 15 && cup->active)
+    while (!IsAssetLoaderDone() && GetTime() - startTime < budget)
+    {
+        if (!PopCompletedTask(assetLoader.pool, &data))
         {
-            // If cup is being given to customers
-            for (int i = 0; i < 3; i++) {
-                // If customer is visible
-                if (customerToCheck[i]->visible) {
-                    // If cup is being given to customer
-
-                    Rectangle customerRect = { customerToCheck[i]->position.x, customerToCheck[i]->position.y, customersImageData[i].happy.width / 2, customersImageData[i].happy.height / 2 };
+            if (GetTaskPoolThreadCount(assetLoader.pool) > 0 || !RunPendingTask(assetLoader.pool))
+                break;
+            continue;
+        }
 
-                if (cupRect.x >= customerRect.x &&
-                    cupRect.y >= customerRect.y &&
-                    (cupRect.x + cupRect.width) <= (customerRect.x + customerRect.width) &&
-                    (cupRect.y + cupRect.height) <= (customerRect.y + customerRect.height))
-                {
-                        bool correct = validiator(customerToCheck[i], cup->order);
-                        if (correct)
-                        {
-                            global_score += 50;
-                            PlaySoundFx(FX_CORRECT);
+        FinishAsset((AssetRequest*)data);
+        finished++;
+    }
 
-                            customerToCheck[i]->visible = false;
-                            RemoveCustomer(customerToCheck[i]);
-                        }
-                        else
-                        {
-                            global_score -= 50;
-                            PlaySoundFx(FX_CONFUSED);
-                        }
+    return finished;
+}
 
-                        // Reset cup state
-                        cup->texture = LoadTexture(ASSETS_PATH"combination/EMPTY.png");
-                        cup->powderType = NONE;
-                        cup->creamerType = NONE;
-                        cup->toppingType = NONE;
-                        cup->sauceType = NONE;
-                        cup->hasWater = false;
-                        cup->active = false;
-                        return &cup->texture;
-                    }
-                }
-            }
-        }
+// Blocks until every request is finished
+void FlushAssetLoader()
+{
+    while (!IsAssetLoaderDone())
+    {
+        if (UpdateAssetLoader(1.0) == 0 && GetTaskPoolThreadCount(assetLoader.pool) > 0)
+            WaitTime(0.001);
+    }
+}
 
+float GetAssetLoaderProgress()
+{
+    if (assetLoader.requestCount == 0)
+        return 1.0f;
 
-        // Return cup to the drop area if it is not inside the drop area
-        int offset_x = 10;
-        int offset_y = -40;
+    return (float)assetLoader.finishedCount / assetLoader.requestCount;
+}
 
-        cup->position.x = dropArea->position.x + offset_x + dropArea->texture.width / 2 - cup->frameRectangle.width / 2;
-        cup->position.y = dropArea->position.y + offset_y + dropArea->texture.height / 2 - cup->frameRectangle.height / 2;
+// Texture atlases, packed at build time by pipeline/atlas_packer.c from the manifests in assets/
+
+#define ATLAS_MAX_REGIONS 128
+#define ATLAS_MAX_PAGES 8
+#define ATLAS_MAX_SOURCES 8
+#define ATLAS_NAME_LENGTH 64
+#define ATLAS_SOURCE_LENGTH 256
+
+typedef struct AtlasRegion {
+    Texture2D texture;  // Atlas page, or the image itself when it was not packed
+    Rectangle rect;     // All frames of the image on the page
+    Vector2 frameSize;  // Packed size of one frame, smaller than the art for downscaled atlases
+    Vector2 sourceSize; // Size of the original art, frames side by side
+    int frames;
+    int columns;
+} AtlasRegion;
+
+typedef struct AtlasEntry {
+    char name[ATLAS_NAME_LENGTH];
+    char sources[ATLAS_SOURCE_LENGTH];
+    AtlasRegion region;
+    int page;           // -1 when the region table does not list it
+    bool standalone;
+} AtlasEntry;
+
+typedef struct Atlas {
+    AtlasEntry entries[ATLAS_MAX_REGIONS];
+    int entryCount;
+    Texture2D pages[ATLAS_MAX_PAGES];
+    char pagePaths[ATLAS_MAX_PAGES][ATLAS_SOURCE_LENGTH];
+    int pageCount;
+    char path[ATLAS_SOURCE_LENGTH];
+    float scale;
+} Atlas;
+
+// Spritesheets, cup combinations and UI elements
+Atlas spriteAtlas;
+
+// Returns the next line that is not empty or a comment, the text is split in place
+char* ReadAtlasLine(char** cursor)
+{
+    while (**cursor != '\0')
+    {
+        char* line = *cursor;
+        char* end = strchr(line, '\n');
 
-        //if (CheckCollisionRecs(objectBounds, dropBounds)) {
-            // center of cup to center of drop area
-       
-       // }
-       //else {
-            //cup->position.x = cup->originalPosition.x;
-            //cup->position.y = cup->originalPosition.y;
-       // }
+        if (end != NULL)
+        {
+            *end = '\0';
+            *cursor = end + 1;
+        }
+        else
+            *cursor = line + strlen(line);
 
-    }
+        while (*line == ' ' || *line == '\t')
+            line++;
 
-    // Apply drag-and-drop with time-dependent positioning
-    if (isObjectBeingDragged) {
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        cup->position.x = mousePos.x - offsetX;
-        cup->position.y = mousePos.y - offsetY;
+        if (*line != '\0' && *line != '#' && *line != '\r')
+            return line;
     }
 
-    if(current_dragging)
-        return current_dragging;
-    else
-        return NULL;
-
+    return NULL;
 }
 
-void UpdateCupImage(Cup* cup, Ingredient* ingredient) {
-    // Check what type of ingredient it is and update the cup accordingly
-    // if (ingredient == &teaPowder) {
-    //     cup->hasPowder = true;
-    //     cup->texture = LoadTexture(ASSETS_PATH"/combination/milktea.png"); // Change to the tea cup texture
-    // } else if (ingredient == &cocoaPowder) {
-    //     cup->hasPowder = true;
-    //     cup->texture = LoadTexture(ASSETS_PATH"/combination/milkcocoa.png"); // Change to the cocoa cup texture
-    // }
-
-    // this is a naming standard for combination
-    // {POWDER}{CREAMER}{TOPPING}{SAUCE}.png
-
-    // POWDER:
-    // -Cocoa Powder: CP
-    // -Green Tea Powder: GP
+AtlasEntry* FindAtlasEntry(Atlas* atlas, const char* name)
+{
+    for (int i = 0; i < atlas->entryCount; i++)
+    {
+        if (strcmp(atlas->entries[i].name, name) == 0)
+            return &atlas->entries[i];
+    }
 
-    // WATER:
-    // -Yes: Y
-    // -No: N
+    return NULL;
+}
 
-    // CREAMER:
-    // -Condensed Milk: CM
-    // -Milk: MI
+// Builds a region straight from the source images, for entries the packed atlas does not cover
+AtlasRegion LoadStandaloneRegion(AtlasEntry* entry, float scale)
+{
+    char sources[ATLAS_SOURCE_LENGTH];
+    char* paths[ATLAS_MAX_SOURCES];
+    int sourceCount = 0;
 
-    // TOPPING:
-    // -Marshmallow: MA
-    // -Whipped Cream: WC
+    strcpy(sources, entry->sources);
+    char* cursor = sources;
+    while (sourceCount < ATLAS_MAX_SOURCES)
+    {
+        while (*cursor == ' ' || *cursor == '\t')
+            cursor++;
+        if (*cursor == '\0' || *cursor == '\r')
+            break;
 
-    // SAUCE:
-    // -Caramel: CA
-    // -Chocolate: CH
+        paths[sourceCount++] = cursor;
+        while (*cursor != '\0' && *cursor != ' ' && *cursor != '\t' && *cursor != '\r')
+            cursor++;
+        if (*cursor != '\0')
+            *cursor++ = '\0';
+    }
 
-    LogDebug("update CUP IMAGE \n");
-    char filename[100];
+    AtlasRegion region = { 0 };
+    region.frames = entry->region.frames;
+    region.columns = region.frames;
 
-    // Initialize filename to empty string
-    strcpy(filename, "");
+    if (sourceCount == 0)
+        return region;
 
-    switch (cup->powderType)
+    Texture2D texture;
+    if (sourceCount == 1 && scale == 1.0f)
     {
-    case GREEN_TEA:
-        // cup->texture = LoadTexture(ASSETS_PATH"/combination/milktea.png"); // Change to the tea cup texture
-        strcat(filename, "GP");
-        break;
-    case COCOA:
-        // cup->texture = LoadTexture(ASSETS_PATH"/combination/milkcocoa.png"); // Change to the cocoa cup texture
-        strcat(filename, "CP");
-        break;
-    default:
-        break;
+        texture = TrackTexture(LoadTexture(TextFormat(ASSETS_PATH"%s", paths[0])));
+        region.sourceSize = (Vector2){ (float)texture.width, (float)texture.height };
     }
+    else
+    {
+        // One frame per source, drawn side by side, then resized like the packer would
+        Image images[ATLAS_MAX_SOURCES];
+        int width = 0;
+        int height = 0;
 
-    if (cup->powderType != NONE) {
-        switch (cup->hasWater)
-        {
-        case true:
-            strcat(filename, "Y");
-            break;
-        case false:
-            strcat(filename, "N");
-            break;
-        default:
-            break;
-        }
-    }
-    if (cup->hasWater == true) {
-        switch (cup->creamerType)
+        for (int i = 0; i < sourceCount; i++)
         {
-        case CONDENSED_MILK:
-            strcat(filename, "CM");
-            break;
-        case MILK:
-            strcat(filename, "MI");
-            break;
-        default:
-            break;
+            images[i] = LoadImage(TextFormat(ASSETS_PATH"%s", paths[i]));
+            width += images[i].width;
+            if (images[i].height > height)
+                height = images[i].height;
         }
-    }
 
-    if (cup->creamerType != NONE) {
-        switch (cup->toppingType)
+        Image sheet = GenImageColor(width, height, BLANK);
+        int x = 0;
+        for (int i = 0; i < sourceCount; i++)
         {
-        case MARSHMELLOW:
-            strcat(filename, "MA");
-            break;
-        case WHIPPED_CREAM:
-            strcat(filename, "WC");
-            break;
-        default:
-            break;
+            ImageDraw(&sheet, images[i], (Rectangle) { 0, 0, (float)images[i].width, (float)images[i].height }, (Rectangle) { (float)x, 0, (float)images[i].width, (float)images[i].height }, WHITE);
+            x += images[i].width;
+            UnloadImage(images[i]);
         }
-    }
 
-    if (cup->toppingType != NONE) {
-        switch (cup->sauceType)
-        {
-        case CARAMEL:
-            strcat(filename, "CA");
-            break;
-        case CHOCOLATE:
-            strcat(filename, "CH");
-            break;
-        default:
-            break;
-        }
-    }
-    // if empty then set filename to EMPTY
-    if (strcmp(filename, "") == 0) {
-        strcat(filename, "EMPTY");
-    }
+        region.sourceSize = (Vector2){ (float)width, (float)height };
 
-    // Save filename to cup->order
-    strcpy(cup->order, filename);
+        if (scale != 1.0f)
+            ImageResize(&sheet, (int)(width * scale + 0.5f), (int)(height * scale + 0.5f));
 
-    strcat(filename, ".png");
-    char path[1000];
-    strcpy(path, ASSETS_PATH"combination/");
-    strcat(path, filename);
-    // set cup texture to the filename
-    LogDebug("Powder type: %d, Water: %d, Creamer: %d, Topping: %d, Sauce: %d\n", cup->powderType, cup->hasWater, cup->creamerType, cup->toppingType, cup->sauceType);
-    LogDebug("NEW CUP IMAGE IS %s\n", path);
+        texture = TrackTexture(LoadTextureFromImage(sheet));
+        UnloadImage(sheet);
+    }
 
-    cup->texture = LoadTexture(path);
+    region.texture = texture;
+    region.rect = (Rectangle){ 0, 0, (float)texture.width, (float)texture.height };
+    region.frameSize = (Vector2){ (float)(texture.width / region.frames), (float)texture.height };
+    return region;
 }
 
-void UpdateCup(Cup* cup, Ingredient* ingredient) {
-    // If cup is not active, return
-    if (!cup->active) return;
-
-    // Check what type of ingredient it is and update the cup accordingly
-    if (ingredient == &teaPowder && cup->powderType == NONE) {
-        cup->powderType = GREEN_TEA;
-    }
-    else if (ingredient == &cocoaPowder && cup->powderType == NONE) {
-        cup->powderType = COCOA;
-    }
-    else if (ingredient == &hotWater && cup->powderType != NONE) {
-        cup->hasWater = true;
+// Reads the manifest, then the region table the packer wrote next to the pages. The pages are loaded separately.
+// The scale only applies to the standalone fallback.
+void ReadAtlasTables(Atlas* atlas, const char* manifestPath, const char* atlasPath, float scale)
+{
+    memset(atlas, 0, sizeof(Atlas));
+    strncpy(atlas->path, atlasPath, ATLAS_SOURCE_LENGTH - 1);
+    atlas->scale = scale;
 
-        PlaySoundFx(FX_POUR);
-        PlaySoundFx(FX_STIR);
-    }
-    else if (ingredient == &condensedMilk && cup->hasWater == true && cup->creamerType == NONE) {
-        cup->creamerType = CONDENSED_MILK;
-    }
-    else if (ingredient == &normalMilk && cup->hasWater == true && cup->creamerType == NONE) {
-        cup->creamerType = MILK;
-        PlaySoundFx(FX_POUR);
-    }
-    else if (ingredient == &marshMellow && cup->creamerType != NONE && cup->toppingType == NONE) {
-        cup->toppingType = MARSHMELLOW;
-    }
-    else if (ingredient == &whippedCream && cup->creamerType != NONE && cup->toppingType == NONE) {
-        cup->toppingType = WHIPPED_CREAM;
-    }
-    else if (ingredient == &caramelSauce && cup->toppingType != NONE && cup->sauceType == NONE) {
-        cup->sauceType = CARAMEL;
-        PlaySoundFx(FX_BOTTLE);
-    }
-    else if (ingredient == &chocolateSauce && cup->toppingType != NONE && cup->sauceType == NONE) {
-        cup->sauceType = CHOCOLATE;
-        PlaySoundFx(FX_BOTTLE);
+    char* manifest = LoadFileText(manifestPath);
+    if (manifest == NULL)
+    {
+        Log(LOG_ERROR, "Atlas manifest %s not found", manifestPath);
+        return;
     }
-    UpdateCupImage(cup, ingredient);
-
-}
-
-Texture2D* DragAndDropIngredient(Ingredient* object, Cup* cup, Camera2D* camera) {
-    static bool isObjectBeingDragged = false;
-    static Texture2D* current_dragging = NULL;
-    static float offsetX = 0;
-    static float offsetY = 0;
 
-    Rectangle objectBounds = { object->position.x, object->position.y, (float)object->frameRectangle.width, (float)object->frameRectangle.height };
-    Rectangle cupBounds = { cup->position.x, cup->position.y, (float)cup->texture.width, (float)cup->texture.height };
+    char* cursor = manifest;
+    char* line;
 
-    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        if (CheckCollisionPointRec(mousePos, objectBounds) && (current_dragging == NULL || current_dragging == &object->texture)) {
+    while ((line = ReadAtlasLine(&cursor)) != NULL)
+    {
+        if (atlas->entryCount >= ATLAS_MAX_REGIONS)
+        {
+            Log(LOG_ERROR, "Atlas manifest %s has more than %d entries", manifestPath, ATLAS_MAX_REGIONS);
+            break;
+        }
 
-            if (object == &hotWater && object->canChangeCupTexture == false) {
-                object->canChangeCupTexture = false;
-                PlaySoundFx(FX_FLICK);
-                boilWater(object);
-            }
+        AtlasEntry* entry = &atlas->entries[atlas->entryCount];
+        *entry = (AtlasEntry){ 0 };
+        entry->page = -1;
 
-            else
-            {
-                isObjectBeingDragged = true;
-                offsetX = object->frameRectangle.width / 2;
-                offsetY = object->frameRectangle.height / 2;
-                float mouseX = mousePos.x;
-                float mouseY = mousePos.y;
-
-                object->position.x = mouseX - offsetX;
-                object->position.y = mouseY - offsetY;
-                current_dragging = &object->texture;
-                return &object->texture;
-            }
+        int consumed = 0;
+        if (sscanf(line, "%63s %d %n", entry->name, &entry->region.frames, &consumed) != 2 || entry->region.frames < 1 || line[consumed] == '\0')
+        {
+            Log(LOG_WARNING, "Skipping atlas manifest line: %s", line);
+            continue;
         }
+
+        strncpy(entry->sources, line + consumed, ATLAS_SOURCE_LENGTH - 1);
+        atlas->entryCount++;
     }
 
-    if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
-        isObjectBeingDragged = false;
-        current_dragging = NULL;
+    UnloadFileText(manifest);
 
-        if (CheckCollisionRecs(objectBounds, cupBounds)) {
-            if (object->canChangeCupTexture) {
+    // Pages are listed before the regions on them
+    const char* regionsPath = TextFormat("%satlas_regions.txt", atlasPath);
+    char* regions = FileExists(regionsPath) ? LoadFileText(regionsPath) : NULL;
+    if (regions != NULL)
+    {
+        cursor = regions;
 
-                if (object == &hotWater && cup->powderType != NONE) {
-                    triggerHotWater = false;
-                    object->canChangeCupTexture = false;
-                    object->currentFrame = 1;
-                }
+        while ((line = ReadAtlasLine(&cursor)) != NULL)
+        {
+            char name[ATLAS_NAME_LENGTH];
+            int page, x, y, width, height, frames, columns, frameWidth, frameHeight, sourceWidth, sourceHeight;
 
-                UpdateCup(cup,object);
+            if (sscanf(line, "page %d %63s", &page, name) == 2)
+            {
+                if (page < 0 || page >= ATLAS_MAX_PAGES)
+                    continue;
 
-                object->position.x = object->originalPosition.x;
-                object->position.y = object->originalPosition.y;
+                strncpy(atlas->pagePaths[page], TextFormat("%s%s", atlasPath, name), ATLAS_SOURCE_LENGTH - 1);
+                if (page >= atlas->pageCount)
+                    atlas->pageCount = page + 1;
+            }
+            else if (sscanf(line, "region %63s %d %d %d %d %d %d %d %d %d %d %d", name, &page, &x, &y, &width, &height, &frames, &columns, &frameWidth, &frameHeight, &sourceWidth, &sourceHeight) == 12)
+            {
+                AtlasEntry* entry = FindAtlasEntry(atlas, name);
+                if (entry == NULL || page < 0 || page >= atlas->pageCount || atlas->pagePaths[page][0] == '\0' || frames < 1 || columns < 1)
+                    continue;
+
+                entry->page = page;
+                entry->region = (AtlasRegion){
+                    (Texture2D) { 0 },
+                    (Rectangle) { (float)x, (float)y, (float)width, (float)height },
+                    (Vector2) { (float)frameWidth, (float)frameHeight },
+                    (Vector2) { (float)sourceWidth, (float)sourceHeight },
+                    frames,
+                    columns
+                };
             }
         }
-        else {
-            // Object is not inside the drop area, return it to the original position
-            object->position.x = object->originalPosition.x;
-            object->position.y = object->originalPosition.y;
-        }
-    }
 
-    // Apply drag-and-drop with time-dependent positioning
-    if (isObjectBeingDragged) {
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        object->position.x = mousePos.x - offsetX;
-        object->position.y = mousePos.y - offsetY;
+        UnloadFileText(regions);
     }
-
-    if(current_dragging)
-        return current_dragging;
-	else
-        return NULL;
+    else
+        Log(LOG_WARNING, "Atlas region table not found in %s, run the atlas target", atlasPath);
 }
 
-Texture2D* DragAndDropIngredientPop(Ingredient* object, Ingredient* popObject, Cup* cup, Camera2D* camera) {
-    static bool isObjectBeingDragged = false;
-    static Texture2D* current_dragging = NULL;
-    static float offsetX = 0;
-    static float offsetY = 0;
-
-
-    Rectangle objectBounds = { object->position.x, object->position.y, (float)object->frameRectangle.width, (float)object->frameRectangle.height };
-    Rectangle popObjectBounds = { popObject->position.x, popObject->position.y, (float)popObject->frameRectangle.width, (float)popObject->frameRectangle.height };
-    Rectangle cupBounds = { cup->position.x, cup->position.y, (float)cup->texture.width, (float)cup->texture.height };
-
-    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        if ((CheckCollisionPointRec(mousePos, objectBounds) || CheckCollisionPointRec(mousePos, popObjectBounds)) && (current_dragging == NULL || current_dragging == &object->texture)) {
-            isObjectBeingDragged = true;
-            offsetX = popObject->frameRectangle.width / 2;
-            offsetY = popObject->frameRectangle.height / 2;
-            float mouseX = mousePos.x;
-            float mouseY = mousePos.y;
-
-            popObject->position.x = mouseX - offsetX;
-            popObject->position.y = mouseY - offsetY;
-            current_dragging = &object->texture;
-            return &object->texture;
-        }
+void LoadAtlasPages(Atlas* atlas)
+{
+    for (int i = 0; i < atlas->pageCount; i++)
+    {
+        if (atlas->pagePaths[i][0] != '\0')
+            atlas->pages[i] = LoadAssetTexture(atlas->pagePaths[i]);
     }
+}
 
-    if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
-        isObjectBeingDragged = false;
-        current_dragging = NULL;
+// Queues the pages on the asset loader, call ResolveAtlasRegions once it is done
+void RequestAtlasPages(Atlas* atlas)
+{
+    for (int i = 0; i < atlas->pageCount; i++)
+    {
+        if (atlas->pagePaths[i][0] != '\0')
+            RequestTexture(atlas->pagePaths[i], &atlas->pages[i]);
+    }
+}
 
-        if (CheckCollisionRecs(popObjectBounds, cupBounds)) {
-            if (object->canChangeCupTexture) {
-                UpdateCup(cup,object);
-                popObject->position.x = popObject->originalPosition.x;
-                popObject->position.y = popObject->originalPosition.y;
-            }
-        }
-        else {
-            // Object is not inside the drop area, return it to the original position
-            popObject->position.x = popObject->originalPosition.x;
-            popObject->position.y = popObject->originalPosition.y;
+// Points every entry at its loaded page
+void ResolveAtlasRegions(Atlas* atlas)
+{
+    // Anything the atlas does not cover (stale or missing build output, a page that failed to load) is loaded on its own
+    int standaloneCount = 0;
+    for (int i = 0; i < atlas->entryCount; i++)
+    {
+        AtlasEntry* entry = &atlas->entries[i];
+        if (entry->page >= 0 && atlas->pages[entry->page].id != 0)
+        {
+            entry->region.texture = atlas->pages[entry->page];
+            continue;
         }
-    }
 
-    // Apply drag-and-drop with time-dependent positioning
-    if (isObjectBeingDragged) {
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        popObject->position.x = mousePos.x - offsetX;
-        popObject->position.y = mousePos.y - offsetY;
+        entry->region = LoadStandaloneRegion(entry, atlas->scale);
+        entry->standalone = true;
+        standaloneCount++;
     }
 
-    if(current_dragging)
-	    return current_dragging;
+    if (standaloneCount > 0)
+        Log(LOG_WARNING, "%d of %d images in %s were loaded standalone", standaloneCount, atlas->entryCount, atlas->path);
     else
-        return NULL;
+        Log(LOG_INFO, "Atlas %s: %d images on %d pages", atlas->path, atlas->entryCount, atlas->pageCount);
 }
 
-Rectangle frameRect(Ingredient i, int frameNum, int frameToShow) {
-    int frameWidth = i.texture.width / frameNum;
-    Rectangle frameRect = { frameWidth * (frameToShow - 1), 0, frameWidth, i.texture.height };
-    return frameRect;
+void LoadAtlas(Atlas* atlas, const char* manifestPath, const char* atlasPath, float scale)
+{
+    ReadAtlasTables(atlas, manifestPath, atlasPath, scale);
+    LoadAtlasPages(atlas);
+    ResolveAtlasRegions(atlas);
 }
 
-Rectangle frameRectCup(Cup i, int frameNum, int frameToShow) {
-    int frameWidth = i.texture.width / frameNum;
-    Rectangle frameRect = { frameWidth * (frameToShow - 1), 0, frameWidth, i.texture.height };
-    return frameRect;
+void RequestAtlas(Atlas* atlas, const char* manifestPath, const char* atlasPath, float scale)
+{
+    ReadAtlasTables(atlas, manifestPath, atlasPath, scale);
+    RequestAtlasPages(atlas);
 }
 
-void tickBoil(Ingredient* boiler) {
-
-    if (triggerHotWater) {
-        if (boilingTime + 3 > GetTime()) {
-            boiler->currentFrame = boiler->totalFrames;
-            return;
-        }
-        if (lastBoongBoongBoongTime + 0.5 < GetTime()) {
-            StopSound(boongFx);
-            PlaySoundFx(FX_BOONG);
-            boiler->canChangeCupTexture = true;
-            lastBoongBoongBoongTime = GetTime();
-            int nextFrame = boiler->currentFrame + 2;
-            if (nextFrame > boiler->totalFrames) {
-                nextFrame = 1;
-            }
-            boiler->currentFrame = nextFrame;
-        }
+void UnloadAtlas(Atlas* atlas)
+{
+    for (int i = 0; i < atlas->entryCount; i++)
+    {
+        if (atlas->entries[i].standalone)
+            UnloadTrackedTexture(atlas->entries[i].region.texture);
     }
-}
 
+    for (int i = 0; i < atlas->pageCount; i++)
+    {
+        if (atlas->pages[i].id != 0)
+            UnloadTrackedTexture(atlas->pages[i]);
+    }
+
+    atlas->entryCount = 0;
+    atlas->pageCount = 0;
+}
+
+AtlasRegion GetAtlasRegion(Atlas* atlas, const char* name)
+{
+    AtlasEntry* entry = FindAtlasEntry(atlas, name);
+    if (entry == NULL)
+    {
+        Log(LOG_ERROR, "Atlas region %s is not in the manifest", name);
+
+        AtlasRegion missing = { 0 };
+        missing.frames = 1;
+        missing.columns = 1;
+        return missing;
+    }
+
+    return entry->region;
+}
+
+// Frames are numbered from 1, like Ingredient.currentFrame
+Rectangle GetAtlasFrame(AtlasRegion region, int frame)
+{
+    // Regions of an atlas that was never loaded, as in the headless simulation
+    if (region.columns < 1)
+        return (Rectangle) { 0 };
+
+    if (frame < 1)
+        frame = 1;
+    if (frame > region.frames)
+        frame = region.frames;
+
+    int column = (frame - 1) % region.columns;
+    int row = (frame - 1) / region.columns;
+
+    return (Rectangle) { region.rect.x + column * region.frameSize.x, region.rect.y + row * region.frameSize.y, region.frameSize.x, region.frameSize.y };
+}
+
+// Size of one frame in world units, the same whatever resolution the atlas was packed at
+Vector2 GetAtlasFrameSize(AtlasRegion region)
+{
+    return (Vector2) { region.sourceSize.x / region.frames, region.sourceSize.y };
+}
+
+// Textures
+Texture2D logoTexture;
+Texture2D splashBackgroundTexture;
+Texture2D splashOverlayTexture;
+Texture2D backgroundTexture;
+Texture2D backgroundOverlayTexture;
+Texture2D backgroundOverlaySidebarTexture;
+
+// UI Elements
+AtlasRegion checkbox;
+AtlasRegion checkboxChecked;
+AtlasRegion left_arrow;
+AtlasRegion right_arrow;
+
+// Customer
+AtlasRegion bubbles;
+
+// Clouds
+Texture2D cloud1Texture;
+Texture2D cloud2Texture;
+Texture2D cloud3Texture;
+
+// Stars
+Texture2D star1Texture;
+Texture2D star2Texture;
+
+// Font
+Font meowFont;
+
+// Sounds
+Sound selectFx;
+Sound hoverFx;
+Sound boongFx;
+
+Sound angry1Fx;
+Sound angry2Fx;
+Sound angry3Fx;
+Sound angry4Fx;
+      
+Sound bottle1Fx;
+Sound bottle2Fx;
+Sound bottle3Fx;
+
+Sound confused1Fx;
+Sound confused2Fx;
+Sound confused3Fx;
+Sound confused4Fx;
+
+Sound correctFx;
+
+Sound drop1Fx;
+Sound drop2Fx;
+Sound drop3Fx;
+
+Sound pickup1Fx;
+Sound pickup2Fx;
+Sound pickup3Fx;
+
+Sound pour1Fx;
+Sound pour2Fx;
+Sound pour3Fx;
+
+Sound stir1Fx;
+Sound stir2Fx;
+Sound stir3Fx;
+
+Sound flickFx;
+
+typedef enum {
+    FX_NONE = -1,
+    FX_HOVER,
+    FX_SELECT,
+    FX_ANGRY,
+    FX_BOTTLE,
+    FX_CONFUSED,
+    FX_CORRECT,
+    FX_DROP,
+    FX_PICKUP,
+    FX_POUR,
+    FX_STIR,
+    FX_BOONG,
+    FX_FLICK
+} SoundFxType;
+
+// BGMs
+Music menuBgm;
+
+// Menu falling items
+Texture2D menuFallingItemTextures[8];
+
+static inline char* StringFromDifficultyEnum(Difficulty difficulty)
+{
+    static const char* strings[] = { "Easy", "Medium", "Hard", "Freeplay (E)", "Freeplay (M)", "Freeplay (H)" };
+    return strings[difficulty];
+}
+
+// Customer sprites, frame 1 has the eyes open and frame 2 closed
+typedef struct {
+    AtlasRegion happy;
+    AtlasRegion frustrated;
+    AtlasRegion angry;
+} CustomerImageData;
+
+CustomerImageData customersImageData[3];
+
+// Customer atlas tiers, the art is 1000x1000 and drawn at half size, so each tier stores it at the size it
+// takes on screen when the 1920x1080 view is rendered at that height. Bigger windows use the last tier.
+typedef struct CustomerAtlasTier {
+    int renderHeight;
+    const char* path;
+    float scale; // Same scale the packer used, applied to the sources when the tier was not packed
+} CustomerAtlasTier;
+
+const CustomerAtlasTier customerAtlasTiers[] = {
+    { 720, ATLAS_PATH"customers_720/", 0.3334f },
+    { 1080, ATLAS_PATH"customers_1080/", 0.5f },
+};
+
+#define CUSTOMER_ATLAS_TIER_COUNT (int)(sizeof(customerAtlasTiers) / sizeof(customerAtlasTiers[0]))
+
+Atlas customerAtlas;
+int customerAtlasTier = -1;
+
+typedef enum {
+    TEXTURE_TYPE_HAPPY,
+    TEXTURE_TYPE_HAPPY_EYES_CLOSED,
+    TEXTURE_TYPE_FRUSTRATED,
+    TEXTURE_TYPE_FRUSTRATED_EYES_CLOSED,
+    TEXTURE_TYPE_ANGRY,
+    TEXTURE_TYPE_ANGRY_EYES_CLOSED
+} CustomerTextureFrameType;
+
+// Customer emotions
+typedef enum {
+    EMOTION_HAPPY,
+    EMOTION_FRUSTRATED,
+    EMOTION_ANGRY
+} CustomerEmotion;
+
+// Order
+// typedef struct Order { //text-based-combinations
+//     char* first;
+//     char* second;
+//     char* third;
+//     char* fourth;
+// } Order;
+
+// Ingredient
+typedef enum IngredientType {
+    NONE,
+    GREEN_TEA,
+    COCOA,
+    CONDENSED_MILK,
+    MILK,
+    MARSHMELLOW,
+    WHIPPED_CREAM,
+    CARAMEL,
+    CHOCOLATE
+};
+
+// Drink, the contents of a cup or a customer order packed into one integer
+// Each slot takes DRINK_SLOT_BITS, 0 is empty and 1/2 are the two ingredients the slot can hold, so two drinks
+// compare with a single integer compare and the order icons come straight out of the slots.
+// Names such as GPYCMWCCA are only built for atlas lookups and logs, see BuildCupCombinationName.
+typedef uint16_t Drink;
+
+typedef enum DrinkSlot {
+    DRINK_POWDER,
+    DRINK_WATER,
+    DRINK_CREAMER,
+    DRINK_TOPPING,
+    DRINK_SAUCE,
+    DRINK_SLOT_COUNT
+} DrinkSlot;
+
+#define DRINK_EMPTY 0
+#define DRINK_SLOT_BITS 2
+#define DRINK_SLOT_MASK 3
+#define DRINK_CODE_COUNT (1 << (DRINK_SLOT_COUNT * DRINK_SLOT_BITS))
+
+// Ingredient behind each slot value, hot water is not an ingredient type so its slot only says yes or no
+const enum IngredientType drinkSlotIngredients[DRINK_SLOT_COUNT][3] = {
+    { NONE, GREEN_TEA, COCOA },
+    { NONE, NONE, NONE },
+    { NONE, CONDENSED_MILK, MILK },
+    { NONE, MARSHMELLOW, WHIPPED_CREAM },
+    { NONE, CARAMEL, CHOCOLATE }
+};
+
+static inline int GetDrinkSlot(Drink drink, DrinkSlot slot)
+{
+    return (drink >> (slot * DRINK_SLOT_BITS)) & DRINK_SLOT_MASK;
+}
+
+static inline Drink SetDrinkSlot(Drink drink, DrinkSlot slot, int value)
+{
+    int shift = slot * DRINK_SLOT_BITS;
+    return (Drink)((drink & ~(DRINK_SLOT_MASK << shift)) | ((value & DRINK_SLOT_MASK) << shift));
+}
+
+static inline bool HasDrinkSlot(Drink drink, DrinkSlot slot)
+{
+    return GetDrinkSlot(drink, slot) != 0;
+}
+
+static inline enum IngredientType GetDrinkIngredient(Drink drink, DrinkSlot slot)
+{
+    return drinkSlotIngredients[slot][GetDrinkSlot(drink, slot)];
+}
+
+// Puts an ingredient into the slot it belongs to, NONE leaves the drink as it is
+Drink AddDrinkIngredient(Drink drink, enum IngredientType type)
+{
+    if (type == NONE)
+        return drink;
+
+    for (int slot = 0; slot < DRINK_SLOT_COUNT; slot++)
+        for (int value = 1; value < 3; value++)
+            if (drinkSlotIngredients[slot][value] == type)
+                return SetDrinkSlot(drink, (DrinkSlot)slot, value);
+
+    return drink;
+}
+
+// Random streams
+// Each kind of randomness draws from its own xoshiro128** stream, and all of them are seeded from one session seed
+// through splitmix64. Drawing an order never shifts the clouds, and a session with the same seed plays out the same.
+typedef enum RandomStream {
+    RANDOM_ORDERS,      // Drinks the customers ask for
+    RANDOM_CUSTOMERS,   // Arrivals, patience, blinking and looks
+    RANDOM_VISUALS,     // Menu falling items, clouds and stars
+    RANDOM_AUDIO,       // Sound effect variations
+    RANDOM_AUTOPLAYER,
+    RANDOM_STREAM_COUNT
+} RandomStream;
+
+typedef struct RandomState {
+    uint32_t s[4];
+} RandomState;
+
+RandomState randomStreams[RANDOM_STREAM_COUNT];
+uint64_t sessionSeed = 0;
+
+static inline uint64_t SplitMix64(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void SeedRandomStreams(uint64_t seed)
+{
+    sessionSeed = seed;
+
+    uint64_t state = seed;
+    for (int i = 0; i < RANDOM_STREAM_COUNT; i++)
+    {
+        uint64_t a = SplitMix64(&state);
+        uint64_t b = SplitMix64(&state);
+        randomStreams[i] = (RandomState){ { (uint32_t)a, (uint32_t)(a >> 32), (uint32_t)b, (uint32_t)(b >> 32) | 1 } };
+    }
+}
+
+static inline uint32_t RotateLeft32(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+// xoshiro128**
+static inline uint32_t NextRandom(RandomStream stream)
+{
+    uint32_t* s = randomStreams[stream].s;
+    uint32_t result = RotateLeft32(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft32(s[3], 11);
+    return result;
+}
+
+// Uniform in [min, max], scaled with a multiply instead of a modulo
+static inline int RandomInt(RandomStream stream, int min, int max)
+{
+    uint32_t range = (uint32_t)(max - min) + 1;
+    return min + (int)(((uint64_t)NextRandom(stream) * range) >> 32);
+}
+
+// Uniform in [min, max)
+static inline double RandomDouble(RandomStream stream, double min, double max)
+{
+    return min + NextRandom(stream) * (1.0 / 4294967296.0) * (max - min);
+}
+
+// Event scheduler
+// Timed events wait in a binary min-heap ordered by due time. RunGameEvents advances the clock once per frame and
+// only pops what came due, so nothing polls its own timer every frame. An event remembers the generation of its
+// target when it was scheduled, bumping the target's generation cancels everything still queued for it.
+//
+// Cancelled events stay in the heap until they come due. The capacity holds every live event of a full customer
+// pool: two mood changes, the timeout, the blink and the arrival at the customer's slot. When churn fills the heap
+// with cancelled events anyway, they are compacted out before a new event would be dropped.
+#define CUSTOMER_POOL_CAPACITY 1024
+#define SCHEDULER_EVENTS_PER_CUSTOMER 5
+#define SCHEDULER_CAPACITY (CUSTOMER_POOL_CAPACITY * SCHEDULER_EVENTS_PER_CUSTOMER + 64)
+
+typedef enum GameEventType {
+    EVENT_CUSTOMER_ARRIVAL,     // Target is a CounterSlot, a new customer walks up if it is still empty
+    EVENT_QUEUE_ARRIVAL,        // Target is a CustomerPool, a rush hour customer joins the queue
+    EVENT_CUSTOMER_MOOD,        // Target is a Customer, value is the new emotion
+    EVENT_CUSTOMER_TIMEOUT,
+    EVENT_CUSTOMER_BLINK,
+    EVENT_BOIL_TICK             // Target is the boiling Ingredient
+} GameEventType;
+
+typedef struct GameEvent {
+    double time;
+    GameEventType type;
+    void* target;
+    uint32_t generation;
+    int value;
+} GameEvent;
+
+typedef struct Scheduler {
+    GameEvent heap[SCHEDULER_CAPACITY];
+    int count;
+    double now;
+} Scheduler;
+
+Scheduler gameEvents;
+
+// Whether the target's generation moved on since the event was scheduled, defined with the event handlers
+bool IsGameEventStale(const GameEvent* event);
+
+// Drops every pending event, the clock keeps running
+void ClearScheduler(Scheduler* scheduler)
+{
+    scheduler->count = 0;
+}
+
+void SiftEventDown(Scheduler* scheduler, int i, GameEvent event)
+{
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= scheduler->count)
+            break;
+        if (child + 1 < scheduler->count && scheduler->heap[child + 1].time < scheduler->heap[child].time)
+            child++;
+        if (event.time <= scheduler->heap[child].time)
+            break;
+        scheduler->heap[i] = scheduler->heap[child];
+        i = child;
+    }
+    scheduler->heap[i] = event;
+}
+
+// Removes cancelled events and rebuilds the heap, returns how many were removed
+int CompactScheduler(Scheduler* scheduler)
+{
+    int kept = 0;
+    for (int i = 0; i < scheduler->count; i++)
+        if (!IsGameEventStale(&scheduler->heap[i]))
+            scheduler->heap[kept++] = scheduler->heap[i];
+
+    int removed = scheduler->count - kept;
+    scheduler->count = kept;
+
+    for (int i = kept / 2 - 1; i >= 0; i--)
+        SiftEventDown(scheduler, i, scheduler->heap[i]);
+
+    return removed;
+}
+
+bool ScheduleEvent(Scheduler* scheduler, double delay, GameEventType type, void* target, uint32_t generation, int value)
+{
+    if (scheduler->count >= SCHEDULER_CAPACITY && CompactScheduler(scheduler) == 0)
+    {
+        Log(LOG_WARNING, "Scheduler is full, dropping event %d", type);
+        return false;
+    }
+
+    GameEvent event = { scheduler->now + delay, type, target, generation, value };
+
+    // Sift up
+    int i = scheduler->count++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (scheduler->heap[parent].time <= event.time)
+            break;
+        scheduler->heap[i] = scheduler->heap[parent];
+        i = parent;
+    }
+    scheduler->heap[i] = event;
+    return true;
+}
+
+// Pops the earliest event if it is due by the scheduler clock
+bool PopDueEvent(Scheduler* scheduler, GameEvent* event)
+{
+    if (scheduler->count == 0 || scheduler->heap[0].time > scheduler->now)
+        return false;
+
+    *event = scheduler->heap[0];
+    GameEvent last = scheduler->heap[--scheduler->count];
+
+    // Sift the last event down from the root
+    SiftEventDown(scheduler, 0, last);
+    return true;
+}
+
+// Customer
+typedef struct Customer {
+    CustomerEmotion emotion;
+    double normalDuration;
+    double blinkDuration;
+    bool eyesClosed;
+
+    //int patience; //To be removed. 
+    bool visible;
+    Drink order;
+    double seatedTime;  // Scheduler clock when the customer sat down
+    int orderEnd;
+    Vector2 position;
+    int textureType;
+    bool isDummy;
+    uint32_t generation;    // Bumped to cancel the customer's pending events
+
+    // Customer pool bookkeeping, -1 outside a pool
+    int slot;           // Counter slot, -1 while waiting in the queue
+    int activeIndex;    // Position in the pool's active list
+} Customer;
+
+static inline char* StringFromCustomerEmotionEnum(CustomerEmotion emotion)
+{
+    static const char* strings[] = { "Happy", "Frustrated", "Angry" };
+    return strings[emotion];
+}
+
+void RandomCustomerBlinkTime(Customer* customer) {
+    customer->blinkDuration = RandomDouble(RANDOM_CUSTOMERS, 0.2, 0.5);
+    customer->normalDuration = RandomDouble(RANDOM_CUSTOMERS, 2.0, 6.0);
+}
+
+Customer CreateCustomer(CustomerEmotion emotion, bool visible, Vector2 position, int textureType) {
+    Customer newCustomer;
+
+    newCustomer.emotion = emotion;
+    RandomCustomerBlinkTime(&newCustomer);
+    newCustomer.eyesClosed = false;
+    newCustomer.visible = visible;
+    newCustomer.order = DRINK_EMPTY;
+    newCustomer.seatedTime = 0;
+    newCustomer.orderEnd = 0;
+    newCustomer.position = position;
+    newCustomer.textureType = textureType;
+    newCustomer.isDummy = false;
+    newCustomer.generation = 0;
+    newCustomer.slot = -1;
+    newCustomer.activeIndex = -1;
+
+    return newCustomer;
+}
+
+// Opens the eyes and restarts the blink cycle, cancels the customer's other pending events as well
+void StartCustomerBlink(Customer* customer)
+{
+    customer->generation++;
+    customer->eyesClosed = false;
+    ScheduleEvent(&gameEvents, customer->normalDuration, EVENT_CUSTOMER_BLINK, customer, customer->generation, 0);
+}
+
+// Customer pool
+// Customers live in a fixed array. Unused entries are chained in a free list and the seated ones are kept in a
+// dense active list, so a frame only walks customers that are actually at the counter. Every counter slot seats
+// one customer, anyone arriving while all slots are taken waits in a queue for the next free one.
+// CUSTOMER_POOL_CAPACITY is defined with the scheduler, which is sized from it.
+
+typedef struct CounterSlot {
+    Vector2 position;
+    int customer;           // Pool index, -1 when empty
+    uint32_t generation;    // Bumped whenever the slot is freed, stale arrivals are skipped
+} CounterSlot;
+
+typedef struct CustomerPool {
+    Customer entries[CUSTOMER_POOL_CAPACITY];
+    int nextFree[CUSTOMER_POOL_CAPACITY];
+    int firstFree;
+
+    int active[CUSTOMER_POOL_CAPACITY];
+    int activeCount;
+
+    CounterSlot slots[CUSTOMER_POOL_CAPACITY];
+    int slotCount;
+    int emptySlotCount;
+
+    // Ring buffer of pool indices
+    int waiting[CUSTOMER_POOL_CAPACITY];
+    int waitingStart;
+    int waitingCount;
+
+    // Extra arrivals straight into the queue for rush hours, 0 when customers only walk up to empty slots
+    double arrivalInterval;
+} CustomerPool;
+
+CustomerPool customerPool;
+
+// Menu falling items
+typedef struct {
+    Vector2 position;
+    float rotation;
+    int textureIndex;
+    float fallingSpeed;
+    float rotationSpeed;
+} MenuFallingItem;
+
+// Moving clouds
+typedef struct {
+	Vector2 position;
+	float speed;
+	float scale;
+	Texture2D texture;
+    bool fromRight;
+} MovingCloud;
+
+// Moving stars
+typedef struct {
+	Vector2 position;
+	float speed;
+	float scale;
+	Texture2D texture;
+} MovingStar;
+
+typedef struct {
+    Texture2D texture;
+    bool canChangeCupTexture;
+    Vector2 position;
+    Vector2 originalPosition;
+    Rectangle frameRectangle;
+    int totalFrames;
+    int currentFrame; // not use right now but later
+    AtlasRegion region;
+} Ingredient;
+
+// Cup
+typedef struct {
+    Texture2D texture;
+    Vector2 position;
+    Vector2 originalPosition;
+    Rectangle frameRectangle;
+    Drink contents;
+    bool active;
+    AtlasRegion region;
+} Cup;
+
+// Cup combinations, one atlas region per reachable cup state
+#define CUP_COMBINATION_COUNT 33
+#define CUP_COMBINATION_EMPTY 0
+
+const char* cupCombinationNames[CUP_COMBINATION_COUNT] = {
+    "EMPTY",
+    "CPN", "CPY",
+    "CPYCM", "CPYCMMA", "CPYCMMACA", "CPYCMMACH", "CPYCMWC", "CPYCMWCCA", "CPYCMWCCH",
+    "CPYMI", "CPYMIMA", "CPYMIMACA", "CPYMIMACH", "CPYMIWC", "CPYMIWCCA", "CPYMIWCCH",
+    "GPN", "GPY",
+    "GPYCM", "GPYCMMA", "GPYCMMACA", "GPYCMMACH", "GPYCMWC", "GPYCMWCCA", "GPYCMWCCH",
+    "GPYMI", "GPYMIMA", "GPYMIMACA", "GPYMIMACH", "GPYMIWC", "GPYMIWCCA", "GPYMIWCCH"
+};
+
+AtlasRegion cupCombinationRegions[CUP_COMBINATION_COUNT];
+int cupStateCombination[DRINK_CODE_COUNT];
+
+// Drop area
+typedef struct {
+    /* data */
+    AtlasRegion region;
+    Vector2 position;
+} DropArea;
+
+DropArea plate;
+
+// Original position
+const Vector2 oricupPosition = { 351,109 };
+const Vector2 oriwaterPosition = { 600, 210 };
+
+const Vector2 oricaramelPosition = { -770,108 };
+const Vector2 orichocolatePosition = { -904,138 };
+const Vector2 oriteapowderPosition = { -421,145 };
+const Vector2 oricocoapowderPosition = { -564,177 };
+const Vector2 oriplatePosition = { -175,300 };
+const Vector2 oriplateCupPosition = { -28, 300 };
+const Vector2 oricondensedmilkPosition = { 283,316 };
+const Vector2 orimilkPosition = { 160,342 };
+const Vector2 orimarshmellowPosition = { -481,320 };
+const Vector2 oriwhippedPosition = { -644,320 };
+const Vector2 oricupsPostion = { 390,80 };
+const Vector2 hiddenPosition = { -3000, -3000 };
+Vector2 trashCanPosition = { 0, 0 };
+
+// Ingredients, in counter draw order
+typedef enum IngredientId {
+    INGREDIENT_NONE = -1,
+    INGREDIENT_TRASH_CAN,
+    INGREDIENT_HOT_WATER,
+    INGREDIENT_CONDENSED_MILK,
+    INGREDIENT_MILK,
+    INGREDIENT_COCOA_POWDER,
+    INGREDIENT_GREEN_TEA_POWDER,
+    INGREDIENT_CHOCOLATE,
+    INGREDIENT_CARAMEL,
+    INGREDIENT_MARSHMELLOW,
+    INGREDIENT_WHIPPED_CREAM,
+    INGREDIENT_COCOA_CHON,
+    INGREDIENT_GREEN_CHON,
+    INGREDIENT_COUNT
+} IngredientId;
+
+typedef enum IngredientFlags {
+    INGREDIENT_DRAGGABLE = 1,   // Can be carried to the cup
+    INGREDIENT_HOVERABLE = 2,   // Shows its next frame under the mouse
+    INGREDIENT_ON_COUNTER = 4,  // Drawn with the counter when idle, others only while carried
+    INGREDIENT_OVER_CUPS = 8,   // Drawn after the cups stack
+    INGREDIENT_BOILS = 16       // Has to be clicked and boiled before it can be poured
+} IngredientFlags;
+
+typedef struct IngredientInfo {
+    const char* regionName;     // Frame count comes from the atlas manifest
+    const Vector2* home;
+    int flags;
+    DrinkSlot slot;             // Slot it fills, DRINK_SLOT_COUNT when it never goes into the cup
+    enum IngredientType type;   // NONE for hot water, which only marks its slot
+    IngredientId carried;       // Sprite that follows the mouse, the ingredient itself unless it is scooped
+    SoundFxType sounds[2];      // Played when it lands in the cup
+} IngredientInfo;
+
+const IngredientInfo ingredientTable[INGREDIENT_COUNT] = {
+    [INGREDIENT_TRASH_CAN] = { "spritesheets/TRASHCAN", &trashCanPosition, INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER, DRINK_SLOT_COUNT, NONE, INGREDIENT_TRASH_CAN, { FX_NONE, FX_NONE } },
+    [INGREDIENT_HOT_WATER] = { "spritesheets/GAR", &oriwaterPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER | INGREDIENT_BOILS, DRINK_WATER, NONE, INGREDIENT_HOT_WATER, { FX_POUR, FX_STIR } },
+    [INGREDIENT_CONDENSED_MILK] = { "spritesheets/CM", &oricondensedmilkPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER, DRINK_CREAMER, CONDENSED_MILK, INGREDIENT_CONDENSED_MILK, { FX_NONE, FX_NONE } },
+    [INGREDIENT_MILK] = { "spritesheets/MI", &orimilkPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER, DRINK_CREAMER, MILK, INGREDIENT_MILK, { FX_POUR, FX_NONE } },
+    [INGREDIENT_COCOA_POWDER] = { "spritesheets/CP", &oricocoapowderPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER | INGREDIENT_OVER_CUPS, DRINK_POWDER, COCOA, INGREDIENT_COCOA_CHON, { FX_NONE, FX_NONE } },
+    [INGREDIENT_GREEN_TEA_POWDER] = { "spritesheets/GP", &oriteapowderPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER | INGREDIENT_OVER_CUPS, DRINK_POWDER, GREEN_TEA, INGREDIENT_GREEN_CHON, { FX_NONE, FX_NONE } },
+    [INGREDIENT_CHOCOLATE] = { "spritesheets/CH", &orichocolatePosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER | INGREDIENT_OVER_CUPS, DRINK_SAUCE, CHOCOLATE, INGREDIENT_CHOCOLATE, { FX_BOTTLE, FX_NONE } },
+    [INGREDIENT_CARAMEL] = { "spritesheets/CA", &oricaramelPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER | INGREDIENT_OVER_CUPS, DRINK_SAUCE, CARAMEL, INGREDIENT_CARAMEL, { FX_BOTTLE, FX_NONE } },
+    [INGREDIENT_MARSHMELLOW] = { "spritesheets/MA", &orimarshmellowPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER | INGREDIENT_OVER_CUPS, DRINK_TOPPING, MARSHMELLOW, INGREDIENT_MARSHMELLOW, { FX_NONE, FX_NONE } },
+    [INGREDIENT_WHIPPED_CREAM] = { "spritesheets/WC", &oriwhippedPosition, INGREDIENT_DRAGGABLE | INGREDIENT_HOVERABLE | INGREDIENT_ON_COUNTER | INGREDIENT_OVER_CUPS, DRINK_TOPPING, WHIPPED_CREAM, INGREDIENT_WHIPPED_CREAM, { FX_NONE, FX_NONE } },
+    [INGREDIENT_COCOA_CHON] = { "spritesheets/cocoachon", &hiddenPosition, 0, DRINK_SLOT_COUNT, NONE, INGREDIENT_COCOA_CHON, { FX_NONE, FX_NONE } },
+    [INGREDIENT_GREEN_CHON] = { "spritesheets/greenchon", &hiddenPosition, 0, DRINK_SLOT_COUNT, NONE, INGREDIENT_GREEN_CHON, { FX_NONE, FX_NONE } }
+};
+
+Ingredient ingredients[INGREDIENT_COUNT];
+
+static int global_score = 0;
+
+// Counted over one round, the headless simulation reports them
+typedef struct SessionStats {
+    int customersSeated;
+    int customersQueued;    // Arrived while every slot was taken
+    int longestQueue;
+    int ordersServed;
+    int wrongOrders;
+    int timeouts;
+    double servedWaitTime;  // Total patience used up by the served customers
+} SessionStats;
+
+SessionStats sessionStats;
+
+bool triggerHotWater = false;
+uint32_t boilGeneration = 0;    // Bumped to cancel the pending boil tick
+
+bool applicationShouldExit = false;
+
+void ExitApplication()
+{
+    applicationShouldExit = true;
+}
+
+// The kettle shows its last frame for 3 seconds, then bubbles on a boil tick every half second until poured
+void boilWater(Ingredient* item) {
+    if (!item->canChangeCupTexture) {
+        triggerHotWater = true;
+        item->currentFrame = item->totalFrames;
+        boilGeneration++;
+        ScheduleEvent(&gameEvents, 3.0, EVENT_BOIL_TICK, item, boilGeneration, 0);
+    }
+}
+
+void StopBoiling(Ingredient* item) {
+    triggerHotWater = false;
+    boilGeneration++;
+    item->canChangeCupTexture = false;
+    item->currentFrame = 1;
+}
+
+void PlaySoundFx(SoundFxType type);
+void SetCupCombination(Cup* cup, int combination);
+bool validiator(Customer* customer, Drink order);
+void BuildCupCombinationName(char* filename, Drink drink)
+{
+    enum IngredientType powderType = GetDrinkIngredient(drink, DRINK_POWDER);
+    bool hasWater = HasDrinkSlot(drink, DRINK_WATER);
+    enum IngredientType creamerType = GetDrinkIngredient(drink, DRINK_CREAMER);
+    enum IngredientType toppingType = GetDrinkIngredient(drink, DRINK_TOPPING);
+    enum IngredientType sauceType = GetDrinkIngredient(drink, DRINK_SAUCE);
+
+    // this is a naming standard for combination
+    // {POWDER}{WATER}{CREAMER}{TOPPING}{SAUCE}.png
+
+    // POWDER:
+    // -Cocoa Powder: CP
+    // -Green Tea Powder: GP
+
+    // WATER:
+    // -Yes: Y
+    // -No: N
+
+    // CREAMER:
+    // -Condensed Milk: CM
+    // -Milk: MI
+
+    // TOPPING:
+    // -Marshmallow: MA
+    // -Whipped Cream: WC
+
+    // SAUCE:
+    // -Caramel: CA
+    // -Chocolate: CH
+
+    // Initialize filename to empty string
+    strcpy(filename, "");
+
+    switch (powderType)
+    {
+    case GREEN_TEA:
+        strcat(filename, "GP");
+        break;
+    case COCOA:
+        strcat(filename, "CP");
+        break;
+    default:
+        break;
+    }
+
+    if (powderType != NONE) {
+        strcat(filename, hasWater ? "Y" : "N");
+    }
+    if (hasWater == true) {
+        switch (creamerType)
+        {
+        case CONDENSED_MILK:
+            strcat(filename, "CM");
+            break;
+        case MILK:
+            strcat(filename, "MI");
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (creamerType != NONE) {
+        switch (toppingType)
+        {
+        case MARSHMELLOW:
+            strcat(filename, "MA");
+            break;
+        case WHIPPED_CREAM:
+            strcat(filename, "WC");
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (toppingType != NONE) {
+        switch (sauceType)
+        {
+        case CARAMEL:
+            strcat(filename, "CA");
+            break;
+        case CHOCOLATE:
+            strcat(filename, "CH");
+            break;
+        default:
+            break;
+        }
+    }
+    // if empty then set filename to EMPTY
+    if (strcmp(filename, "") == 0) {
+        strcat(filename, "EMPTY");
+    }
+}
+
+// UpdateCup fills the slots in order, so a cup only ever holds a run of filled slots starting at the powder
+bool IsDrinkReachable(Drink drink)
+{
+    for (int slot = DRINK_WATER; slot < DRINK_SLOT_COUNT; slot++)
+        if (HasDrinkSlot(drink, (DrinkSlot)slot) && !HasDrinkSlot(drink, (DrinkSlot)(slot - 1)))
+            return false;
+
+    return true;
+}
+
+void LoadCupCombinations()
+{
+    for (int i = 0; i < CUP_COMBINATION_COUNT; i++)
+        cupCombinationRegions[i] = GetAtlasRegion(&spriteAtlas, TextFormat("combination/%s", cupCombinationNames[i]));
+
+    // Resolve every drink to its region once, so cup updates never touch the disk or compare names.
+    // States UpdateCup cannot produce stay on the empty cup.
+    int reachable = 0;
+    int missing = 0;
+    char name[32];
+
+    for (int powder = 0; powder < 3; powder++)
+        for (int water = 0; water < 2; water++)
+            for (int creamer = 0; creamer < 3; creamer++)
+                for (int topping = 0; topping < 3; topping++)
+                    for (int sauce = 0; sauce < 3; sauce++)
+                    {
+                        Drink drink = DRINK_EMPTY;
+                        drink = SetDrinkSlot(drink, DRINK_POWDER, powder);
+                        drink = SetDrinkSlot(drink, DRINK_WATER, water);
+                        drink = SetDrinkSlot(drink, DRINK_CREAMER, creamer);
+                        drink = SetDrinkSlot(drink, DRINK_TOPPING, topping);
+                        drink = SetDrinkSlot(drink, DRINK_SAUCE, sauce);
+
+                        cupStateCombination[drink] = CUP_COMBINATION_EMPTY;
+                        if (!IsDrinkReachable(drink))
+                            continue;
+
+                        reachable++;
+                        BuildCupCombinationName(name, drink);
+
+                        int combination = CUP_COMBINATION_EMPTY;
+                        bool found = false;
+                        for (int i = 0; i < CUP_COMBINATION_COUNT; i++)
+                        {
+                            if (strcmp(cupCombinationNames[i], name) == 0)
+                            {
+                                combination = i;
+                                found = true;
+                                break;
+                            }
+                        }
+
+                        if (!found || cupCombinationRegions[combination].texture.id == 0)
+                        {
+                            Log(LOG_ERROR, "Drink %03x (%s) has no combination texture", drink, name);
+                            combination = CUP_COMBINATION_EMPTY;
+                            missing++;
+                        }
+
+                        cupStateCombination[drink] = combination;
+                    }
+
+    if (missing > 0)
+        Log(LOG_ERROR, "%d of %d reachable cup states are missing a combination texture", missing, reachable);
+    else
+        Log(LOG_INFO, "All %d reachable cup states resolved to %d combination textures", reachable, CUP_COMBINATION_COUNT);
+}
+
+void SetCupCombination(Cup* cup, int combination)
+{
+    cup->region = cupCombinationRegions[combination];
+    cup->texture = cup->region.texture;
+    cup->frameRectangle = GetAtlasFrame(cup->region, 1);
+}
+
+// The counter ingredient that fills this slot of the drink
+IngredientId FindIngredientForSlot(Drink drink, DrinkSlot slot)
+{
+    enum IngredientType type = GetDrinkIngredient(drink, slot);
+
+    for (int i = 0; i < INGREDIENT_COUNT; i++)
+    {
+        const IngredientInfo* info = &ingredientTable[i];
+        if ((info->flags & INGREDIENT_DRAGGABLE) && info->slot == slot && info->type == type)
+            return (IngredientId)i;
+    }
+
+    return INGREDIENT_NONE;
+}
+
+void UpdateCupImage(Cup* cup) {
+    int combination = cupStateCombination[cup->contents];
+
+    SetCupCombination(cup, combination);
+}
+
+// Fills the ingredient's slot once the slot before it is filled, returns false when the cup did not take it
+bool UpdateCup(Cup* cup, IngredientId id) {
+    // If cup is not active, return
+    if (!cup->active) return false;
+
+    const IngredientInfo* info = &ingredientTable[id];
+    Drink contents = cup->contents;
+
+    if (info->slot == DRINK_SLOT_COUNT || HasDrinkSlot(contents, info->slot))
+        return false;
+    if (info->slot != DRINK_POWDER && !HasDrinkSlot(contents, (DrinkSlot)(info->slot - 1)))
+        return false;
+
+    if (info->type != NONE)
+        cup->contents = AddDrinkIngredient(contents, info->type);
+    else
+        cup->contents = SetDrinkSlot(contents, info->slot, 1);
+
+    for (int i = 0; i < 2; i++)
+        PlaySoundFx(info->sounds[i]);
+
+    UpdateCupImage(cup);
+    return true;
+}
+
+Rectangle frameRect(Ingredient i, int frameToShow) {
+    return GetAtlasFrame(i.region, frameToShow);
+}
+
+Rectangle frameRectCup(Cup i, int frameToShow) {
+    return GetAtlasFrame(i.region, frameToShow);
+}
+
+// Frame count comes from the atlas manifest
+Ingredient CreateIngredient(const char* regionName, bool canChangeCupTexture, Vector2 position)
+{
+    Ingredient ingredient = { 0 };
+    ingredient.region = GetAtlasRegion(&spriteAtlas, regionName);
+    ingredient.texture = ingredient.region.texture;
+    ingredient.canChangeCupTexture = canChangeCupTexture;
+    ingredient.position = position;
+    ingredient.originalPosition = position;
+    ingredient.totalFrames = ingredient.region.frames;
+    ingredient.currentFrame = 1;
+    ingredient.frameRectangle = frameRect(ingredient, ingredient.currentFrame);
+    return ingredient;
+}
+
+// Boiling ingredients only go into the cup once they were boiled
+bool IsIngredientReady(const IngredientInfo* info)
+{
+    return (info->flags & INGREDIENT_DRAGGABLE) && !(info->flags & INGREDIENT_BOILS);
+}
+
+void CreateIngredients()
+{
+    for (int i = 0; i < INGREDIENT_COUNT; i++)
+    {
+        const IngredientInfo* info = &ingredientTable[i];
+        ingredients[i] = CreateIngredient(info->regionName, IsIngredientReady(info), *info->home);
+    }
+}
+
+Rectangle GetIngredientBounds(const Ingredient* item)
+{
+    return (Rectangle) { item->position.x, item->position.y, item->frameRectangle.width, item->frameRectangle.height };
+}
+
+void tickBoil(Ingredient* boiler) {
+    PROFILE_BEGIN("Boil");
+    StopSound(boongFx);
+    PlaySoundFx(FX_BOONG);
+    boiler->canChangeCupTexture = true;
+    int nextFrame = boiler->currentFrame + 2;
+    if (nextFrame > boiler->totalFrames) {
+        nextFrame = 1;
+    }
+    boiler->currentFrame = nextFrame;
+    ScheduleEvent(&gameEvents, 0.5, EVENT_BOIL_TICK, boiler, boilGeneration, 0);
+    PROFILE_END();
+}
+
+
+bool highlightItem(Ingredient* item, Vector2 mousePos) {
+    if (CheckCollisionPointRec(mousePos, GetIngredientBounds(item)) && item->totalFrames > item->currentFrame) {
+        item->frameRectangle = frameRect(*item, item->currentFrame + 1);
+        return true;
+    }
+    else {
+        item->frameRectangle = frameRect(*item, item->currentFrame);
+        return false;
+    }
+}
+
+// Scenes
+typedef enum {
+    SCENE_NONE = -1,
+    SCENE_SPLASH,
+    SCENE_MAIN_MENU,
+    SCENE_OPTIONS,
+    SCENE_GAME,
+    SCENE_ENDGAME,
+    SCENE_COUNT
+} SceneType;
+
+typedef struct Scene {
+    void (*enter)(Camera2D* camera);
+    void (*update)(Camera2D* camera, double deltaTime);
+    void (*draw)(Camera2D* camera, double deltaTime);
+    void (*exit)(Camera2D* camera);
+    const struct AssetSet* assets;  // Held while the scene is current, may be NULL
+} Scene;
+
+SceneType currentScene = SCENE_NONE;
+SceneType nextScene = SCENE_NONE;
+double sceneLastFrameTime = 0.0;
+
+// CPU time spent on update and draw submission, excluding the buffer swap and frame limiter
+double frameCpuTime = 0.0;
+double frameCpuTimeAverage = 0.0;
+
+// Web builds log the average CPU time regularly, so the two loop variants can be compared from the browser console
+#define WEB_CPU_REPORT_INTERVAL 10.0
+double webCpuReportTime = 0.0;
+
+// Last frame split into update, draw submission and EndDrawing (swap and frame limiter)
+double frameUpdateTime = 0.0;
+double frameDrawTime = 0.0;
+double framePresentTime = 0.0;
+
+// Above 0 every frame advances the game by this much instead of the measured time, the benchmark sets it
+double fixedFrameTime = 0.0;
+
+// Function prototype
+void ChangeScene(SceneType scene);
+void ChangeSceneToMainMenu(bool playFade);
+
+// Menu customers
+Customer menuCustomer1;
+Customer menuCustomer2;
+
+// Menu falling items
+#define menuFallingItemsNumber 8
+MenuFallingItem menuFallingItems[20];
+GameOptions *options;
+
+// Moving clouds
+MovingCloud movingClouds[7];
+
+// Moving stars
+MovingStar movingStars[2];
+
+// Current BGM
+Music* currentBgm = NULL;
+bool isCurrentBgmPaused = false;
+
+// Load duration timer
+double loadDurationTimer = 0.0;
+bool isGlobalAssetsLoadFinished = false;
+
+// Asset registry
+// Every scene holds an asset set while it is current. Assets shared by several scenes are reference counted, so
+// moving between them never reloads anything, and whatever a scene alone needs is unloaded when it is left.
+#define ASSET_REGISTRY_CAPACITY 96
+
+typedef struct AssetUse {
+    AssetKind kind;
+    const char* path;
+    void* target;   // The Texture2D, Sound or Music global it is loaded into
+} AssetUse;
+
+typedef struct AssetSet {
+    const char* name;
+    const struct AssetSet* base;    // Acquired and released together with this set
+    const AssetUse* uses;
+    int count;
+} AssetSet;
+
+typedef struct RegistryEntry {
+    AssetUse use;
+    int refCount;
+} RegistryEntry;
+
+typedef struct AssetRegistry {
+    RegistryEntry entries[ASSET_REGISTRY_CAPACITY];
+    int entryCount;
+    int loadCount;
+    int unloadCount;
+} AssetRegistry;
+
+AssetRegistry assetRegistry;
+
+RegistryEntry* FindRegistryEntry(void* target)
+{
+    for (int i = 0; i < assetRegistry.entryCount; i++)
+    {
+        if (assetRegistry.entries[i].use.target == target)
+            return &assetRegistry.entries[i];
+    }
+
+    return NULL;
+}
+
+void LoadRegistryEntry(RegistryEntry* entry)
+{
+    switch (entry->use.kind)
+    {
+    case ASSET_TEXTURE: RequestTexture(entry->use.path, (Texture2D*)entry->use.target); break;
+    case ASSET_SOUND: RequestSound(entry->use.path, (Sound*)entry->use.target); break;
+    case ASSET_MUSIC: *(Music*)entry->use.target = TrackMusic(LoadMusicStream(entry->use.path)); break;
+    }
+
+    assetRegistry.loadCount++;
+}
+
+void UnloadRegistryEntry(RegistryEntry* entry)
+{
+    switch (entry->use.kind)
+    {
+    case ASSET_TEXTURE:
+        UnloadTrackedTexture(*(Texture2D*)entry->use.target);
+        *(Texture2D*)entry->use.target = (Texture2D){ 0 };
+        break;
+    case ASSET_SOUND:
+        UnloadTrackedSound(*(Sound*)entry->use.target);
+        *(Sound*)entry->use.target = (Sound){ 0 };
+        break;
+    case ASSET_MUSIC:
+        if (currentBgm == entry->use.target)
+            currentBgm = NULL;
+        UnloadTrackedMusic(*(Music*)entry->use.target);
+        *(Music*)entry->use.target = (Music){ 0 };
+        break;
+    }
+
+    assetRegistry.unloadCount++;
+}
+
+// Textures and sounds that were not held yet are queued on the asset loader, flush it before drawing with them
+void AcquireAssetSet(const AssetSet* set)
+{
+    if (set == NULL)
+        return;
+
+    AcquireAssetSet(set->base);
+
+    for (int i = 0; i < set->count; i++)
+    {
+        RegistryEntry* entry = FindRegistryEntry(set->uses[i].target);
+        if (entry == NULL)
+        {
+            if (assetRegistry.entryCount >= ASSET_REGISTRY_CAPACITY)
+            {
+                Log(LOG_ERROR, "Asset registry is full, %s is not tracked", set->uses[i].path);
+                continue;
+            }
+
+            entry = &assetRegistry.entries[assetRegistry.entryCount++];
+            *entry = (RegistryEntry){ set->uses[i], 0 };
+        }
+
+        if (entry->refCount++ == 0)
+            LoadRegistryEntry(entry);
+    }
+}
+
+void ReleaseAssetSet(const AssetSet* set)
+{
+    if (set == NULL)
+        return;
+
+    for (int i = 0; i < set->count; i++)
+    {
+        RegistryEntry* entry = FindRegistryEntry(set->uses[i].target);
+        if (entry == NULL || entry->refCount == 0)
+        {
+            Log(LOG_ERROR, "%s released by %s more often than it was acquired", set->uses[i].path, set->name);
+            continue;
+        }
+
+        if (--entry->refCount == 0)
+            UnloadRegistryEntry(entry);
+    }
+
+    ReleaseAssetSet(set->base);
+}
+
+size_t GetAtlasBytes(Atlas* atlas, int* textureCount)
+{
+    size_t bytes = 0;
+
+    for (int i = 0; i < atlas->pageCount; i++)
+    {
+        if (atlas->pages[i].id != 0)
+        {
+            bytes += GetTextureBytes(atlas->pages[i]);
+            (*textureCount)++;
+        }
+    }
+
+    for (int i = 0; i < atlas->entryCount; i++)
+    {
+        if (atlas->entries[i].standalone)
+        {
+            bytes += GetTextureBytes(atlas->entries[i].region.texture);
+            (*textureCount)++;
+        }
+    }
+
+    return bytes;
+}
+
+// Totals over the registry and the atlases, the two make up every texture and sound the game keeps loaded
+typedef struct AssetUsage {
+    int textures;
+    size_t textureBytes;
+    int sounds;
+    size_t soundBytes;
+    int music;
+} AssetUsage;
+
+AssetUsage GetAssetUsage()
+{
+    AssetUsage usage = { 0 };
+
+    for (int i = 0; i < assetRegistry.entryCount; i++)
+    {
+        RegistryEntry* entry = &assetRegistry.entries[i];
+        if (entry->refCount == 0)
+            continue;
+
+        switch (entry->use.kind)
+        {
+        case ASSET_TEXTURE:
+            usage.textures++;
+            usage.textureBytes += GetTextureBytes(*(Texture2D*)entry->use.target);
+            break;
+        case ASSET_SOUND:
+            usage.sounds++;
+            usage.soundBytes += GetSoundBytes(*(Sound*)entry->use.target);
+            break;
+        case ASSET_MUSIC:
+            usage.music++;
+            break;
+        }
+    }
+
+    usage.textureBytes += GetAtlasBytes(&spriteAtlas, &usage.textures);
+    usage.textureBytes += GetAtlasBytes(&customerAtlas, &usage.textures);
+    return usage;
+}
+
+void LogAssetUsage(const char* when)
+{
+    AssetUsage usage = GetAssetUsage();
+    Log(LOG_INFO, "Assets %s: %d textures (%.1f MB), %d sounds (%.1f MB), %d music streams, %d loads, %d unloads", when,
+        usage.textures, usage.textureBytes / (1024.0 * 1024.0), usage.sounds, usage.soundBytes / (1024.0 * 1024.0), usage.music,
+        assetRegistry.loadCount, assetRegistry.unloadCount);
+}
+
+// At shutdown every set should have been released
+void ReportAssetLeaks()
+{
+    int leaks = 0;
+
+    for (int i = 0; i < assetRegistry.entryCount; i++)
+    {
+        RegistryEntry* entry = &assetRegistry.entries[i];
+        if (entry->refCount == 0)
+            continue;
+
+        Log(LOG_WARNING, "Asset %s still held %d times at shutdown", entry->use.path, entry->refCount);
+        UnloadRegistryEntry(entry);
+        entry->refCount = 0;
+        leaks++;
+    }
+
+    if (leaks == 0)
+        Log(LOG_INFO, "All scene assets released, %d loads and %d unloads", assetRegistry.loadCount, assetRegistry.unloadCount);
+}
+
+// Start from night
+int currentColorIndex = 3;
+float dayNightCycleDuration = 120.0f;
+// Skip to 1/2 of the night, so that the first transition is from night to morning
+float colorTransitionTime = 0.5f;
+
+
+// Raylib logs from the loader workers too, the ring takes messages from any thread without locking
+void CustomLogger(int msgType, const char* text, va_list args)
+{
+    if (msgType < LOG_COMPILE_LEVEL || msgType < minimumLogLevel)
+        return;
+
+    if (logRing != NULL)
+    {
+        WriteLogRing(logRing, msgType, text, args);
+        return;
+    }
+
+    // No ring before OpenLogRing and in the headless simulation, whose few warnings print in order with its results
+    printf("%s", GetLogLevelPrefix(msgType));
+    vprintf(text, args);
+    printf("\n");
+}
+
+#if LOG_COMPILE_LEVEL <= LOG_RING_DEBUG
+void LogDebug(const char* text, ...)
+{
+    va_list args;
+    va_start(args, text);
+    CustomLogger(LOG_DEBUG, text, args);
+    va_end(args);
+}
+#endif
+
+void Log(int msgType, const char* text, ...)
+{
+    va_list args;
+    va_start(args, text);
+    CustomLogger(msgType, text, args);
+    va_end(args);
+}
+
+// MEOW_LOG_FILE=<file> writes the log to a file instead of stdout
+void OpenLogRing(void)
+{
+    const char* path = getenv("MEOW_LOG_FILE");
+    if (path != NULL && path[0] != '\0')
+        logFile = fopen(path, "w");
+
+    logRing = CreateLogRing(logFile != NULL ? logFile : stdout);
+
+    if (path != NULL && path[0] != '\0' && logFile == NULL)
+        Log(LOG_WARNING, "Cannot open log file %s, logging to stdout", path);
+}
+
+// After CloseWindow, so raylib's shutdown messages still go through the ring
+void CloseLogRing(void)
+{
+    LogRing* ring = logRing;
+    logRing = NULL;
+    DestroyLogRing(ring);
+
+    if (logFile != NULL)
+        fclose(logFile);
+    logFile = NULL;
+}
+
+Color GetTextColorFromLogType(TraceLogLevel level)
+{
+	switch (level)
+	{
+    case LOG_DEBUG: return DARKGRAY;
+	case LOG_INFO: return WHITE;
+	case LOG_WARNING: return YELLOW;
+	case LOG_ERROR: return RED;
+    case LOG_FATAL: return ORANGE;
+	default: return WHITE;
+	}
+}
+
+// GPU counters
+// Everything is drawn into a render batch owned by the game instead of rlgl's default one, so its draw calls can be
+// read back right before they are flushed. FlushGpuBatch samples and flushes the batch, and is called before anything
+// that flushes it otherwise (EndMode2D, blend mode changes). Flushes rlgl does on its own when the batch is full are
+// not seen. The overdraw view keeps every quad of the frame and draws them again additively over black.
+#define OVERDRAW_MAX_QUADS 8192
+
+typedef struct GpuFrameStats {
+    int drawCalls;
+    int batches;
+    int textureBinds;
+    int vertices;
+    double pixels;  // Covered by quads in framebuffer pixels, every layer counts
+} GpuFrameStats;
+
+typedef struct GpuCounters {
+    bool active;
+    bool counting;
+    bool overdraw;
+    bool offscreen; // Drawing into a layer cache, counted but not part of the heatmap
+    rlRenderBatch batch;
+    unsigned int lastTexture;
+    float pixelScale;
+    GpuFrameStats frame;
+    GpuFrameStats last;
+    int overdrawQuadCount;
+} GpuCounters;
+
+GpuCounters gpuCounters = { 0 };
+Vector2 overdrawQuads[OVERDRAW_MAX_QUADS][4];
+
+void InitGpuCounters(void)
+{
+    gpuCounters.batch = rlLoadRenderBatch(1, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+    rlSetRenderBatchActive(&gpuCounters.batch);
+    gpuCounters.active = true;
+}
+
+void UnloadGpuCounters(void)
+{
+    if (!gpuCounters.active)
+        return;
+
+    // Back to rlgl's default batch before ours goes away
+    rlSetRenderBatchActive(NULL);
+    rlUnloadRenderBatch(gpuCounters.batch);
+    gpuCounters.active = false;
+}
+
+void BeginGpuFrame(bool counting, bool overdraw, float pixelScale)
+{
+    gpuCounters.counting = counting || overdraw;
+    gpuCounters.overdraw = overdraw;
+    gpuCounters.pixelScale = pixelScale;
+    gpuCounters.frame = (GpuFrameStats){ 0 };
+    gpuCounters.lastTexture = 0;
+    gpuCounters.overdrawQuadCount = 0;
+}
+
+void EndGpuFrame(void)
+{
+    gpuCounters.last = gpuCounters.frame;
+    gpuCounters.counting = false;
+}
+
+void FlushGpuBatch(void)
+{
+    if (!gpuCounters.active || !gpuCounters.counting)
+        return;
+
+    rlRenderBatch* batch = &gpuCounters.batch;
+    const float* vertices = batch->vertexBuffer[batch->currentBuffer].vertices;
+    GpuFrameStats* stats = &gpuCounters.frame;
+    int drawCalls = 0;
+
+    // Same walk as rlDrawRenderBatch, each draw call starts after the previous one's vertices and alignment padding
+    for (int i = 0, vertexOffset = 0; i < batch->drawCounter; i++)
+    {
+        const rlDrawCall* draw = &batch->draws[i];
+
+        if (draw->vertexCount > 0)
+        {
+            drawCalls++;
+            stats->vertices += draw->vertexCount;
+
+            if (draw->textureId != gpuCounters.lastTexture)
+            {
+                stats->textureBinds++;
+                gpuCounters.lastTexture = draw->textureId;
+            }
+        }
+
+        for (int q = 0; draw->mode == RL_QUADS && q + 3 < draw->vertexCount; q += 4)
+        {
+            Vector2 corners[4];
+            for (int k = 0; k < 4; k++)
+            {
+                const float* vertex = &vertices[(vertexOffset + q + k) * 3];
+                corners[k] = (Vector2){ vertex[0], vertex[1] };
+            }
+
+            // Shoelace, quads may be rotated
+            float area = 0.0f;
+            for (int k = 0; k < 4; k++)
+                area += corners[k].x * corners[(k + 1) % 4].y - corners[(k + 1) % 4].x * corners[k].y;
+            stats->pixels += fabsf(area) * 0.5f * gpuCounters.pixelScale * gpuCounters.pixelScale;
+
+            if (gpuCounters.overdraw && !gpuCounters.offscreen && gpuCounters.overdrawQuadCount < OVERDRAW_MAX_QUADS)
+                memcpy(overdrawQuads[gpuCounters.overdrawQuadCount++], corners, sizeof(corners));
+        }
+
+        vertexOffset += draw->vertexCount + draw->vertexAlignment;
+    }
+
+    if (drawCalls > 0)
+    {
+        stats->drawCalls += drawCalls;
+        stats->batches++;
+    }
+
+    rlDrawRenderBatchActive();
+}
+
+// Each layer adds the same dim orange, so about 8 layers show as bright orange and 16 or more as white
+void DrawOverdrawHeatmap(void)
+{
+    FlushGpuBatch();
+
+    // The heatmap's own quads are not part of the frame
+    gpuCounters.counting = false;
+
+    DrawRectangle(baseX, baseY, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, BLACK);
+    BeginBlendMode(BLEND_ADDITIVE);
+
+    for (int i = 0; i < gpuCounters.overdrawQuadCount; i++)
+    {
+        rlCheckRenderBatchLimit(4);
+        rlBegin(RL_QUADS);
+        rlColor4ub(32, 16, 8, 255);
+        for (int k = 0; k < 4; k++)
+            rlVertex2f(overdrawQuads[i][k].x, overdrawQuads[i][k].y);
+        rlEnd();
+    }
+
+    EndBlendMode();
+
+    double screenPixels = BASE_SCREEN_WIDTH * BASE_SCREEN_HEIGHT * gpuCounters.pixelScale * gpuCounters.pixelScale;
+    DrawRectangle(baseX + 10, baseY + BASE_SCREEN_HEIGHT - 40, 700, 30, Fade(GRAY, 0.7));
+    DrawTextEx(meowFont, TextFormat("Overdraw | %d quads | %.1fx the screen%s", gpuCounters.overdrawQuadCount, screenPixels > 0 ? gpuCounters.frame.pixels / screenPixels : 0.0,
+        gpuCounters.overdrawQuadCount == OVERDRAW_MAX_QUADS ? " | quad limit reached" : ""), (Vector2) { baseX + 20, baseY + BASE_SCREEN_HEIGHT - 35 }, 20, 2, WHITE);
+}
+
+// Sprite queue
+// Sprites are collected between BeginSpriteQueue and EndSpriteQueue, then regrouped by texture so raylib's batch
+// only has to switch textures once per group. A sprite is only moved back into an earlier group when it does not
+// overlap anything submitted in between, so the result looks exactly like drawing in submission order.
+// Shapes and text are not queued, flush before drawing them.
+#define SPRITE_QUEUE_CAPACITY 256
+
+typedef struct SpriteCommand {
+    Texture2D texture;
+    Rectangle source;
+    Rectangle dest;
+    Vector2 origin;
+    float rotation;
+    Color tint;
+    Rectangle bounds;
+    int next;
+} SpriteCommand;
+
+typedef struct SpriteBatch {
+    unsigned int textureId;
+    int first;
+    int last;
+} SpriteBatch;
+
+typedef struct SpriteQueueStats {
+    int sprites;
+    int bindsUnsorted;
+    int bindsSorted;
+    int flushes;
+} SpriteQueueStats;
+
+SpriteCommand spriteQueue[SPRITE_QUEUE_CAPACITY];
+SpriteBatch spriteBatches[SPRITE_QUEUE_CAPACITY];
+int spriteQueueCount = 0;
+int spriteBatchCount = 0;
+unsigned int spriteQueueLastTexture = 0;
+bool spriteQueueActive = false;
+
+SpriteQueueStats spriteQueueStats = { 0 };
+
+void ResetSpriteQueueStats()
+{
+    spriteQueueStats = (SpriteQueueStats){ 0 };
+}
+
+void FlushSpriteQueue()
+{
+    if (spriteQueueCount == 0)
+        return;
+
+    PROFILE_BEGIN("Sprite flush");
+
+    for (int b = 0; b < spriteBatchCount; b++)
+    {
+        for (int i = spriteBatches[b].first; i != -1; i = spriteQueue[i].next)
+        {
+            SpriteCommand* sprite = &spriteQueue[i];
+            DrawTexturePro(sprite->texture, sprite->source, sprite->dest, sprite->origin, sprite->rotation, sprite->tint);
+        }
+    }
+
+    spriteQueueStats.bindsSorted += spriteBatchCount;
+    spriteQueueStats.flushes++;
+
+    spriteQueueCount = 0;
+    spriteBatchCount = 0;
+    spriteQueueLastTexture = 0;
+
+    PROFILE_END();
+}
+
+void BeginSpriteQueue()
+{
+    FlushSpriteQueue();
+    spriteQueueActive = true;
+}
+
+void EndSpriteQueue()
+{
+    FlushSpriteQueue();
+    spriteQueueActive = false;
+}
+
+// Axis aligned bounds of a sprite as DrawTexturePro places it, rotation included
+Rectangle GetSpriteBounds(Rectangle dest, Vector2 origin, float rotation)
+{
+    if (rotation == 0.0f)
+        return (Rectangle){ dest.x - origin.x, dest.y - origin.y, dest.width, dest.height };
+
+    float sinRotation = sinf(rotation * DEG2RAD);
+    float cosRotation = cosf(rotation * DEG2RAD);
+    Vector2 corners[4] = {
+        { -origin.x, -origin.y },
+        { -origin.x + dest.width, -origin.y },
+        { -origin.x, -origin.y + dest.height },
+        { -origin.x + dest.width, -origin.y + dest.height }
+    };
+
+    float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+    for (int i = 0; i < 4; i++)
+    {
+        float x = dest.x + corners[i].x * cosRotation - corners[i].y * sinRotation;
+        float y = dest.y + corners[i].x * sinRotation + corners[i].y * cosRotation;
+        minX = fminf(minX, x);
+        minY = fminf(minY, y);
+        maxX = fmaxf(maxX, x);
+        maxY = fmaxf(maxY, y);
+    }
+
+    return (Rectangle){ minX, minY, maxX - minX, maxY - minY };
+}
+
+bool DoesSpriteBatchOverlap(SpriteBatch* batch, Rectangle bounds)
+{
+    for (int i = batch->first; i != -1; i = spriteQueue[i].next)
+    {
+        if (CheckCollisionRecs(spriteQueue[i].bounds, bounds))
+            return true;
+    }
+    return false;
+}
+
+void QueueTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint)
+{
+    if (!spriteQueueActive)
+    {
+        DrawTexturePro(texture, source, dest, origin, rotation, tint);
+        return;
+    }
+
+    if (texture.id == 0)
+        return;
+
+    if (spriteQueueCount >= SPRITE_QUEUE_CAPACITY)
+        FlushSpriteQueue();
+
+    // Binds the sprites would cost if drawn as submitted
+    if (spriteQueueCount == 0 || texture.id != spriteQueueLastTexture)
+        spriteQueueStats.bindsUnsorted++;
+    spriteQueueLastTexture = texture.id;
+    spriteQueueStats.sprites++;
+
+    int index = spriteQueueCount++;
+    SpriteCommand* sprite = &spriteQueue[index];
+    sprite->texture = texture;
+    sprite->source = source;
+    sprite->dest = dest;
+    sprite->origin = origin;
+    sprite->rotation = rotation;
+    sprite->tint = tint;
+    sprite->bounds = GetSpriteBounds(dest, origin, rotation);
+    sprite->next = -1;
+
+    // Walk back to the closest batch with the same texture, unless something in between is covered by this sprite
+    for (int b = spriteBatchCount - 1; b >= 0; b--)
+    {
+        SpriteBatch* batch = &spriteBatches[b];
+
+        if (batch->textureId == texture.id)
+        {
+            spriteQueue[batch->last].next = index;
+            batch->last = index;
+            return;
+        }
+
+        if (DoesSpriteBatchOverlap(batch, sprite->bounds))
+            break;
+    }
+
+    spriteBatches[spriteBatchCount++] = (SpriteBatch){ texture.id, index, index };
+}
+
+void QueueTextureEx(Texture2D texture, Vector2 position, float rotation, float scale, Color tint)
+{
+    Rectangle source = { 0.0f, 0.0f, (float)texture.width, (float)texture.height };
+    Rectangle dest = { position.x, position.y, (float)texture.width * scale, (float)texture.height * scale };
+    QueueTexturePro(texture, source, dest, (Vector2) { 0, 0 }, rotation, tint);
+}
+
+void QueueTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint)
+{
+    Rectangle dest = { position.x, position.y, fabsf(source.width), fabsf(source.height) };
+    QueueTexturePro(texture, source, dest, (Vector2) { 0, 0 }, 0.0f, tint);
+}
+
+void QueueTexture(Texture2D texture, int posX, int posY, Color tint)
+{
+    QueueTextureEx(texture, (Vector2) { (float)posX, (float)posY }, 0.0f, 1.0f, tint);
+}
+
+void QueueAtlasFrame(AtlasRegion region, int frame, Vector2 position, float scale, Color tint)
+{
+    Rectangle source = GetAtlasFrame(region, frame);
+    Vector2 size = GetAtlasFrameSize(region);
+    Rectangle dest = { position.x, position.y, size.x * scale, size.y * scale };
+    QueueTexturePro(region.texture, source, dest, (Vector2) { 0, 0 }, 0.0f, tint);
+}
+
+void DrawAtlasFrame(AtlasRegion region, int frame, Vector2 position, float scale, Color tint)
+{
+    Rectangle source = GetAtlasFrame(region, frame);
+    Vector2 size = GetAtlasFrameSize(region);
+    Rectangle dest = { position.x, position.y, size.x * scale, size.y * scale };
+    DrawTexturePro(region.texture, source, dest, (Vector2) { 0, 0 }, 0.0f, tint);
+}
+
+void DrawDragableItemFrame(Ingredient i) {
+    QueueTextureRec(i.texture, i.frameRectangle, i.position, RAYWHITE);
+    if (options->showDebug && debugToolToggles.showObjects)
+    {
+        FlushSpriteQueue();
+        DrawRectangleLinesEx((Rectangle) { i.position.x, i.position.y, i.frameRectangle.width, i.frameRectangle.height }, 1, RED);
+        DrawRectangle(i.position.x, i.position.y - 20, 300, 20, Fade(GRAY, 0.7));
+        DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f", "Ingredient", i.position.x, i.position.y), (Vector2) { i.position.x, i.position.y - 20 }, 20, 1, WHITE);
+    }
+}
+
+
+void DrawMenuFallingItems(double deltaTime, bool behide)
+{
+    int startIndex = behide ? 0 : 11;
+    int endIndex = behide ? 11 : 20;
+
+    for (int i = startIndex; i < endIndex; i++) {
+        MenuFallingItem* item = &menuFallingItems[i];
+
+        item->position.y += item->fallingSpeed * deltaTime;
+        item->rotation += item->rotationSpeed * deltaTime;
+
+        Vector2 origin = { (float)menuFallingItemTextures[item->textureIndex].width / 2, (float)menuFallingItemTextures[item->textureIndex].height / 2 };
+        QueueTexturePro(menuFallingItemTextures[item->textureIndex], (Rectangle) { 0, 0, menuFallingItemTextures[item->textureIndex].width, menuFallingItemTextures[item->textureIndex].height },
+            (Rectangle) {
+            item->position.x, item->position.y, menuFallingItemTextures[item->textureIndex].width, menuFallingItemTextures[item->textureIndex].height
+        },
+            origin, item->rotation, WHITE);
+
+        if (options->showDebug && debugToolToggles.showObjects) {
+            FlushSpriteQueue();
+
+            Vector2 corners[4];
+            corners[0] = (Vector2){ -origin.x, -origin.y };
+            corners[1] = (Vector2){ -origin.x, origin.y };
+            corners[2] = (Vector2){ origin.x, origin.y };
+            corners[3] = (Vector2){ origin.x, -origin.y };
+
+            for (int j = 0; j < 4; j++) {
+                float tempX = corners[j].x * cos(DEG2RAD * item->rotation) - corners[j].y * sin(DEG2RAD * item->rotation);
+                float tempY = corners[j].x * sin(DEG2RAD * item->rotation) + corners[j].y * cos(DEG2RAD * item->rotation);
+                corners[j].x = tempX + item->position.x;
+                corners[j].y = tempY + item->position.y;
+            }
+
+            DrawLineEx(corners[0], corners[1], 1, RED);
+            DrawLineEx(corners[1], corners[2], 1, RED);
+            DrawLineEx(corners[2], corners[3], 1, RED);
+            DrawLineEx(corners[3], corners[0], 1, RED);
+
+            DrawRectangle(item->position.x, item->position.y, 550, 20, Fade(GRAY, 0.7));
+            DrawTextEx(meowFont, TextFormat("%d | XY %.2f,%.2f | R %.2f | G %.2f | Behide %s", i, item->position.x, item->position.y, item->rotation, item->fallingSpeed, behide ? "[Yes]" : "[No]"), (Vector2) { item->position.x, item->position.y }, 20, 1, WHITE);
+        }
+
+        if (item->position.y > baseY + BASE_SCREEN_HEIGHT + 1000) {
+            item->position = (Vector2){ RandomDouble(RANDOM_VISUALS, baseX, baseX + BASE_SCREEN_WIDTH - 20), baseY - RandomDouble(RANDOM_VISUALS, 200, 1000) };
+            item->textureIndex = RandomInt(RANDOM_VISUALS, 0, menuFallingItemsNumber - 1);
+            item->fallingSpeed = RandomDouble(RANDOM_VISUALS, 1, 3);
+            item->fallingSpeed *= 100;
+            item->rotation = RandomDouble(RANDOM_VISUALS, -360, 360);
+            item->rotationSpeed = RandomInt(RANDOM_VISUALS, -3, 3);
+            item->rotationSpeed *= 100;
+            if (fabsf(item->rotationSpeed) > item->fallingSpeed)
+                item->rotationSpeed = item->fallingSpeed;
+            if (item->rotationSpeed == 0)
+                item->rotationSpeed = 1 * 100;
+        }
+    }
+}
+
+bool IsNight()
+{
+    return currentColorIndex == 3 && colorTransitionTime < 0.4;
+}
+
+void DrawMovingCloudAndStar(double deltaTime)
+{
+    int cloudCount = sizeof(movingClouds) / sizeof(movingClouds[0]);
+    int starCount = sizeof(movingStars) / sizeof(movingStars[0]);
+
+    if (IsNight())
+    {
+
+        for (int i = 0; i < starCount; i++) {
+
+            MovingStar* cloud = &movingStars[i];
+
+            bool fromRight = false;
+            bool isInView = cloud->position.x >= baseX && cloud->position.x <= baseX + BASE_SCREEN_WIDTH && cloud->position.y >= baseY && cloud->position.y <= baseY + BASE_SCREEN_HEIGHT;
+
+            // Calculate the X position based on time and direction
+            if (fromRight) {
+                cloud->position.x -= cloud->speed * deltaTime;
+                // Check if the cloud has moved off the screen
+                if ((float)cloud->position.x + ((float)(cloud->texture.width) * (float)(cloud->scale)) <= baseX) {
+                    cloud->position.x = baseX + BASE_SCREEN_WIDTH + (cloud->texture.width * cloud->scale) + RandomDouble(RANDOM_VISUALS, 100, 500);
+                }
+            }
+            else {
+                cloud->position.x += cloud->speed * deltaTime;
+                // Check if the cloud has moved off the screen
+                if (cloud->position.x > baseX + BASE_SCREEN_WIDTH) {
+                    cloud->position.x = baseX - (cloud->texture.width * cloud->scale) - RandomDouble(RANDOM_VISUALS, 100, 500);
+                }
+            }
+
+            // Draw the cloud
+            QueueTexture(cloud->texture, cloud->position.x, cloud->position.y, WHITE);
+
+            // Debug
+            if (options->showDebug && debugToolToggles.showObjects)
+            {
+                FlushSpriteQueue();
+                DrawRectangleLinesEx((Rectangle) { cloud->position.x, cloud->position.y, cloud->texture.width* cloud->scale, cloud->texture.height* cloud->scale }, 1, RED);
+                DrawRectangle(cloud->position.x, cloud->position.y - 20, 300, 20, Fade(GRAY, 0.7));
+                DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Speed %.2f | Scale %.2f", "Stars", cloud->position.x, cloud->position.y, cloud->speed, cloud->scale), (Vector2) { cloud->position.x, cloud->position.y - 20 }, 20, 1, WHITE);
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < cloudCount; i++) {
+            MovingCloud* cloud = &movingClouds[i];
+
+            bool fromRight = cloud->fromRight;
+            bool isInView = cloud->position.x >= baseX && cloud->position.x <= baseX + BASE_SCREEN_WIDTH && cloud->position.y >= baseY && cloud->position.y <= baseY + BASE_SCREEN_HEIGHT;
+
+            // Calculate the X position based on time and direction
+            if (fromRight) {
+                cloud->position.x -= cloud->speed * deltaTime;
+                // Check if the cloud has moved off the screen
+                if ((float)cloud->position.x + ((float)(cloud->texture.width) * (float)(cloud->scale)) <= baseX) {
+                    cloud->position.x = baseX + BASE_SCREEN_WIDTH + (cloud->texture.width * cloud->scale) + RandomDouble(RANDOM_VISUALS, 100, 500);
+                    cloud->position.y = RandomDouble(RANDOM_VISUALS, baseY, 0);
+                }
+            }
+            else {
+                cloud->position.x += cloud->speed * deltaTime;
+                // Check if the cloud has moved off the screen
+                if (cloud->position.x > baseX + BASE_SCREEN_WIDTH) {
+                    cloud->position.x = baseX - (cloud->texture.width * cloud->scale) - RandomDouble(RANDOM_VISUALS, 100, 500);
+                    cloud->position.y = RandomDouble(RANDOM_VISUALS, baseY, 0);
+                }
+            }
+
+            // Draw the cloud
+            QueueTexture(cloud->texture, cloud->position.x, cloud->position.y, WHITE);
+
+            // Debug
+            if (options->showDebug && debugToolToggles.showObjects)
+            {
+                FlushSpriteQueue();
+                DrawRectangleLinesEx((Rectangle) { cloud->position.x, cloud->position.y, cloud->texture.width* cloud->scale, cloud->texture.height* cloud->scale }, 1, RED);
+                DrawRectangle(cloud->position.x, cloud->position.y - 20, 300, 20, Fade(GRAY, 0.7));
+                DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Speed %.2f | Scale %.2f", "Cloud", cloud->position.x, cloud->position.y, cloud->speed, cloud->scale), (Vector2) { cloud->position.x, cloud->position.y - 20 }, 20, 1, WHITE);
+            }
+        }
+
+    }
+   
+}
+
+double RandomCustomerTimeoutBasedOnDifficulty()
+{
+    switch (options->difficulty)
+    {
+    case FREEPLAY_EASY:
+    case EASY:
+        return RandomDouble(RANDOM_CUSTOMERS, 80, 150);
+        break;
+    case FREEPLAY_MEDIUM:
+    case MEDIUM:
+        return RandomDouble(RANDOM_CUSTOMERS, 40, 60);
+        break;
+    case FREEPLAY_HARD:
+    case HARD:
+        return RandomDouble(RANDOM_CUSTOMERS, 20, 40);
+        break;
+    default:
+        return RandomDouble(RANDOM_CUSTOMERS, 80, 150);
+        break;
+    }
+}
+
+void RandomCustomerInitialResetBasedOnDifficulty(double *values) {
+
+    switch (options->difficulty)
+	{
+        case FREEPLAY_EASY:
+        case EASY:
+        	values[0] = RandomDouble(RANDOM_CUSTOMERS, 4, 6);
+        	values[1] = RandomDouble(RANDOM_CUSTOMERS, 5, 15);
+        	values[2] = RandomDouble(RANDOM_CUSTOMERS, 10, 25);
+        	break;
+        case FREEPLAY_MEDIUM:
+        case MEDIUM:
+        	values[0] = RandomDouble(RANDOM_CUSTOMERS, 2, 6);
+        	values[1] = RandomDouble(RANDOM_CUSTOMERS, 4, 10);
+        	values[2] = RandomDouble(RANDOM_CUSTOMERS, 12, 20);
+        	break;
+        case FREEPLAY_HARD:
+        case HARD:
+        	values[0] = RandomDouble(RANDOM_CUSTOMERS, 2, 4);
+        	values[1] = RandomDouble(RANDOM_CUSTOMERS, 3, 6);
+        	values[2] = RandomDouble(RANDOM_CUSTOMERS, 6, 10);
+        	break;
+        default:
+            values[0] = RandomDouble(RANDOM_CUSTOMERS, 4, 6);
+            values[1] = RandomDouble(RANDOM_CUSTOMERS, 5, 15);
+            values[2] = RandomDouble(RANDOM_CUSTOMERS, 10, 25);
+        	break;
+    }
+
+
+}
+
+
+double RandomCustomerResetBasedOnDifficulty()
+{
+    switch (options->difficulty)
+    {
+    case FREEPLAY_EASY:
+    case EASY:
+        return RandomDouble(RANDOM_CUSTOMERS, 30, 50);
+        break;
+    case FREEPLAY_MEDIUM:
+    case MEDIUM:
+        return RandomDouble(RANDOM_CUSTOMERS, 15, 30);
+        break;
+    case FREEPLAY_HARD:
+    case HARD:
+        return RandomDouble(RANDOM_CUSTOMERS, 1, 10);
+        break;
+    default:
+        return RandomDouble(RANDOM_CUSTOMERS, 30, 50);
+        break;
+    }
+}
+
+Drink RandomGenerateOrder()
+{
+    int random = RandomInt(RANDOM_ORDERS, 0, 2);
+    Drink order = DRINK_EMPTY;
+
+    //base case, either CP or GP
+    if (RandomInt(RANDOM_ORDERS, 0, 1))
+        order = AddDrinkIngredient(order, COCOA);
+    else
+        order = AddDrinkIngredient(order, GREEN_TEA);
+
+    order = SetDrinkSlot(order, DRINK_WATER, 1);
+
+    // Very very small chance just to order tea without any creamer lol
+    if (RandomInt(RANDOM_ORDERS, 0, 100) == 0)
+        return order;
+
+    // another base case, either CM or MI
+    if (RandomInt(RANDOM_ORDERS, 0, 1))
+        order = AddDrinkIngredient(order, CONDENSED_MILK);
+    else
+        order = AddDrinkIngredient(order, MILK);
+
+    bool hasTopping = false;
+    if (random >= 1)
+    {
+        if (RandomInt(RANDOM_ORDERS, 0, 1))
+        {
+            hasTopping = true;
+            if (RandomInt(RANDOM_ORDERS, 0, 1))
+                order = AddDrinkIngredient(order, MARSHMELLOW);
+            else
+                order = AddDrinkIngredient(order, WHIPPED_CREAM);
+        }
+    }
+    if (hasTopping && random >= 2)
+    {
+        if (RandomInt(RANDOM_ORDERS, 0, 1))
+        {
+            if (RandomInt(RANDOM_ORDERS, 0, 1))
+                order = AddDrinkIngredient(order, CARAMEL);
+            else
+                order = AddDrinkIngredient(order, CHOCOLATE);
+        }
+    }
+    // Log the order
+    char name[32];
+    BuildCupCombinationName(name, order);
+    LogDebug("New order: %s", name);
+    return order;
+}
+
+
+void DrawCustomer(Customer* customer)
+{
+    Vector2 pos = customer->position;
+    int frame = customer->textureType;
+
+    if (customer == NULL) return;
+
+    if (customer->visible)
+    {
+
+        // Emotion picks the region, blinking only moves to the second frame
+        int eyesFrame = customer->eyesClosed ? 2 : 1;
+
+        switch (customer->emotion)
+        {
+        case EMOTION_HAPPY:
+            QueueAtlasFrame(customersImageData[frame].happy, eyesFrame, pos, 1.0f / 2.0f, WHITE);
+            break;
+        case EMOTION_FRUSTRATED:
+            QueueAtlasFrame(customersImageData[frame].frustrated, eyesFrame, pos, 1.0f / 2.0f, WHITE);
+            break;
+        case EMOTION_ANGRY:
+            QueueAtlasFrame(customersImageData[frame].angry, eyesFrame, pos, 1.0f / 2.0f, WHITE);
+            break;
+        default:
+            break;
+        }
+
+    }
+
+    if (customer->visible && !customer->isDummy)
+    {
+        QueueAtlasFrame(bubbles, 1, (Vector2) { pos.x + 350, pos.y + 100 }, 1.0f / 2.0f, WHITE);
+
+        // One icon per filled slot, indexed by the slot value
+        Drink order = customer->order;
+        const Ingredient* powders[3] = { NULL, &ingredients[INGREDIENT_GREEN_CHON], &ingredients[INGREDIENT_COCOA_CHON] };
+        const Ingredient* creamers[3] = { NULL, &ingredients[INGREDIENT_CONDENSED_MILK], &ingredients[INGREDIENT_MILK] };
+        const Ingredient* toppings[3] = { NULL, &ingredients[INGREDIENT_MARSHMELLOW], &ingredients[INGREDIENT_WHIPPED_CREAM] };
+        const Ingredient* sauces[3] = { NULL, &ingredients[INGREDIENT_CARAMEL], &ingredients[INGREDIENT_CHOCOLATE] };
+
+        const Ingredient* powder = powders[GetDrinkSlot(order, DRINK_POWDER)];
+        const Ingredient* creamer = creamers[GetDrinkSlot(order, DRINK_CREAMER)];
+        const Ingredient* topping = toppings[GetDrinkSlot(order, DRINK_TOPPING)];
+        const Ingredient* sauce = sauces[GetDrinkSlot(order, DRINK_SAUCE)];
+
+        if (powder != NULL && HasDrinkSlot(order, DRINK_WATER))
+            QueueAtlasFrame(powder->region, 1, (Vector2) { pos.x + 375, pos.y + 100 }, 1.0f / 2.0f, WHITE);
+        if (creamer != NULL)
+            QueueTextureRec(creamer->texture, creamer->frameRectangle, (Vector2) { pos.x + 425, pos.y + 100 }, RAYWHITE);
+        if (topping != NULL)
+            QueueTextureRec(topping->texture, topping->frameRectangle, (Vector2) { pos.x + 375, pos.y + 150 }, RAYWHITE);
+        if (sauce != NULL)
+            QueueTextureRec(sauce->texture, sauce->frameRectangle, (Vector2) { pos.x + 425, pos.y + 150 }, RAYWHITE);
+    }
+
+    if (options->showDebug && debugToolToggles.showObjects)
+    {
+        FlushSpriteQueue();
+        Vector2 customerSize = GetAtlasFrameSize(customersImageData[frame].happy);
+        DrawRectangleLinesEx((Rectangle) { pos.x, pos.y, customerSize.x / 2, customerSize.y / 2 }, 1, RED);
+        DrawRectangle(pos.x, pos.y - 20, 500, 60, Fade(GRAY, 0.7));
+        DrawTextEx(meowFont, TextFormat("%s | Blink %s (%.2f) %.2f", StringFromCustomerEmotionEnum(customer->emotion), customer->eyesClosed ? "[Yes]" : "[No]", customer->blinkDuration, customer->normalDuration), (Vector2) { pos.x, pos.y - 20 }, 20, 1, WHITE);
+        if (!customer->isDummy)
+            DrawTextEx(meowFont, TextFormat("Timeout %.2f/%.2f", (float)(gameEvents.now - customer->seatedTime), (float)customer->orderEnd), (Vector2) { pos.x, pos.y }, 20, 1, WHITE);
+        char orderName[32];
+        BuildCupCombinationName(orderName, customer->order);
+        DrawTextEx(meowFont, TextFormat("Visible %s | Order %s", customer->visible ? "[Yes]" : "[No]", orderName), (Vector2) { pos.x, pos.y + 20 }, 20, 1, WHITE);
+    }
+
+}
+
+void DrawCustomerInMenu(double deltaTime) {
+    // Update customer emotions according to difficulty
+    switch (options->difficulty)
+    {
+        case FREEPLAY_EASY:
+        case EASY:
+            menuCustomer1.emotion = EMOTION_HAPPY;
+            menuCustomer2.emotion = EMOTION_HAPPY;
+            break;
+        case FREEPLAY_MEDIUM:
+        case MEDIUM:
+            menuCustomer1.emotion = EMOTION_FRUSTRATED;
+            menuCustomer2.emotion = EMOTION_FRUSTRATED;
+            break;
+        case FREEPLAY_HARD:
+        case HARD:
+            menuCustomer1.emotion = EMOTION_ANGRY;
+            menuCustomer2.emotion = EMOTION_ANGRY;
+            break;
+            break;
+        default:
+            menuCustomer1.emotion = EMOTION_HAPPY;
+            menuCustomer2.emotion = EMOTION_HAPPY;
+            break;
+    }
+    DrawCustomer(&menuCustomer1);
+    DrawCustomer(&menuCustomer2);
+}
+
+void DrawOuterWorld()
+{
+    // Draw area outside the view
+    DrawRectangle(baseX, baseY - 2000, BASE_SCREEN_WIDTH, 2000, BLACK);
+    DrawRectangle(baseX, baseY + BASE_SCREEN_HEIGHT, BASE_SCREEN_WIDTH, 2000, BLACK);
+    DrawRectangle(baseX - 2000, baseY, 2000, BASE_SCREEN_HEIGHT, BLACK);
+    DrawRectangle(baseX + BASE_SCREEN_WIDTH, baseY, 2000, BASE_SCREEN_HEIGHT, BLACK);
+}
+
+// The browser loop is paced by requestAnimationFrame. raylib's limiter would busy-wait inside the callback.
+void ApplyTargetFps(int fps)
+{
+#if USE_BROWSER_MAIN_LOOP
+    (void)fps;
+#else
+    SetTargetFPS(fps);
+#endif
+}
+
+void SetRuntimeResolution(Camera2D *camera, int screenWidth, int screenHeight)
+{
+    SetWindowSize(screenWidth, screenHeight);
+    float currentAspectRatio = (float)screenWidth / (float)screenHeight;
+    float scale = (currentAspectRatio > targetAspectRatio) ? (float)screenHeight / BASE_SCREEN_HEIGHT : (float)screenWidth / BASE_SCREEN_WIDTH;
+
+    camera->zoom = scale;
+    camera->offset.x = screenWidth / 2.0f;
+    camera->offset.y = screenHeight / 2.0f;
+
+    options->resolution.x = screenWidth;
+    options->resolution.y = screenHeight;
+}
+
+// Layer cache, a render target holding layers that rarely change so they are not redrawn every frame
+typedef struct LayerCache {
+    RenderTexture2D target;
+    float zoom;
+    bool dirty;
+} LayerCache;
+
+// Matches the render target to the current window zoom, returns true when the layer has to be redrawn
+bool LayerCacheNeedsRedraw(LayerCache* layer, Camera2D* camera)
+{
+    if (layer->target.id == 0 || layer->zoom != camera->zoom)
+    {
+        if (layer->target.id != 0)
+            UnloadTrackedRenderTexture(layer->target);
+
+        // Render at the size the layer ends up on screen, so compositing is a 1:1 copy
+        int width = (int)ceilf(BASE_SCREEN_WIDTH * camera->zoom);
+        int height = (int)ceilf(BASE_SCREEN_HEIGHT * camera->zoom);
+
+        layer->target = TrackRenderTexture(LoadRenderTexture(width, height));
+        SetTextureFilter(layer->target.texture, TEXTURE_FILTER_BILINEAR);
+        layer->zoom = camera->zoom;
+        layer->dirty = true;
+
+        LogDebug("Layer cache resized to %dx%d", width, height);
+    }
+
+    return layer->dirty;
+}
+
+// Must be called outside BeginDrawing/BeginMode2D
+void BeginLayerCache(LayerCache* layer)
+{
+    Camera2D layerCamera = { 0 };
+    layerCamera.target = (Vector2){ baseX, baseY };
+    layerCamera.zoom = layer->zoom;
+
+    BeginTextureMode(layer->target);
+    ClearBackground(BLANK);
+    BeginMode2D(layerCamera);
+    gpuCounters.offscreen = true;
+
+    // Accumulate alpha instead of squaring it, the result is premultiplied and composited as such
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+}
+
+void EndLayerCache(LayerCache* layer)
+{
+    FlushGpuBatch();
+    gpuCounters.offscreen = false;
+    EndBlendMode();
+    EndMode2D();
+    EndTextureMode();
+
+    layer->dirty = false;
+}
+
+void DrawLayerCache(LayerCache* layer)
+{
+    Rectangle source = { 0, 0, (float)layer->target.texture.width, -(float)layer->target.texture.height };
+    Rectangle dest = { baseX, baseY, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT };
+
+    FlushGpuBatch();
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    DrawTexturePro(layer->target.texture, source, dest, (Vector2) { 0, 0 }, 0.0f, WHITE);
+    FlushGpuBatch();
+    EndBlendMode();
+}
+
+void UnloadLayerCache(LayerCache* layer)
+{
+    if (layer->target.id != 0)
+        UnloadTrackedRenderTexture(layer->target);
+
+    *layer = (LayerCache){ 0 };
+}
+
+// Input
+// Every frame starts by filling frameInput, from raylib or from a replay, and the scenes read the mouse and the
+// keys that change the game from there only. A recorded session then runs through exactly the same code when
+// it is played back. Debug keys and Alt+Enter stay on raylib, they only change what is shown.
+typedef enum InputFlags {
+    INPUT_MOUSE_LEFT_DOWN = 1,
+    INPUT_MOUSE_LEFT_PRESSED = 2,
+    INPUT_ESCAPE_PRESSED = 4
+} InputFlags;
+
+typedef struct FrameInput {
+    double deltaTime;
+    Vector2 mouse;      // World space, so a replay does not depend on the window size
+    uint32_t flags;
+} FrameInput;
+
+FrameInput frameInput;
+
+void CaptureFrameInput(Camera2D* camera, double deltaTime)
+{
+    frameInput.deltaTime = deltaTime;
+    frameInput.mouse = GetScreenToWorld2D(GetMousePosition(), *camera);
+    frameInput.flags = 0;
+
+    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON))
+        frameInput.flags |= INPUT_MOUSE_LEFT_DOWN;
+    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        frameInput.flags |= INPUT_MOUSE_LEFT_PRESSED;
+    if (IsKeyPressed(KEY_ESCAPE))
+        frameInput.flags |= INPUT_ESCAPE_PRESSED;
+}
+
+static inline bool HasFrameInput(InputFlags flag)
+{
+    return (frameInput.flags & flag) != 0;
+}
+
+bool IsMousePositionInGameWindow(Camera2D * camera)
+{
+    Vector2 mouseWorldPos = frameInput.mouse;
+    return mouseWorldPos.x >= baseX && mouseWorldPos.x <= baseX + BASE_SCREEN_WIDTH && mouseWorldPos.y >= baseY && mouseWorldPos.y <= baseY + BASE_SCREEN_HEIGHT;
+
+}
+
+void DrawDebugLogs(Camera2D* camera)
+{
+    DrawRectangle(baseX, baseY + BASE_SCREEN_HEIGHT - 20 - (DEBUG_MAX_LOGS_HISTORY * 20), BASE_SCREEN_WIDTH, DEBUG_MAX_LOGS_HISTORY * 20 + 20, Fade(GRAY, 0.7));
+
+    // Newest first, drawn from the bottom up
+    static LogRecord records[DEBUG_MAX_LOGS_HISTORY];
+    int count = ReadRecentLogs(logRing, records, DEBUG_MAX_LOGS_HISTORY);
+
+    for (int i = 0; i < count; i++)
+        DrawTextEx(meowFont, records[i].text, (Vector2) { baseX + 10, baseY + BASE_SCREEN_HEIGHT - 20 - (i * 20) }, 16, 1, GetTextColorFromLogType(records[i].level));
+}
+
+void UpdateDebugFpsHistory() {
+    DebugFpsHistory[DebugFpsHistoryIndex] = GetFPS();
+    DebugFpsHistoryIndex = (DebugFpsHistoryIndex + 1) % DEBUG_MAX_FPS_HISTORY;
+}
+
+// Called at the start of every frame, overlay or not, so the statistics are complete as soon as it opens
+void UpdateDebugFrameTimeHistory(double frameStartTime) {
+    if (DebugLastFrameStart > 0.0)
+    {
+        DebugFrameTimeHistory[DebugFrameTimeHistoryIndex] = (int)((frameStartTime - DebugLastFrameStart) * 1000000.0);
+        DebugFrameTimeHistoryIndex = (DebugFrameTimeHistoryIndex + 1) % DEBUG_MAX_FPS_HISTORY;
+        if (DebugFrameTimeHistoryCount < DEBUG_MAX_FPS_HISTORY)
+            DebugFrameTimeHistoryCount++;
+    }
+    DebugLastFrameStart = frameStartTime;
+}
+
+int CompareDoubles(const void* a, const void* b)
+{
+    double left = *(const double*)a;
+    double right = *(const double*)b;
+    return (left > right) - (left < right);
+}
+
+// Nearest rank on sorted values
+double GetPercentile(const double* sorted, int count, double percentile)
+{
+    int rank = (int)ceil(percentile / 100.0 * count);
+    return sorted[rank < 1 ? 0 : rank - 1];
+}
+
+typedef struct FrameTimeStats {
+    int count;
+    int overBudget;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+} FrameTimeStats;
+
+// Over the frame time history, in milliseconds
+FrameTimeStats GetFrameTimeStats(double budget)
+{
+    static double sorted[DEBUG_MAX_FPS_HISTORY];
+    FrameTimeStats stats = { 0 };
+
+    for (int i = 0; i < DebugFrameTimeHistoryCount; i++)
+    {
+        sorted[i] = DebugFrameTimeHistory[i] / 1000.0;
+        if (budget > 0 && sorted[i] > budget * DEBUG_FRAME_BUDGET_SLACK)
+            stats.overBudget++;
+    }
+
+    stats.count = DebugFrameTimeHistoryCount;
+    if (stats.count == 0)
+        return stats;
+
+    qsort(sorted, stats.count, sizeof(double), CompareDoubles);
+    stats.p50 = GetPercentile(sorted, stats.count, 50);
+    stats.p95 = GetPercentile(sorted, stats.count, 95);
+    stats.p99 = GetPercentile(sorted, stats.count, 99);
+    stats.max = sorted[stats.count - 1];
+    return stats;
+}
+
+// The whole history goes out as one batch of lines, a DrawLine call per segment cost more than the rest of the overlay
+void DrawHistoryStrip(const int* history, int historyIndex, int graphX, int graphY, int graphHeight, float scale, float reference, bool higherIsBetter)
+{
+    rlCheckRenderBatchLimit(2 * DEBUG_MAX_FPS_HISTORY);
+    rlBegin(RL_LINES);
+
+    for (int i = 1; i < DEBUG_MAX_FPS_HISTORY; i++)
+    {
+        int previous = history[(historyIndex + i - 1) % DEBUG_MAX_FPS_HISTORY];
+        int value = history[(historyIndex + i) % DEBUG_MAX_FPS_HISTORY];
+
+        // Green on target, yellow within reach, red far off
+        float ratio = reference > 0 ? value / reference : 1.0f;
+        Color color;
+        if (higherIsBetter)
+            color = ratio >= 0.9f ? GREEN : ratio >= 0.7f ? YELLOW : RED;
+        else
+            color = ratio <= 1.0f ? GREEN : ratio <= 1.5f ? YELLOW : RED;
+
+        rlColor4ub(color.r, color.g, color.b, color.a);
+        rlVertex2f((float)(graphX + i - 1), graphY + graphHeight - previous * scale);
+        rlVertex2f((float)(graphX + i), graphY + graphHeight - value * scale);
+    }
+
+    rlEnd();
+}
+
+void DrawFpsGraph(Camera2D* camera)
+{
+    int graphWidth = DEBUG_MAX_FPS_HISTORY;
+    int graphHeight = 200;
+    int graphX = baseX + BASE_SCREEN_WIDTH - 15 - graphWidth;
+    int graphY = baseY + 25;
+
+    // Calculate the maximum value in the FPS history
+    float maxFpsValue = 0.0f;
+    for (int i = 0; i < DEBUG_MAX_FPS_HISTORY; i++) {
+        if (DebugFpsHistory[i] > maxFpsValue) {
+            maxFpsValue = (float)DebugFpsHistory[i];
+        }
+    }
+
+    // Adjust the scale based on the maximum value or target FPS
+    float fpsScale;
+    if ((float)options->targetFps > maxFpsValue) {
+        fpsScale = (float)graphHeight / (float)options->targetFps;
+    }
+    else {
+        fpsScale = (float)graphHeight / maxFpsValue;
+    }
+
+    DrawRectangle(graphX, graphY, graphWidth, graphHeight, Fade(GRAY, 0.7));
+
+    // Colored by the ratio to the target FPS
+    DrawHistoryStrip(DebugFpsHistory, DebugFpsHistoryIndex, graphX, graphY, graphHeight, fpsScale, (float)options->targetFps, true);
+
+    DrawTextEx(meowFont, "FPS", (Vector2) { baseX + BASE_SCREEN_WIDTH - 50, baseY + 5 }, 20, 2, GRAY);
+    DrawTextEx(meowFont, TextFormat("%.2f", maxFpsValue > options->targetFps ? maxFpsValue : options->targetFps), (Vector2) { graphX + 10, graphY + 10 }, 15, 2, WHITE);
+    DrawTextEx(meowFont, "0", (Vector2) { graphX + 10, graphY + graphHeight - 30 }, 15, 2, WHITE);
+}
+
+
+void DrawFrameTime(Camera2D* camera) {
+    int graphWidth = DEBUG_MAX_FPS_HISTORY;
+    int graphHeight = 200;
+    int graphX = baseX + BASE_SCREEN_WIDTH - 15 - graphWidth;
+    int graphY = baseY + 255;
+
+    // History is in microseconds, the labels in milliseconds
+    float expectedFrameTime = options->targetFps > 0 ? 1000000.0f / options->targetFps : 0.0f;
+
+    float maxFrameTime = 0.0f;
+    for (int i = 0; i < DEBUG_MAX_FPS_HISTORY; i++) {
+        if (DebugFrameTimeHistory[i] > maxFrameTime) {
+            maxFrameTime = (float)DebugFrameTimeHistory[i];
+        }
+    }
+
+    // Never scaled below twice the budget, so a steady frame rate does not blow jitter up to full height
+    float topFrameTime = fmaxf(maxFrameTime, expectedFrameTime * 2.0f);
+    float frameTimeScale = (topFrameTime > 0) ? (float)graphHeight / topFrameTime : 1.0f;
+
+    DrawRectangle(graphX, graphY, graphWidth, graphHeight, Fade(GRAY, 0.7));
+
+    if (expectedFrameTime > 0)
+    {
+        int budgetY = graphY + graphHeight - (int)(expectedFrameTime * frameTimeScale);
+        DrawLine(graphX, budgetY, graphX + graphWidth, budgetY, Fade(YELLOW, 0.5f));
+    }
+
+    // Colored by the ratio to the target frame time
+    DrawHistoryStrip(DebugFrameTimeHistory, DebugFrameTimeHistoryIndex, graphX, graphY, graphHeight, frameTimeScale, expectedFrameTime, false);
+
+    DrawTextEx(meowFont, "Frame Time (ms)", (Vector2) { baseX - 135 + BASE_SCREEN_WIDTH - 50, graphY - 25 }, 20, 2, GRAY);
+    DrawTextEx(meowFont, TextFormat("%.2f", topFrameTime / 1000.0f), (Vector2) { graphX + 10, graphY + 10 }, 15, 2, WHITE);
+    DrawTextEx(meowFont, "0", (Vector2) { graphX + 10, graphY + graphHeight - 30 }, 15, 2, WHITE);
+}
+
+
+// --trace <file> writes every frame's zones as Chrome trace events, MEOW_TRACE=<file> when no option is given
+void OpenProfilerTrace(int argc, char** argv)
+{
+    const char* path = getenv("MEOW_TRACE");
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--trace") != 0)
+            continue;
+
+        if (i + 1 < argc)
+            path = argv[i + 1];
+        else
+            Log(LOG_WARNING, "--trace needs a file name");
+        break;
+    }
+
+    if (path == NULL || path[0] == '\0')
+        return;
+
+    profiler.trace = fopen(path, "w");
+    if (profiler.trace == NULL)
+    {
+        Log(LOG_WARNING, "Cannot write trace %s", path);
+        return;
+    }
+
+    fprintf(profiler.trace, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    profiler.traceEvents = 0;
+    profiler.traceOrigin = GetTime();
+    Log(LOG_INFO, "Writing trace to %s", path);
+}
+
+void CloseProfilerTrace(void)
+{
+    if (profiler.trace == NULL)
+        return;
+
+    fprintf(profiler.trace, "\n]}\n");
+    fclose(profiler.trace);
+    profiler.trace = NULL;
+    Log(LOG_INFO, "Trace closed, %d events", profiler.traceEvents);
+}
+
+void WriteTraceFrame(const FrameProfile* frame)
+{
+    for (int i = 0; i < frame->zoneCount; i++)
+    {
+        const ProfileZone* zone = &frame->zones[i];
+        fprintf(profiler.trace, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}",
+            profiler.traceEvents > 0 ? ",\n" : "", zone->name, (zone->start - profiler.traceOrigin) * 1000000.0, (zone->end - zone->start) * 1000000.0);
+        profiler.traceEvents++;
+    }
+}
+
+// The whole frame is the outermost zone, every other zone nests inside it
+void BeginProfileFrame(bool showProfiler)
+{
+    profiler.recording = showProfiler || profiler.trace != NULL;
+    if (!profiler.recording)
+        return;
+
+    FrameProfile* frame = &profiler.frames[profiler.current];
+    frame->zoneCount = 0;
+    frame->start = GetTime();
+    profiler.depth = 0;
+
+    BeginProfileZone("Frame");
+}
+
+void EndProfileFrame(void)
+{
+    if (!profiler.recording)
+        return;
+
+    // Zones left open by an early return end with the frame
+    FrameProfile* frame = &profiler.frames[profiler.current];
+    while (profiler.depth > 0)
+        EndProfileZone();
+    frame->end = GetTime();
+
+    if (profiler.trace != NULL)
+        WriteTraceFrame(frame);
+
+    if (frame->end - frame->start >= profiler.slowest.end - profiler.slowest.start || frame->end - profiler.slowest.end > PROFILER_HOLD_TIME)
+        profiler.slowest = *frame;
+
+    profiler.current = 1 - profiler.current;
+}
+
+void DrawProfileFrame(const FrameProfile* frame, const char* title, float x, float y, float width, double scale)
+{
+    const float rowHeight = 18;
+    const Color colors[] = { (Color){ 196, 92, 72, 255 }, (Color){ 214, 150, 64, 255 }, (Color){ 112, 160, 84, 255 }, (Color){ 72, 136, 176, 255 }, (Color){ 148, 104, 176, 255 } };
+    const int colorCount = (int)(sizeof(colors) / sizeof(colors[0]));
+
+    DrawTextEx(meowFont, TextFormat("%s | %.2f ms", title, (frame->end - frame->start) * 1000.0), (Vector2) { x, y }, 16, 1, WHITE);
+    y += 20;
+
+    for (int i = 0; i < frame->zoneCount; i++)
+    {
+        const ProfileZone* zone = &frame->zones[i];
+        float left = x + (float)((zone->start - frame->start) * scale);
+        float right = x + (float)((zone->end - frame->start) * scale);
+        if (left > x + width)
+            continue;
+        if (right > x + width)
+            right = x + width;
+
+        // Same name, same color in every frame
+        unsigned int hash = 0;
+        for (const char* c = zone->name; *c != '\0'; c++)
+            hash = hash * 31 + (unsigned char)*c;
+        Color color = colors[hash % colorCount];
+        Rectangle bar = { left, y + zone->depth * rowHeight, fmaxf(right - left, 1.0f), rowHeight - 2 };
+        DrawRectangleRec(bar, color);
+
+        const char* label = TextFormat("%s %.2f", zone->name, (zone->end - zone->start) * 1000.0);
+        if (MeasureTextEx(meowFont, label, 14, 1).x < bar.width - 4)
+            DrawTextEx(meowFont, label, (Vector2) { bar.x + 2, bar.y + 1 }, 14, 1, BLACK);
+    }
+}
+
+// Last frame on top, slowest of the last PROFILER_HOLD_TIME seconds below, both on the same scale
+void DrawProfiler(Camera2D* camera)
+{
+    const float width = 1300;
+    const float x = baseX + 15;
+    const float y = baseY + 470;
+    const float sectionHeight = 20 + 8 * 18;
+
+    // 33 ms across the view, wider when the slowest frame would not fit
+    double span = fmax(1.0 / 30.0, profiler.slowest.end - profiler.slowest.start);
+    double scale = width / span;
+
+    DrawRectangle(x - 5, y - 5, width + 10, sectionHeight * 2 + 30, Fade(GRAY, 0.7));
+
+    // Frame budget at 60 Hz
+    float budgetX = x + (float)(scale / 60.0);
+    DrawLine(budgetX, y, budgetX, y + sectionHeight * 2 + 20, YELLOW);
+
+    DrawProfileFrame(&profiler.frames[1 - profiler.current], "Last frame", x, y, width, scale);
+    DrawProfileFrame(&profiler.slowest, "Slowest frame", x, y + sectionHeight + 10, width, scale);
+
+    if (profiler.droppedZones > 0)
+        DrawTextEx(meowFont, TextFormat("%d zones dropped, raise PROFILER_MAX_ZONES", profiler.droppedZones), (Vector2) { x + width - 300, y }, 16, 1, ORANGE);
+}
+
+void DrawDebugStats(Camera2D* camera)
+{
+    DrawRectangle(baseX, baseY, 1100, 150, Fade(GRAY, 0.7));
+
+    Color color = GREEN;
+    int fps = GetFPS();
+
+    if (fps < options->targetFps * 0.7f) {
+		color = RED;
+	}
+	else if (fps < options->targetFps * 0.9f) {
+		color = YELLOW;
+	}
+
+    Vector2 mousePosition = GetMousePosition();
+    Vector2 mouseWorldPos = GetScreenToWorld2D(mousePosition, *camera);
+
+    DrawTextEx(meowFont, TextFormat("%d FPS | Target FPS %d | Window (%dx%d) | Render (%dx%d) | Fullscreen ", fps, options->targetFps, options->resolution.x, options->resolution.y, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, options->fullscreen ? "[Yes]" : "[No]"), (Vector2) { baseX + 10, baseY + 5 }, 20, 2, color);
+    DrawTextEx(meowFont, TextFormat("Cursor %.2f,%.2f (%dx%d) | World %.2f,%.2f (%dx%d) | R Base World %.2f,%.2f", mousePosition.x, mousePosition.y, options->resolution.x, options->resolution.y, mouseWorldPos.x, mouseWorldPos.y, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, mouseWorldPos.x - baseX, mouseWorldPos.y - baseY), (Vector2) { baseX + 10, baseY + 25 }, 20, 2, WHITE);
+    DrawTextEx(meowFont, TextFormat("Zoom %.2f | In View %s | CPU %.2f ms (avg %.2f ms) | Loop %s", camera->zoom, IsMousePositionInGameWindow(camera) ? "[Yes]" : "[No]", frameCpuTime * 1000.0, frameCpuTimeAverage * 1000.0, MAIN_LOOP_NAME), (Vector2) { baseX + 10, baseY + 45 }, 20, 2, WHITE);
+    DrawTextEx(meowFont, TextFormat("Sprites %d | Texture binds %d submitted, %d batched | Queue flushes %d", spriteQueueStats.sprites, spriteQueueStats.bindsUnsorted, spriteQueueStats.bindsSorted, spriteQueueStats.flushes), (Vector2) { baseX + 10, baseY + 65 }, 20, 2, WHITE);
+
+    double budget = options->targetFps > 0 ? 1000.0 / options->targetFps : 0.0;
+    FrameTimeStats frameStats = GetFrameTimeStats(budget);
+    DrawTextEx(meowFont, TextFormat("Frame p50 %.2f | p95 %.2f | p99 %.2f | max %.2f ms | Over budget %d of %d", frameStats.p50, frameStats.p95, frameStats.p99, frameStats.max, frameStats.overBudget, frameStats.count), (Vector2) { baseX + 10, baseY + 85 }, 20, 2, frameStats.overBudget > 0 ? YELLOW : WHITE);
+
+    // Last frame's scene, the overlay itself is not counted
+    const GpuFrameStats* gpu = &gpuCounters.last;
+    double screenPixels = BASE_SCREEN_WIDTH * BASE_SCREEN_HEIGHT * camera->zoom * camera->zoom;
+    DrawTextEx(meowFont, TextFormat("GPU draw calls %d | Batches %d | Texture binds %d | Vertices %d | Pixels %.2f M (%.1fx the screen)", gpu->drawCalls, gpu->batches, gpu->textureBinds, gpu->vertices, gpu->pixels / 1000000.0, screenPixels > 0 ? gpu->pixels / screenPixels : 0.0), (Vector2) { baseX + 10, baseY + 105 }, 20, 2, WHITE);
+
+    // Yellow when the game allocated during a settled round
+    const AllocationTracker* allocations = &allocationTracker;
+    int liveTextures = allocations->live[ALLOCATION_TEXTURE] + allocations->live[ALLOCATION_RENDER_TEXTURE];
+    int liveSounds = allocations->live[ALLOCATION_SOUND] + allocations->live[ALLOCATION_MUSIC];
+    DrawTextEx(meowFont, TextFormat("Allocations %d (peak %d) | Textures %d, sounds %d, %.1f MB | Heap %.1f MB (peak %.1f), update %+lld B", allocations->lastFrameAllocations, allocations->peakFrameAllocations, liveTextures, liveSounds, allocations->liveBytes / (1024.0 * 1024.0), allocations->heapBytes / (1024.0 * 1024.0), allocations->peakHeapBytes / (1024.0 * 1024.0), allocations->lastHeapGrowth), (Vector2) { baseX + 10, baseY + 125 }, 20, 2, allocations->lastFrameAllocations > 0 && IsAllocationSteadyState() ? YELLOW : WHITE);
+}
+
+// Every texture and sound held by the registry, then the atlases
+void DrawDebugAssets(Camera2D* camera)
+{
+    AssetUsage usage = GetAssetUsage();
+    int lines = 3;
+    for (int i = 0; i < assetRegistry.entryCount; i++)
+        lines += assetRegistry.entries[i].refCount > 0;
+
+    float x = baseX + BASE_SCREEN_WIDTH - 15 - 560;
+    float y = baseY + 100;
+    DrawRectangle(x, y, 560, lines * 16 + 10, Fade(GRAY, 0.7));
+    y += 5;
+
+    DrawTextEx(meowFont, TextFormat("Textures %d (%.1f MB) | Sounds %d (%.1f MB) | Music %d", usage.textures, usage.textureBytes / (1024.0 * 1024.0), usage.sounds, usage.soundBytes / (1024.0 * 1024.0), usage.music), (Vector2) { x + 10, y }, 16, 1, WHITE);
+    y += 16;
+    DrawTextEx(meowFont, TextFormat("Loads %d | Unloads %d", assetRegistry.loadCount, assetRegistry.unloadCount), (Vector2) { x + 10, y }, 16, 1, WHITE);
+    y += 16;
+
+    for (int i = 0; i < assetRegistry.entryCount; i++)
+    {
+        RegistryEntry* entry = &assetRegistry.entries[i];
+        if (entry->refCount == 0)
+            continue;
+
+        size_t bytes = 0;
+        if (entry->use.kind == ASSET_TEXTURE)
+            bytes = GetTextureBytes(*(Texture2D*)entry->use.target);
+        else if (entry->use.kind == ASSET_SOUND)
+            bytes = GetSoundBytes(*(Sound*)entry->use.target);
+
+        const char* name = entry->use.path + strlen(ASSETS_PATH);
+        DrawTextEx(meowFont, TextFormat("%s x%d | %s", name, entry->refCount, entry->use.kind == ASSET_MUSIC ? "streamed" : TextFormat("%.0f KB", bytes / 1024.0)), (Vector2) { x + 10, y }, 16, 1, LIGHTGRAY);
+        y += 16;
+    }
+
+    int atlasTextures = 0;
+    size_t atlasBytes = GetAtlasBytes(&spriteAtlas, &atlasTextures) + GetAtlasBytes(&customerAtlas, &atlasTextures);
+    DrawTextEx(meowFont, TextFormat("Atlases: %d textures | %.1f MB", atlasTextures, atlasBytes / (1024.0 * 1024.0)), (Vector2) { x + 10, y }, 16, 1, LIGHTGRAY);
+}
+
+void DrawDebugOverlay(Camera2D *camera)
+{
+    if (options->showDebug)
+    {
+        // F1 - Toggle debug logs
+        if (IsKeyPressed(KEY_F1))
+        {
+            debugToolToggles.showDebugLogs = !debugToolToggles.showDebugLogs;
+        }
+        // F2 - Toggle debug stats
+        else if (IsKeyPressed(KEY_F2))
+        {
+            debugToolToggles.showStats = !debugToolToggles.showStats;
+        }
+        // F3 - Toggle debug graph
+        else if (IsKeyPressed(KEY_F3))
+        {
+            debugToolToggles.showGraph = !debugToolToggles.showGraph;
+        }
+        //  F4 - Toggle debug objects
+        else if (IsKeyPressed(KEY_F4))
+        {
+            debugToolToggles.showObjects = !debugToolToggles.showObjects;
+        }
+        // F5 - Toggle loaded assets
+        else if (IsKeyPressed(KEY_F5))
+        {
+            debugToolToggles.showAssets = !debugToolToggles.showAssets;
+        }
+        // F6 - Toggle profiler flame view
+        else if (IsKeyPressed(KEY_F6))
+        {
+            debugToolToggles.showProfiler = !debugToolToggles.showProfiler;
+        }
+        // F7 - Toggle overdraw heatmap
+        else if (IsKeyPressed(KEY_F7))
+        {
+            debugToolToggles.showOverdraw = !debugToolToggles.showOverdraw;
+        }
+    }
+
+    UpdateDebugFpsHistory();
+
+    DrawRectangle(baseX + BASE_SCREEN_WIDTH - 15 - 300, baseY + BASE_SCREEN_HEIGHT - 15 - 170, 300, 200, Fade(GRAY, 0.7));
+    DrawTextEx(meowFont, "Debug Tools", (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 160 }, 20, 2, WHITE);
+    DrawTextEx(meowFont, TextFormat("Logs | %s | F1", debugToolToggles.showDebugLogs ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 140 }, 20, 2, debugToolToggles.showDebugLogs ? GREEN : WHITE);
+    DrawTextEx(meowFont, TextFormat("Stats | %s | F2", debugToolToggles.showStats ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 120 }, 20, 2, debugToolToggles.showStats ? GREEN : WHITE);
+    DrawTextEx(meowFont, TextFormat("Graph | %s | F3", debugToolToggles.showGraph ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 100 }, 20, 2, debugToolToggles.showGraph ? GREEN : WHITE);
+    DrawTextEx(meowFont, TextFormat("Objects | %s | F4", debugToolToggles.showObjects ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 80 }, 20, 2, debugToolToggles.showObjects ? GREEN : WHITE);
+    DrawTextEx(meowFont, TextFormat("Assets | %s | F5", debugToolToggles.showAssets ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 60 }, 20, 2, debugToolToggles.showAssets ? GREEN : WHITE);
+    DrawTextEx(meowFont, TextFormat("Profiler | %s | F6", debugToolToggles.showProfiler ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 40 }, 20, 2, debugToolToggles.showProfiler ? GREEN : WHITE);
+    DrawTextEx(meowFont, TextFormat("Overdraw | %s | F7", debugToolToggles.showOverdraw ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 20 }, 20, 2, debugToolToggles.showOverdraw ? GREEN : WHITE);
+    
+    if (debugToolToggles.showDebugLogs)
+        DrawDebugLogs(camera);
+    if(debugToolToggles.showStats)
+        DrawDebugStats(camera);
+    if (debugToolToggles.showGraph)
+    {
+        DrawFpsGraph(camera);
+        DrawFrameTime(camera);
+    }
+    if (debugToolToggles.showAssets)
+        DrawDebugAssets(camera);
+    if (debugToolToggles.showProfiler)
+        DrawProfiler(camera);
+}
+
+// void create_order(Order *order, char *first, char *second, char *third, char *fourth) {
+// 	order->first = first;
+// 	order->second = second;
+// 	order->third = third;
+// 	order->fourth = fourth;
+// }
+
+// void distribute_points(Order* order, char* first, char* second, char* third, char* fourth)
+// {
+//     if (first)
+//     {
+//         global_score += 50;
+//     }
+//     if (second)
+//     {
+//         global_score += 50;
+//     }
+//     if (third)
+//     {
+//         global_score += 50;
+//     }
+//     if (fourth)
+//     {
+//         global_score += 50;
+//     }
+// }
+
+bool validiator(Customer *customer, Drink order)
+{
+    LogDebug("Validating order: %03x against %03x", order, customer->order);
+	if (customer->order == order)
+	{
+        return true;
+	}
+	else
+	{
+        return false;
+	}
+}
+
+//create customer image at either position 1 2 or 3
+void render_customers(CustomerPool *customers)
+{
+    if(customers != NULL)  // Check the customers pointer instead of address
+    {
+        for (int i = 0; i < customers->activeCount; i++)
+            DrawCustomer(&customers->entries[customers->active[i]]);
+    }
+}
+
+//Yandere dev inspired programming.
+
+int RandomCustomerTexture();
+
+// Spreads the slots along the counter from the first position, initial arrivals follow the difficulty.
+// Pending events may still point into the old pool, so the scheduler is cleared as well.
+void InitCustomerPool(CustomerPool* pool, int slotCount, Vector2 firstPosition, float spacing, double arrivalInterval)
+{
+    memset(pool, 0, sizeof(CustomerPool));
+    ClearScheduler(&gameEvents);
+
+    for (int i = 0; i < CUSTOMER_POOL_CAPACITY; i++)
+        pool->nextFree[i] = i + 1 < CUSTOMER_POOL_CAPACITY ? i + 1 : -1;
+    pool->firstFree = 0;
+
+    if (slotCount > CUSTOMER_POOL_CAPACITY)
+        slotCount = CUSTOMER_POOL_CAPACITY;
+
+    double initialReset[3];
+    RandomCustomerInitialResetBasedOnDifficulty(initialReset);
+
+    for (int i = 0; i < slotCount; i++)
+    {
+        CounterSlot* slot = &pool->slots[i];
+        slot->position = (Vector2){ firstPosition.x + spacing * i, firstPosition.y };
+        slot->customer = -1;
+        ScheduleEvent(&gameEvents, i < 3 ? initialReset[i] : RandomCustomerResetBasedOnDifficulty(), EVENT_CUSTOMER_ARRIVAL, slot, slot->generation, 0);
+    }
+
+    pool->slotCount = slotCount;
+    pool->emptySlotCount = slotCount;
+    pool->arrivalInterval = arrivalInterval;
+
+    if (arrivalInterval > 0)
+        ScheduleEvent(&gameEvents, arrivalInterval, EVENT_QUEUE_ARRIVAL, pool, 0, 0);
+}
+
+// Takes an entry off the free list, -1 when the pool is full
+int SpawnCustomer(CustomerPool* pool)
+{
+    int index = pool->firstFree;
+    if (index < 0)
+        return -1;
+
+    pool->firstFree = pool->nextFree[index];
+
+    // The entry keeps its generation, events for its previous customer stay stale
+    Customer* customer = &pool->entries[index];
+    uint32_t generation = customer->generation;
+    *customer = CreateCustomer(EMOTION_HAPPY, false, (Vector2) { 0, 0 }, RandomCustomerTexture());
+    customer->generation = generation;
+    return index;
+}
+
+void SeatCustomer(CustomerPool* pool, int index, int slotIndex)
+{
+    CounterSlot* slot = &pool->slots[slotIndex];
+    Customer* customer = &pool->entries[index];
+
+    slot->customer = index;
+    pool->emptySlotCount--;
+
+    customer->slot = slotIndex;
+    customer->position = slot->position;
+    customer->visible = true;
+    customer->seatedTime = gameEvents.now;
+    customer->orderEnd = RandomCustomerTimeoutBasedOnDifficulty();
+    customer->order = RandomGenerateOrder();
+
+    customer->activeIndex = pool->activeCount;
+    pool->active[pool->activeCount++] = index;
+    sessionStats.customersSeated++;
+
+    // Patience runs out on a fixed schedule, the mood changes at half and three quarters of it
+    StartCustomerBlink(customer);
+    ScheduleEvent(&gameEvents, customer->orderEnd * 0.5, EVENT_CUSTOMER_MOOD, customer, customer->generation, EMOTION_FRUSTRATED);
+    ScheduleEvent(&gameEvents, customer->orderEnd * 0.75, EVENT_CUSTOMER_MOOD, customer, customer->generation, EMOTION_ANGRY);
+    ScheduleEvent(&gameEvents, customer->orderEnd, EVENT_CUSTOMER_TIMEOUT, customer, customer->generation, 0);
+}
+
+// Queues a new customer, false when the pool or the queue is full
+bool QueueCustomer(CustomerPool* pool)
+{
+    if (pool->waitingCount >= CUSTOMER_POOL_CAPACITY)
+        return false;
+
+    int index = SpawnCustomer(pool);
+    if (index < 0)
+        return false;
+
+    // Nobody is waiting while a slot is free, walk straight up to it
+    if (pool->emptySlotCount > 0)
+    {
+        for (int i = 0; i < pool->slotCount; i++)
+        {
+            if (pool->slots[i].customer < 0)
+            {
+                SeatCustomer(pool, index, i);
+                return true;
+            }
+        }
+    }
+
+    pool->waiting[(pool->waitingStart + pool->waitingCount) % CUSTOMER_POOL_CAPACITY] = index;
+    pool->waitingCount++;
+
+    sessionStats.customersQueued++;
+    if (pool->waitingCount > sessionStats.longestQueue)
+        sessionStats.longestQueue = pool->waitingCount;
+    return true;
+}
+
+// Frees the customer and its slot, the next one in the queue takes the slot right away
+void ReleaseCustomer(CustomerPool* pool, int index)
+{
+    Customer* customer = &pool->entries[index];
+    CounterSlot* slot = &pool->slots[customer->slot];
+
+    // Swap the last active customer into the hole
+    int last = pool->active[--pool->activeCount];
+    pool->active[customer->activeIndex] = last;
+    pool->entries[last].activeIndex = customer->activeIndex;
+
+    slot->customer = -1;
+    slot->generation++;
+    pool->emptySlotCount++;
+
+    int slotIndex = customer->slot;
+    customer->generation++;
+    customer->visible = false;
+    customer->slot = -1;
+    customer->activeIndex = -1;
+    pool->nextFree[index] = pool->firstFree;
+    pool->firstFree = index;
+
+    if (pool->waitingCount > 0)
+    {
+        int next = pool->waiting[pool->waitingStart];
+        pool->waitingStart = (pool->waitingStart + 1) % CUSTOMER_POOL_CAPACITY;
+        pool->waitingCount--;
+        SeatCustomer(pool, next, slotIndex);
+    }
+    else
+        ScheduleEvent(&gameEvents, RandomCustomerResetBasedOnDifficulty(), EVENT_CUSTOMER_ARRIVAL, slot, slot->generation, 0);
+}
+
+// The seated customer closest to timing out, -1 when the counter is empty
+int FindMostImpatientCustomer(const CustomerPool* pool)
+{
+    int found = -1;
+    double earliestTimeout = 0;
+
+    for (int i = 0; i < pool->activeCount; i++)
+    {
+        const Customer* customer = &pool->entries[pool->active[i]];
+        double timeout = customer->seatedTime + customer->orderEnd;
+        if (found < 0 || timeout < earliestTimeout)
+        {
+            found = pool->active[i];
+            earliestTimeout = timeout;
+        }
+    }
+
+    return found;
+}
+
+void HandleGameEvent(const GameEvent* event)
+{
+    switch (event->type)
+    {
+    case EVENT_CUSTOMER_ARRIVAL: {
+        CounterSlot* slot = (CounterSlot*)event->target;
+        if (slot->generation != event->generation || slot->customer >= 0)
+            break;
+
+        int index = SpawnCustomer(&customerPool);
+        if (index >= 0)
+            SeatCustomer(&customerPool, index, (int)(slot - customerPool.slots));
+        break;
+    }
+    case EVENT_QUEUE_ARRIVAL: {
+        CustomerPool* pool = (CustomerPool*)event->target;
+        QueueCustomer(pool);
+        ScheduleEvent(&gameEvents, pool->arrivalInterval, EVENT_QUEUE_ARRIVAL, pool, 0, 0);
+        break;
+    }
+    case EVENT_CUSTOMER_MOOD: {
+        Customer* customer = (Customer*)event->target;
+        if (customer->generation == event->generation)
+            customer->emotion = (CustomerEmotion)event->value;
+        break;
+    }
+    case EVENT_CUSTOMER_TIMEOUT: {
+        Customer* customer = (Customer*)event->target;
+        if (customer->generation != event->generation)
+            break;
+
+        PlaySoundFx(FX_ANGRY);
+        ReleaseCustomer(&customerPool, (int)(customer - customerPool.entries));
+        global_score -= 50;
+        sessionStats.timeouts++;
+        break;
+    }
+    case EVENT_CUSTOMER_BLINK: {
+        Customer* customer = (Customer*)event->target;
+        if (customer->generation != event->generation)
+            break;
+
+        customer->eyesClosed = !customer->eyesClosed;
+        ScheduleEvent(&gameEvents, customer->eyesClosed ? customer->blinkDuration : customer->normalDuration, EVENT_CUSTOMER_BLINK, customer, customer->generation, 0);
+        break;
+    }
+    case EVENT_BOIL_TICK:
+        if (event->generation == boilGeneration)
+            tickBoil((Ingredient*)event->target);
+        break;
+    }
+}
+
+bool IsGameEventStale(const GameEvent* event)
+{
+    switch (event->type)
+    {
+    case EVENT_CUSTOMER_ARRIVAL:
+        return ((CounterSlot*)event->target)->generation != event->generation;
+    case EVENT_CUSTOMER_MOOD:
+    case EVENT_CUSTOMER_TIMEOUT:
+    case EVENT_CUSTOMER_BLINK:
+        return ((Customer*)event->target)->generation != event->generation;
+    case EVENT_BOIL_TICK:
+        return event->generation != boilGeneration;
+    default:
+        return false;
+    }
+}
+
+// Advances the scheduler clock and runs every event that came due, once per frame for all scenes
+void RunGameEvents(double deltaTime)
+{
+    gameEvents.now += deltaTime;
+
+    GameEvent event;
+    while (PopDueEvent(&gameEvents, &event))
+        HandleGameEvent(&event);
+}
+
+void ResetGameState();
+void PlaySoundFx(SoundFxType type) {
+    int randomIndex = 0;
+
+    if (!options->soundFxEnabled) return;
+
+    switch (type) {
+    case FX_ANGRY: {
+        Sound angrySounds[] = { angry1Fx, angry2Fx, angry3Fx, angry4Fx };
+        randomIndex = RandomInt(RANDOM_AUDIO, 0, (int)(sizeof(angrySounds) / sizeof(angrySounds[0])) - 1);
+        PlaySound(angrySounds[randomIndex]);
+        break;
+    }
+    case FX_BOTTLE: {
+        Sound bottleSounds[] = { bottle1Fx, bottle2Fx, bottle3Fx };
+        randomIndex = RandomInt(RANDOM_AUDIO, 0, (int)(sizeof(bottleSounds) / sizeof(bottleSounds[0])) - 1);
+        PlaySound(bottleSounds[randomIndex]);
+        break;
+    }
+    case FX_CONFUSED: {
+        Sound confusedSounds[] = { confused1Fx, confused2Fx, confused3Fx, confused4Fx };
+        randomIndex = RandomInt(RANDOM_AUDIO, 0, (int)(sizeof(confusedSounds) / sizeof(confusedSounds[0])) - 1);
+        PlaySound(confusedSounds[randomIndex]);
+        break;
+    }
+    case FX_CORRECT:
+        PlaySound(correctFx);
+        break;
+    case FX_DROP: {
+        Sound dropSounds[] = { drop1Fx, drop2Fx, drop3Fx };
+        randomIndex = RandomInt(RANDOM_AUDIO, 0, (int)(sizeof(dropSounds) / sizeof(dropSounds[0])) - 1);
+        PlaySound(dropSounds[randomIndex]);
+        break;
+    }
+    case FX_PICKUP: {
+        Sound pickupSounds[] = { pickup1Fx, pickup2Fx, pickup3Fx };
+        randomIndex = RandomInt(RANDOM_AUDIO, 0, (int)(sizeof(pickupSounds) / sizeof(pickupSounds[0])) - 1);
+        PlaySound(pickupSounds[randomIndex]);
+        break;
+    }
+    case FX_POUR: {
+        Sound pourSounds[] = { pour1Fx, pour2Fx, pour3Fx };
+        randomIndex = RandomInt(RANDOM_AUDIO, 0, (int)(sizeof(pourSounds) / sizeof(pourSounds[0])) - 1);
+        PlaySound(pourSounds[randomIndex]);
+        break;
+    }
+    case FX_STIR: {
+        Sound stirSounds[] = { stir1Fx, stir2Fx, stir3Fx };
+        randomIndex = RandomInt(RANDOM_AUDIO, 0, (int)(sizeof(stirSounds) / sizeof(stirSounds[0])) - 1);
+        PlaySound(stirSounds[randomIndex]);
+        break;
+    }
+    case FX_BOONG:
+        PlaySound(boongFx);
+        break;
+    case FX_HOVER:
+        PlaySound(hoverFx);
+        break;
+    case FX_SELECT:
+        PlaySound(selectFx);
+        break;
+    case FX_FLICK:
+        PlaySound(flickFx);
+        break;
+    case FX_NONE:
+        break;
+    }
+}
+// Picks the customer tier from the height the 1920x1080 view is rendered at in the current window
+int PickCustomerAtlasTier()
+{
+    if (options->resolution.x <= 0 || options->resolution.y <= 0)
+        return CUSTOMER_ATLAS_TIER_COUNT - 1;
 
-bool highlightItem(Ingredient* item, Camera2D* camera) {
-    Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-    static bool isHovering;
-    if (CheckCollisionPointRec(mousePos, (Rectangle) { item->position.x, item->position.y, item->frameRectangle.width, item->frameRectangle.height }) && item->totalFrames > item->currentFrame) {
-        item->frameRectangle = frameRect(*item, item->totalFrames, item->currentFrame + 1);
-        return true;
+    float currentAspectRatio = (float)options->resolution.x / (float)options->resolution.y;
+    float renderHeight = (currentAspectRatio > targetAspectRatio) ? (float)options->resolution.y : (float)options->resolution.x / targetAspectRatio;
+
+    for (int i = 0; i < CUSTOMER_ATLAS_TIER_COUNT; i++)
+    {
+        if (renderHeight <= customerAtlasTiers[i].renderHeight)
+            return i;
     }
-    else {
-        item->frameRectangle = frameRect(*item, item->totalFrames, item->currentFrame);
-        return false;
+
+    return CUSTOMER_ATLAS_TIER_COUNT - 1;
+}
+
+void GetCustomerRegions()
+{
+    for (int i = 0; i < 3; i++)
+    {
+        customersImageData[i].happy = GetAtlasRegion(&customerAtlas, TextFormat("customer_%d/happy", i + 1));
+        customersImageData[i].frustrated = GetAtlasRegion(&customerAtlas, TextFormat("customer_%d/frustrated", i + 1));
+        customersImageData[i].angry = GetAtlasRegion(&customerAtlas, TextFormat("customer_%d/angry", i + 1));
     }
+
+    Log(LOG_INFO, "Customer sprites loaded for %dp", customerAtlasTiers[customerAtlasTier].renderHeight);
 }
 
-// Function prototype
-void MainMenuUpdate(Camera2D* camera, bool playFade);
-void OptionsUpdate(Camera2D* camera);
-void endgameUpdate(Camera2D* camera);
+void LoadCustomerAtlas(int tier)
+{
+    UnloadAtlas(&customerAtlas);
+    LoadAtlas(&customerAtlas, ASSETS_PATH"customer_manifest.txt", customerAtlasTiers[tier].path, customerAtlasTiers[tier].scale);
+    customerAtlasTier = tier;
+    GetCustomerRegions();
+}
 
-// Menu customers
-Customer menuCustomer1;
-Customer menuCustomer2;
+// Swaps the customer atlas once the window moves into another tier
+void UpdateCustomerAtlasTier()
+{
+    if (!isGlobalAssetsLoadFinished)
+        return;
 
-// Menu falling items
-#define menuFallingItemsNumber 8
-MenuFallingItem menuFallingItems[20];
-GameOptions *options;
+    int tier = PickCustomerAtlasTier();
+    if (tier != customerAtlasTier)
+        LoadCustomerAtlas(tier);
+}
 
-// Moving clouds
-MovingCloud movingClouds[7];
+void WindowUpdate(Camera2D* camera)
+{
+    if (IsWindowResized())
+    {
+        int screenWidth = GetScreenWidth();
+        int screenHeight = GetScreenHeight();
 
-// Moving stars
-MovingStar movingStars[2];
 
-// Current BGM
-Music* currentBgm = NULL;
-bool isCurrentBgmPaused = false;
+        float currentAspectRatio = (float)screenWidth / (float)screenHeight;
+        float scale = (currentAspectRatio > targetAspectRatio) ? (float)screenHeight / BASE_SCREEN_HEIGHT : (float)screenWidth / BASE_SCREEN_WIDTH;
 
-// Load duration timer
-double loadDurationTimer = 0.0;
-bool isGlobalAssetsLoadFinished = false;
+        camera->zoom = scale;
+        camera->offset.x = screenWidth / 2.0f;
+        camera->offset.y = screenHeight / 2.0f;
 
-// Start from night
-int currentColorIndex = 3;
-float dayNightCycleDuration = 120.0f;
-// Skip to 1/2 of the night, so that the first transition is from night to morning
-float colorTransitionTime = 0.5f;
+        options->resolution.x = screenWidth;
+        options->resolution.y = screenHeight;
+    }
+
+    // Alt - Enter fullscreen
+    if (IsKeyDown(KEY_LEFT_ALT) && IsKeyPressed(KEY_ENTER) || IsKeyDown(KEY_RIGHT_ALT) && IsKeyPressed(KEY_ENTER))
+    {
+        SetRuntimeResolution(camera, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT);
+        ToggleFullscreen();
+    }
 
+    if(currentBgm != NULL)
+        UpdateMusicStream(*currentBgm);
 
-void CustomLogger(int msgType, const char* text, va_list args)
+    UpdateCustomerAtlasTier();
+}
+
+// Scene asset sets, see AcquireAssetSet
+const AssetUse sharedAssetUses[] = {
+    { ASSET_TEXTURE, ASSETS_PATH"image/backgrounds/main.png", &backgroundTexture },
+    { ASSET_TEXTURE, ASSETS_PATH"image/backgrounds/main_overlay_1.png", &backgroundOverlayTexture },
+    { ASSET_TEXTURE, ASSETS_PATH"image/backgrounds/main_overlay_2.png", &backgroundOverlaySidebarTexture },
+
+    { ASSET_TEXTURE, ASSETS_PATH"image/sprite/cloud_1.png", &cloud1Texture },
+    { ASSET_TEXTURE, ASSETS_PATH"image/sprite/cloud_2.png", &cloud2Texture },
+    { ASSET_TEXTURE, ASSETS_PATH"image/sprite/cloud_3.png", &cloud3Texture },
+    { ASSET_TEXTURE, ASSETS_PATH"image/sprite/star_1.png", &star1Texture },
+    { ASSET_TEXTURE, ASSETS_PATH"image/sprite/star_2.png", &star2Texture },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/hover.wav", &hoverFx },
+    { ASSET_SOUND, ASSETS_PATH"audio/select.wav", &selectFx },
+
+    // Keeps playing through the game
+    { ASSET_MUSIC, ASSETS_PATH"audio/bgm/Yojo_Summer_My_Heart.wav", &menuBgm },
+};
+
+const AssetUse menuAssetUses[] = {
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/cara.png", &menuFallingItemTextures[0] },
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/cmilk.png", &menuFallingItemTextures[1] },
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/cocoa.png", &menuFallingItemTextures[2] },
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/gar.png", &menuFallingItemTextures[3] },
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/marshmello.png", &menuFallingItemTextures[4] },
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/matcha.png", &menuFallingItemTextures[5] },
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/milk.png", &menuFallingItemTextures[6] },
+    { ASSET_TEXTURE, ASSETS_PATH"image/falling_items/wcream.png", &menuFallingItemTextures[7] },
+};
+
+const AssetUse gameAssetUses[] = {
+    { ASSET_SOUND, ASSETS_PATH"audio/boong.wav", &boongFx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/angry_1.wav", &angry1Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/angry_2.wav", &angry2Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/angry_3.wav", &angry3Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/angry_4.wav", &angry4Fx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/bottle_1.wav", &bottle1Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/bottle_2.wav", &bottle2Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/bottle_3.wav", &bottle3Fx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/confused_1.wav", &confused1Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/confused_2.wav", &confused2Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/confused_3.wav", &confused3Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/confused_4.wav", &confused4Fx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/correct.wav", &correctFx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/drop_1.wav", &drop1Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/drop_2.wav", &drop2Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/drop_3.wav", &drop3Fx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/pickup_1.wav", &pickup1Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/pickup_2.wav", &pickup2Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/pickup_3.wav", &pickup3Fx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/pour_1.wav", &pour1Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/pour_2.wav", &pour2Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/pour_3.wav", &pour3Fx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/stir_1.wav", &stir1Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/stir_2.wav", &stir2Fx },
+    { ASSET_SOUND, ASSETS_PATH"audio/stir_3.wav", &stir3Fx },
+
+    { ASSET_SOUND, ASSETS_PATH"audio/flick.wav", &flickFx },
+};
+
+#define ASSET_USE_COUNT(uses) (int)(sizeof(uses) / sizeof(uses[0]))
+
+// Everything after the splash, the end screen uses nothing else
+const AssetSet sharedAssets = { "shared", NULL, sharedAssetUses, ASSET_USE_COUNT(sharedAssetUses) };
+// Main menu and options
+const AssetSet menuAssets = { "menu", &sharedAssets, menuAssetUses, ASSET_USE_COUNT(menuAssetUses) };
+const AssetSet gameAssets = { "game", &sharedAssets, gameAssetUses, ASSET_USE_COUNT(gameAssetUses) };
+
+// Queues the atlases on the asset loader, they stay loaded until shutdown. FinishGlobalAssets wires them up once it is done.
+void RequestGlobalAssets()
+{
+    // Spritesheets, cup combinations and UI elements all come from the atlas
+    RequestAtlas(&spriteAtlas, ASSETS_PATH"atlas_manifest.txt", ATLAS_PATH, 1.0f);
+
+    customerAtlasTier = PickCustomerAtlasTier();
+    RequestAtlas(&customerAtlas, ASSETS_PATH"customer_manifest.txt", customerAtlasTiers[customerAtlasTier].path, customerAtlasTiers[customerAtlasTier].scale);
+}
+
+// Called once the asset loader is done with RequestGlobalAssets
+void FinishGlobalAssets()
+{
+    ResolveAtlasRegions(&spriteAtlas);
+
+    checkbox = GetAtlasRegion(&spriteAtlas, "image/elements/checkbox");
+    checkboxChecked = GetAtlasRegion(&spriteAtlas, "image/elements/checkbox_checked");
+    left_arrow = GetAtlasRegion(&spriteAtlas, "image/elements/left_arrow");
+    right_arrow = GetAtlasRegion(&spriteAtlas, "image/elements/right_arrow");
+    bubbles = GetAtlasRegion(&spriteAtlas, "image/elements/bubbles");
+
+    LoadCupCombinations();
+
+    ResolveAtlasRegions(&customerAtlas);
+    GetCustomerRegions();
+
+    menuCustomer1 = CreateCustomer(EMOTION_HAPPY, true, (Vector2) { baseX + 650, baseY + 55 }, 1);
+    menuCustomer2 = CreateCustomer(EMOTION_HAPPY, true, (Vector2) { baseX + 1200, baseY + 52 }, 2);
+    menuCustomer1.isDummy = true;
+    menuCustomer2.isDummy = true;
+
+    // Everything is on the GPU or in audio buffers now, the mapped copies can go until the next customer tier swap
+    DiscardAssetArchivePages(assetArchive);
+
+    loadDurationTimer = GetTime() - assetLoader.startTime;
+    Log(LOG_INFO, "Global assets loaded from %s in %.0f ms with %d loader threads, %.0f ms of it uploading on the main thread",
+        assetArchive != NULL ? "the asset archive" : "individual files", loadDurationTimer * 1000.0, GetTaskPoolThreadCount(assetLoader.pool), assetLoader.uploadTime * 1000.0);
+    Log(LOG_INFO, "Resident memory after loading: %.1f MB", GetResidentMemoryBytes() / (1024.0 * 1024.0));
+
+    isGlobalAssetsLoadFinished = true;
+}
+
+void LoadGlobalAssets()
+{
+    RequestGlobalAssets();
+    FlushAssetLoader();
+    FinishGlobalAssets();
+}
+
+// Scene assets are released with their scenes, this only covers what lives for the whole run
+void UnloadGlobalAssets()
 {
-    char timeStr[64] = { 0 };
-    time_t now = time(NULL);
-    struct tm* tm_info = localtime(&now);
+    UnloadFont(meowFont);
+
+    UnloadTrackedTexture(logoTexture);
+    UnloadTrackedTexture(splashBackgroundTexture);
+    UnloadTrackedTexture(splashOverlayTexture);
 
-    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", tm_info);
-    printf("[%s] ", timeStr);
+    UnloadAtlas(&customerAtlas);
+    customerAtlasTier = -1;
+
+    UnloadAtlas(&spriteAtlas);
+}
 
-    // Calculate the size needed for the formatted log message
-    int logMessageSize = vsnprintf(NULL, 0, text, args) + 1;
-    char* logMessage = (char*)malloc(logMessageSize);
 
-    switch (msgType)
+void PlayBgm(Music *bgm)
+{
+    if (bgm == currentBgm)
     {
-        case LOG_DEBUG: printf("[DEBUG]: "); break;
-        case LOG_INFO: printf("[INFO] : "); break;
-        case LOG_WARNING: printf("[WARN] : "); break;
-        case LOG_ERROR: printf("[ERROR]: "); break;
-        case LOG_FATAL: printf("[FATAL]: "); break;
-        default: break;
+        if (isCurrentBgmPaused && options->musicEnabled)
+        {
+            PlayMusicStream(*bgm);
+            bgm->looping = true;
+            isCurrentBgmPaused = false;
+        }
+        return;
     }
 
-    // Format the log message and store it in logMessage
-    vsnprintf(logMessage, logMessageSize, text, args);
+    currentBgm = bgm;
+	StopMusicStream(*currentBgm);
+	PlayMusicStream(*currentBgm);
+    SetMusicVolume(*currentBgm, bgmVolume);
+    bgm->looping = true;
+    isCurrentBgmPaused = false;
+}
 
-    // Add message to the log array, with shifting logic
-    if (DebugLogsIndex == DEBUG_MAX_LOGS_HISTORY) {
-        // If the array is full, shift the previous messages to make space
-        for (int i = 0; i < DEBUG_MAX_LOGS_HISTORY - 1; i++) {
-            DebugLogs[i] = DebugLogs[i + 1];
+void PlayBgmIfStopped(Music* bgm)
+{
+    if (bgm == currentBgm)
+    {
+        if (isCurrentBgmPaused && options->musicEnabled)
+        {
+            PlayMusicStream(*bgm);
+            SetMusicVolume(*bgm, bgmVolume);
+            bgm->looping = true;
+            isCurrentBgmPaused = false;
         }
-        DebugLogsIndex = DEBUG_MAX_LOGS_HISTORY - 1;
+        return;
     }
 
-    DebugLogs[DebugLogsIndex].type = msgType;
-    DebugLogs[DebugLogsIndex].text = logMessage;
-    DebugLogsIndex++;
-
-    printf("%s\n", logMessage);
+    currentBgm = bgm;
+    PlayMusicStream(*currentBgm);
+    SetMusicVolume(*currentBgm, bgmVolume);
+    bgm->looping = true;
+    isCurrentBgmPaused = false;
 }
 
-void LogDebug(const char* text, ...)
+void PauseBgm(Music *bgm)
 {
-    va_list args;
-    va_start(args, text);
-    CustomLogger(LOG_DEBUG, text, args);
-    va_end(args);
+	if (bgm != currentBgm) return;
+	if (isCurrentBgmPaused) return;
+
+	PauseMusicStream(*bgm);
+	isCurrentBgmPaused = true;
 }
 
-void Log(int msgType, const char* text, ...)
+void StopBgm(Music *bgm)
 {
-    va_list args;
-    va_start(args, text);
-    CustomLogger(msgType, text, args);
-    va_end(args);
+	StopMusicStream(*bgm);
+    isCurrentBgmPaused = false;
+    currentBgm = NULL;
 }
 
-Color GetTextColorFromLogType(TraceLogLevel level)
+Color ColorAlphaOverride(Color color, float alpha)
 {
-	switch (level)
-	{
-    case LOG_DEBUG: return DARKGRAY;
-	case LOG_INFO: return WHITE;
-	case LOG_WARNING: return YELLOW;
-	case LOG_ERROR: return RED;
-    case LOG_FATAL: return ORANGE;
-	default: return WHITE;
-	}
+	return (Color) { color.r, color.g, color.b, (unsigned char)(alpha * 255) };
 }
 
-void DrawDragableItemFrame(Ingredient i) {
-    DrawTextureRec(i.texture, i.frameRectangle, i.position, RAYWHITE);
+void DrawDayNightCycle(double deltaTime)
+{
+    PROFILE_BEGIN("Day/night cycle");
+
+    const Color dayNightColors[] = {
+        (Color){173, 216, 230, 255},  // Morning (Anime Light Blue)
+        (Color){0, 102, 204, 255},    // Afternoon (Anime Blue)
+        (Color){245, 161, 59, 255},    // Evening (Anime Orange)
+        (Color){0, 0, 102, 255}       // Night (Anime Dark Blue)
+    };
+
+    float colorTransitionSpeed = (float)(sizeof(dayNightColors) / sizeof(dayNightColors[0])) / dayNightCycleDuration;
+
+    // Determine the color to interpolate from and to
+    int fromColorIndex = currentColorIndex;
+    int toColorIndex = (currentColorIndex + 1) % (sizeof(dayNightColors) / sizeof(dayNightColors[0]));
+
+    // Calculate the interpolation factor (0 to 1) based on colorTransitionTime
+    float t = fmin(colorTransitionTime, 1.0f);
+
+    // Interpolate between the colors
+    Color fromColor = dayNightColors[fromColorIndex];
+    Color toColor = dayNightColors[toColorIndex];
+    Color currentColor = ColorLerp(fromColor, toColor, t);
+
+    // Draw the day/night color overlay with the scaled dimensions
+    FlushSpriteQueue();
+    DrawRectangle(baseX, baseY, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, currentColor);
+
+    // Draw moving clouds
+    DrawMovingCloudAndStar(deltaTime);
+
+    // Draw day/night cycle debug overlay
     if (options->showDebug && debugToolToggles.showObjects)
     {
-        DrawRectangleLinesEx((Rectangle) { i.position.x, i.position.y, i.frameRectangle.width, i.frameRectangle.height }, 1, RED);
-        DrawRectangle(i.position.x, i.position.y - 20, 300, 20, Fade(GRAY, 0.7));
-        DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f", "Ingredient", i.position.x, i.position.y), (Vector2) { i.position.x, i.position.y - 20 }, 20, 1, WHITE);
+        FlushSpriteQueue();
+        DrawRectangle(baseX + 500, baseY + 25, 400, 20, Fade(GRAY, 0.7));
+        DrawTextEx(meowFont, TextFormat("Time %.2f/%.2f | Phrase %d/%d", colorTransitionTime * dayNightCycleDuration, dayNightCycleDuration, currentColorIndex + 1, (sizeof(dayNightColors) / sizeof(dayNightColors[0]))), (Vector2) { baseX + BASE_SCREEN_WIDTH - 500, baseY + 25 }, 20, 2, WHITE);
+    }
+
+    // Update the colorTransitionTime
+    if (colorTransitionTime >= 1.0f)
+    {
+        currentColorIndex = toColorIndex;
+        colorTransitionTime = 0;
+    }
+    else
+    {
+        colorTransitionTime += deltaTime * colorTransitionSpeed;
     }
+
+    PROFILE_END();
 }
 
+// Options scene
+typedef struct OptionsState {
+    int currentHoveredButton;
+    bool firstRender;
+    bool isHovering;
+
+    float alpha;
+    double fadeInDuration;
+    double fadeOutDuration;
+    bool isFadingIn;
+    bool isFadingOut;
+
+    Rectangle difficultyRect;
+    Rectangle difficultyDecrementRect;
+    Rectangle difficultyIncrementRect;
+    Rectangle resolutionRect;
+    Rectangle resolutionDecrementRect;
+    Rectangle resolutionIncrementRect;
+    Rectangle fpsRect;
+    Rectangle fpsDecrementRect;
+    Rectangle fpsIncrementRect;
+    Rectangle musicRect;
+    Rectangle soundFxRect;
+    Rectangle fullscreenRect;
+    Rectangle debugRect;
+    Rectangle backRect;
+
+    bool isDifficultyIncrementHovered;
+    bool isDifficultyDecrementHovered;
+    bool isResolutionIncrementHovered;
+    bool isResolutionDecrementHovered;
+    bool isFpsIncrementHovered;
+    bool isFpsDecrementHovered;
+    bool isMusicHovered;
+    bool isSoundFxHovered;
+    bool isFullscreenHovered;
+    bool isDebugHovered;
+    bool isBackHovered;
+} OptionsState;
+
+OptionsState optionsScene;
+
+void OptionsEnter(Camera2D* camera)
+{
+    OptionsState* state = &optionsScene;
+    *state = (OptionsState){ 0 };
+
+    StartCustomerBlink(&menuCustomer1);
+    StartCustomerBlink(&menuCustomer2);
 
-void DrawMenuFallingItems(double deltaTime, bool behide)
-{
-    int startIndex = behide ? 0 : 11;
-    int endIndex = behide ? 11 : 20;
+    state->currentHoveredButton = NO_BUTTON;
+    state->difficultyRect = (Rectangle){ baseX + 780, baseY + 595, 340, 70 };
+    state->difficultyDecrementRect = (Rectangle){ state->difficultyRect.x, state->difficultyRect.y, 60, 70 };
+    state->difficultyIncrementRect = (Rectangle){ state->difficultyRect.x + 280, state->difficultyRect.y, 60, 70 };
 
-    for (int i = startIndex; i < endIndex; i++) {
-        MenuFallingItem* item = &menuFallingItems[i];
+    state->resolutionRect = (Rectangle){ baseX + 780, baseY + 675, 340, 70 };
+    state->resolutionDecrementRect = (Rectangle){ state->resolutionRect.x, state->resolutionRect.y, 60, 70 };
+    state->resolutionIncrementRect = (Rectangle){ state->resolutionRect.x + 280, state->resolutionRect.y, 60, 70 };
 
-        item->position.y += item->fallingSpeed * deltaTime;
-        item->rotation += item->rotationSpeed * deltaTime;
+    state->fpsRect = (Rectangle){ baseX + 1200, baseY + 595, 340, 70 };
+    state->fpsDecrementRect = (Rectangle){ state->fpsRect.x, state->fpsRect.y, 60, 70 };
+    state->fpsIncrementRect = (Rectangle){ state->fpsRect.x + 280, state->fpsRect.y, 60, 70 };
 
-        Vector2 origin = { (float)menuFallingItemTextures[item->textureIndex].width / 2, (float)menuFallingItemTextures[item->textureIndex].height / 2 };
-        DrawTexturePro(menuFallingItemTextures[item->textureIndex], (Rectangle) { 0, 0, menuFallingItemTextures[item->textureIndex].width, menuFallingItemTextures[item->textureIndex].height },
-            (Rectangle) {
-            item->position.x, item->position.y, menuFallingItemTextures[item->textureIndex].width, menuFallingItemTextures[item->textureIndex].height
-        },
-            origin, item->rotation, WHITE);
+    state->musicRect = (Rectangle){ baseX + 100, baseY + 595, 200, 70 };
+    state->soundFxRect = (Rectangle){ baseX + 100, baseY + 675, 250, 70 };
 
-        if (options->showDebug && debugToolToggles.showObjects) {
-            Vector2 corners[4];
-            corners[0] = (Vector2){ -origin.x, -origin.y };
-            corners[1] = (Vector2){ -origin.x, origin.y };
-            corners[2] = (Vector2){ origin.x, origin.y };
-            corners[3] = (Vector2){ origin.x, -origin.y };
+    state->fullscreenRect = (Rectangle){ baseX + 400, baseY + 595, 300, 70 };
+    state->debugRect = (Rectangle){ baseX + 400, baseY + 675, 200, 70 };
 
-            for (int j = 0; j < 4; j++) {
-                float tempX = corners[j].x * cos(DEG2RAD * item->rotation) - corners[j].y * sin(DEG2RAD * item->rotation);
-                float tempY = corners[j].x * sin(DEG2RAD * item->rotation) + corners[j].y * cos(DEG2RAD * item->rotation);
-                corners[j].x = tempX + item->position.x;
-                corners[j].y = tempY + item->position.y;
-            }
+    state->backRect = (Rectangle){ baseX + 100, baseY + 840, 200, 70 };
 
-            DrawLineEx(corners[0], corners[1], 1, RED);
-            DrawLineEx(corners[1], corners[2], 1, RED);
-            DrawLineEx(corners[2], corners[3], 1, RED);
-            DrawLineEx(corners[3], corners[0], 1, RED);
+    state->firstRender = true;
+    state->alpha = 0.0f;
+    state->fadeInDuration = 0.35;
+    state->fadeOutDuration = 0.35;
+    state->isFadingIn = true;
+    state->isFadingOut = false;
 
-            DrawRectangle(item->position.x, item->position.y, 550, 20, Fade(GRAY, 0.7));
-            DrawTextEx(meowFont, TextFormat("%d | XY %.2f,%.2f | R %.2f | G %.2f | Behide %s", i, item->position.x, item->position.y, item->rotation, item->fallingSpeed, behide ? "[Yes]" : "[No]"), (Vector2) { item->position.x, item->position.y }, 20, 1, WHITE);
+    PlayBgmIfStopped(&menuBgm);
+}
+
+void OptionsUpdate(Camera2D* camera, double deltaTime)
+{
+    OptionsState* state = &optionsScene;
+
+    if (state->isFadingIn)
+    {
+        state->alpha += deltaTime / state->fadeInDuration;
+        if (state->alpha >= 1.0f)
+        {
+            state->alpha = 1.0f;
+            state->isFadingIn = false;
         }
+    }
 
-        if (item->position.y > baseY + BASE_SCREEN_HEIGHT + 1000) {
-            item->position = (Vector2){ GetRandomDoubleValue(baseX, baseX + BASE_SCREEN_WIDTH - 20), baseY - GetRandomDoubleValue(200, 1000) };
-            item->textureIndex = GetRandomValue(0, menuFallingItemsNumber - 1);
-            item->fallingSpeed = GetRandomDoubleValue(1, 3);
-            item->fallingSpeed *= 100;
-            item->rotation = GetRandomDoubleValue(-360, 360);
-            item->rotationSpeed = GetRandomValue(-3, 3);
-            item->rotationSpeed *= 100;
-            if (fabsf(item->rotationSpeed) > item->fallingSpeed)
-                item->rotationSpeed = item->fallingSpeed;
-            if (item->rotationSpeed == 0)
-                item->rotationSpeed = 1 * 100;
+    if (state->isFadingOut)
+    {
+        state->alpha -= deltaTime / state->fadeOutDuration;
+        if (state->alpha <= 0.0f)
+        {
+            state->alpha = 0.0f;
+            state->isFadingOut = false;
+            ChangeSceneToMainMenu(false);
+            return;
         }
     }
-}
 
-bool IsNight()
-{
-    return currentColorIndex == 3 && colorTransitionTime < 0.4;
-}
+    Vector2 mouseWorldPos = frameInput.mouse;
 
-void DrawMovingCloudAndStar(double deltaTime)
-{
-    int cloudCount = sizeof(movingClouds) / sizeof(movingClouds[0]);
-    int starCount = sizeof(movingStars) / sizeof(movingStars[0]);
+    state->isDifficultyIncrementHovered = CheckCollisionPointRec(mouseWorldPos, state->difficultyIncrementRect);
+    state->isDifficultyDecrementHovered = CheckCollisionPointRec(mouseWorldPos, state->difficultyDecrementRect);
 
-    if (IsNight())
-    {
+    state->isResolutionIncrementHovered = CheckCollisionPointRec(mouseWorldPos, state->resolutionIncrementRect);
+    state->isResolutionDecrementHovered = CheckCollisionPointRec(mouseWorldPos, state->resolutionDecrementRect);
 
-        for (int i = 0; i < starCount; i++) {
+    state->isFpsIncrementHovered = CheckCollisionPointRec(mouseWorldPos, state->fpsIncrementRect);
+    state->isFpsDecrementHovered = CheckCollisionPointRec(mouseWorldPos, state->fpsDecrementRect);
 
-            MovingStar* cloud = &movingStars[i];
+    state->isMusicHovered = CheckCollisionPointRec(mouseWorldPos, state->musicRect);
+    state->isSoundFxHovered = CheckCollisionPointRec(mouseWorldPos, state->soundFxRect);
+    state->isFullscreenHovered = CheckCollisionPointRec(mouseWorldPos, state->fullscreenRect);
+    state->isDebugHovered = CheckCollisionPointRec(mouseWorldPos, state->debugRect);
 
-            bool fromRight = false;
-            bool isInView = cloud->position.x >= baseX && cloud->position.x <= baseX + BASE_SCREEN_WIDTH && cloud->position.y >= baseY && cloud->position.y <= baseY + BASE_SCREEN_HEIGHT;
+    state->isBackHovered = CheckCollisionPointRec(mouseWorldPos, state->backRect);
 
-            // Calculate the X position based on time and direction
-            if (fromRight) {
-                cloud->position.x -= cloud->speed * deltaTime;
-                // Check if the cloud has moved off the screen
-                if ((float)cloud->position.x + ((float)(cloud->texture.width) * (float)(cloud->scale)) <= baseX) {
-                    cloud->position.x = baseX + BASE_SCREEN_WIDTH + (cloud->texture.width * cloud->scale) + GetRandomDoubleValue(100, 500);
-                }
+    // Handle user input
+    if (!state->firstRender && HasFrameInput(INPUT_MOUSE_LEFT_PRESSED) && !state->isFadingIn && !state->isFadingOut) {
+        if (state->isDifficultyIncrementHovered) {
+            if (options->difficulty == EASY) {
+                options->difficulty = FREEPLAY_EASY;
             }
-            else {
-                cloud->position.x += cloud->speed * deltaTime;
-                // Check if the cloud has moved off the screen
-                if (cloud->position.x > baseX + BASE_SCREEN_WIDTH) {
-                    cloud->position.x = baseX - (cloud->texture.width * cloud->scale) - GetRandomDoubleValue(100, 500);
-                }
+            else if (options->difficulty == FREEPLAY_EASY) {
+                options->difficulty = MEDIUM;
             }
-
-            // Draw the cloud
-            DrawTexture(cloud->texture, cloud->position.x, cloud->position.y, WHITE);
-
-            // Debug
-            if (options->showDebug && debugToolToggles.showObjects)
-            {
-                DrawRectangleLinesEx((Rectangle) { cloud->position.x, cloud->position.y, cloud->texture.width* cloud->scale, cloud->texture.height* cloud->scale }, 1, RED);
-                DrawRectangle(cloud->position.x, cloud->position.y - 20, 300, 20, Fade(GRAY, 0.7));
-                DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Speed %.2f | Scale %.2f", "Stars", cloud->position.x, cloud->position.y, cloud->speed, cloud->scale), (Vector2) { cloud->position.x, cloud->position.y - 20 }, 20, 1, WHITE);
+            else if (options->difficulty == MEDIUM) {
+                options->difficulty = FREEPLAY_MEDIUM;
             }
+            else if (options->difficulty == FREEPLAY_MEDIUM) {
+                options->difficulty = HARD;
+            }
+            else if (options->difficulty == HARD) {
+                options->difficulty = FREEPLAY_HARD;
+            }
+            PlaySoundFx(FX_SELECT);
         }
-    }
-    else
-    {
-        for (int i = 0; i < cloudCount; i++) {
-            MovingCloud* cloud = &movingClouds[i];
-
-            bool fromRight = cloud->fromRight;
-            bool isInView = cloud->position.x >= baseX && cloud->position.x <= baseX + BASE_SCREEN_WIDTH && cloud->position.y >= baseY && cloud->position.y <= baseY + BASE_SCREEN_HEIGHT;
-
-            // Calculate the X position based on time and direction
-            if (fromRight) {
-                cloud->position.x -= cloud->speed * deltaTime;
-                // Check if the cloud has moved off the screen
-                if ((float)cloud->position.x + ((float)(cloud->texture.width) * (float)(cloud->scale)) <= baseX) {
-                    cloud->position.x = baseX + BASE_SCREEN_WIDTH + (cloud->texture.width * cloud->scale) + GetRandomDoubleValue(100, 500);
-                    cloud->position.y = GetRandomDoubleValue(baseY, 0);
+        else if (state->isDifficultyDecrementHovered) {
+            if (options->difficulty == FREEPLAY_HARD) {
+                options->difficulty = HARD;
+            }
+            else if (options->difficulty == HARD) {
+                options->difficulty = FREEPLAY_MEDIUM;
+            }
+            else if (options->difficulty == FREEPLAY_MEDIUM) {
+                options->difficulty = MEDIUM;
+            }
+            else if (options->difficulty == MEDIUM) {
+                options->difficulty = FREEPLAY_EASY;
+            }
+            else if (options->difficulty == FREEPLAY_EASY) {
+                options->difficulty = EASY;
+            }
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isResolutionIncrementHovered) {
+            // 720p -> 1080p
+            if (options->resolution.x == 1280) {
+                options->resolution.x = 1920;
+                options->resolution.y = 1080;
+            }
+            // Custom resize resolution
+            else
+            {
+                // If current resolution is less than 720p, set it to 720p
+                if (options->resolution.x < 1280 || options->resolution.y < 720) {
+                    options->resolution.x = 1280;
+                    options->resolution.y = 720;
                 }
             }
+            SetRuntimeResolution(camera, options->resolution.x, options->resolution.y);
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isResolutionDecrementHovered) {
+            // 1080p -> 720p
+            if (options->resolution.x == 1920) {
+                options->resolution.x = 1280;
+                options->resolution.y = 720;
+            }
+            // Custom resize resolution
             else {
-                cloud->position.x += cloud->speed * deltaTime;
-                // Check if the cloud has moved off the screen
-                if (cloud->position.x > baseX + BASE_SCREEN_WIDTH) {
-                    cloud->position.x = baseX - (cloud->texture.width * cloud->scale) - GetRandomDoubleValue(100, 500);
-                    cloud->position.y = GetRandomDoubleValue(baseY, 0);
+                // If current resolution is more than 1080p, set it to 1080p
+                if (options->resolution.x > 1920 || options->resolution.y > 1080) {
+                    options->resolution.x = 1920;
+                    options->resolution.y = 1080;
                 }
             }
+            SetRuntimeResolution(camera, options->resolution.x, options->resolution.y);
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isFpsIncrementHovered) {
+            // Change target FPS 30, 60, 120, 144, 240, Basically Unlimited (1000)
+            if (options->targetFps == 30) {
+                options->targetFps = 60;
+            }
+            else if (options->targetFps == 60) {
+                options->targetFps = 120;
+            }
+            else if (options->targetFps == 120) {
+                options->targetFps = 144;
+            }
+            else if (options->targetFps == 144) {
+                options->targetFps = 240;
+            }
+            else if (options->targetFps == 240) {
+                options->targetFps = 1000;
+            }
 
-            // Draw the cloud
-            DrawTexture(cloud->texture, cloud->position.x, cloud->position.y, WHITE);
+            ApplyTargetFps(options->targetFps);
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isFpsDecrementHovered) {
+            // Change target FPS 30, 60, 120, 144, 240, Basically Unlimited (1000)
+            if (options->targetFps == 60) {
+                options->targetFps = 30;
+            }
+            else if (options->targetFps == 120) {
+                options->targetFps = 60;
+            }
+            else if (options->targetFps == 144) {
+                options->targetFps = 120;
+            }
+            else if (options->targetFps == 240) {
+                options->targetFps = 144;
+            }
+            else if (options->targetFps == 1000) {
+                options->targetFps = 240;
+            }
 
-            // Debug
-            if (options->showDebug && debugToolToggles.showObjects)
+            ApplyTargetFps(options->targetFps);
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isFullscreenHovered) {
+            // Toggle fullscreen
+            options->fullscreen = !options->fullscreen;
+            SetRuntimeResolution(camera, options->resolution.x, options->resolution.y);
+            ToggleFullscreen();
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isDebugHovered) {
+            // Toggle debug
+            options->showDebug = !options->showDebug;
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isBackHovered) {
+            // Go back to main menu
+            state->isFadingOut = true;
+            PlaySoundFx(FX_SELECT);
+        }
+        else if (state->isMusicHovered) {
+            // Toggle music
+            options->musicEnabled = !options->musicEnabled;
+            PlaySoundFx(FX_SELECT);
+            if (options->musicEnabled)
+                PlayBgm(&menuBgm);
+            else
+                PauseBgm(&menuBgm);
+        }
+        else if (state->isSoundFxHovered) {
+            // Toggle sound fx
+            options->soundFxEnabled = !options->soundFxEnabled;
+            PlaySoundFx(FX_SELECT);
+        }
+    }
+
+    // Play sound when hovering over a button, but only once
+    if (!state->isFadingIn && !state->isFadingOut)
+    {
+        const bool hovered[] = {
+            state->isDifficultyIncrementHovered,
+            state->isDifficultyDecrementHovered,
+            state->isResolutionIncrementHovered,
+            state->isResolutionDecrementHovered,
+            state->isFpsIncrementHovered,
+            state->isFpsDecrementHovered,
+            state->isFullscreenHovered,
+            state->isDebugHovered,
+            state->isBackHovered,
+            state->isMusicHovered,
+            state->isSoundFxHovered
+        };
+
+        int hoveredButton = NO_BUTTON;
+        for (int i = 0; i < (int)(sizeof(hovered) / sizeof(hovered[0])); i++)
+        {
+            if (hovered[i])
             {
-                DrawRectangleLinesEx((Rectangle) { cloud->position.x, cloud->position.y, cloud->texture.width* cloud->scale, cloud->texture.height* cloud->scale }, 1, RED);
-                DrawRectangle(cloud->position.x, cloud->position.y - 20, 300, 20, Fade(GRAY, 0.7));
-                DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Speed %.2f | Scale %.2f", "Cloud", cloud->position.x, cloud->position.y, cloud->speed, cloud->scale), (Vector2) { cloud->position.x, cloud->position.y - 20 }, 20, 1, WHITE);
+                hoveredButton = i;
+                break;
             }
         }
 
+        if (hoveredButton != NO_BUTTON)
+        {
+            if (!state->isHovering || state->currentHoveredButton != hoveredButton)
+            {
+                PlaySoundFx(FX_HOVER);
+                state->isHovering = true;
+            }
+            state->currentHoveredButton = hoveredButton;
+        }
+        else
+        {
+            state->currentHoveredButton = NO_BUTTON;  // Use NO_BUTTON instead of NULL
+            state->isHovering = false;
+        }
     }
-   
-}
-
-double RandomCustomerTimeoutBasedOnDifficulty()
-{
-    switch (options->difficulty)
+    else
     {
-    case FREEPLAY_EASY:
-    case EASY:
-        return GetRandomDoubleValue(80, 150);
-        break;
-    case FREEPLAY_MEDIUM:
-    case MEDIUM:
-        return GetRandomDoubleValue(40, 60);
-        break;
-    case FREEPLAY_HARD:
-    case HARD:
-        return GetRandomDoubleValue(20, 40);
-        break;
-    default:
-        return GetRandomDoubleValue(80, 150);
-        break;
+        state->isDifficultyIncrementHovered = false;
+        state->isDifficultyDecrementHovered = false;
+        state->isResolutionIncrementHovered = false;
+        state->isResolutionDecrementHovered = false;
+        state->isFpsIncrementHovered = false;
+        state->isFpsDecrementHovered = false;
+        state->isMusicHovered = false;
+        state->isSoundFxHovered = false;
+        state->isFullscreenHovered = false;
+        state->isDebugHovered = false;
+        state->isBackHovered = false;
     }
+    if (state->firstRender)
+        state->firstRender = false;
 }
 
-void RandomCustomerInitialResetBasedOnDifficulty(double *values) {
-
-    switch (options->difficulty)
-	{
-        case FREEPLAY_EASY:
-        case EASY:
-        	values[0] = GetRandomDoubleValue(4, 6);
-        	values[1] = GetRandomDoubleValue(5, 15);
-        	values[2] = GetRandomDoubleValue(10, 25);
-        	break;
-        case FREEPLAY_MEDIUM:
-        case MEDIUM:
-        	values[0] = GetRandomDoubleValue(2, 6);
-        	values[1] = GetRandomDoubleValue(4, 10);
-        	values[2] = GetRandomDoubleValue(12, 20);
-        	break;
-        case FREEPLAY_HARD:
-        case HARD:
-        	values[0] = GetRandomDoubleValue(2, 4);
-        	values[1] = GetRandomDoubleValue(3, 6);
-        	values[2] = GetRandomDoubleValue(6, 10);
-        	break;
-        default:
-            values[0] = GetRandomDoubleValue(4, 6);
-            values[1] = GetRandomDoubleValue(5, 15);
-            values[2] = GetRandomDoubleValue(10, 25);
-        	break;
-    }
-
-
-}
+void OptionsDraw(Camera2D* camera, double deltaTime)
+{
+    OptionsState* state = &optionsScene;
+    float alpha = state->alpha;
 
+    ClearBackground(BLACK);
 
-double RandomCustomerResetBasedOnDifficulty()
-{
-    switch (options->difficulty)
-    {
-    case FREEPLAY_EASY:
-    case EASY:
-        return GetRandomDoubleValue(30, 50);
-        break;
-    case FREEPLAY_MEDIUM:
-    case MEDIUM:
-        return GetRandomDoubleValue(15, 30);
-        break;
-    case FREEPLAY_HARD:
-    case HARD:
-        return GetRandomDoubleValue(1, 10);
-        break;
-    default:
-        return GetRandomDoubleValue(30, 50);
-        break;
-    }
-}
+    int imageWidth = backgroundTexture.width;
+    int imageHeight = backgroundTexture.height;
 
-void RandomGenerateOrder(char *order)
-{
-    int random = GetRandomValue(0, 2);
-    order[0] = '\0'; // Initialize the string
+    float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
+    float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
 
-    //base case, either CP or GP
-    if (GetRandomValue(0, 1))
-        strcat(order, "CP");
-    else
-        strcat(order, "GP");
+    // Draw the background with the scaled dimensions
+    //DrawTextureEx(backgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
 
-    strcat(order, "Y");
+    BeginSpriteQueue();
 
-    // Very very small chance just to order tea without any creamer lol
-    if (GetRandomValue(0, 100) == 0)
-		return;
+    DrawDayNightCycle(deltaTime);
 
-    // another base case, either CM or MI
-    if (GetRandomValue(0, 1))
-        strcat(order, "CM");
-    else
-        strcat(order, "MI");
+    // Draw falling items behind the menu
+    DrawMenuFallingItems(deltaTime, true);
 
-    bool hasTopping = false;
-    if (random >= 1)
-    {
-        if (GetRandomValue(0, 1))
-        {
-            hasTopping = true;
-            if (GetRandomValue(0, 1))
-                strcat(order, "MA");
-            else
-                strcat(order, "WC");
-        }
-    }
-    if (hasTopping && random >= 2)
-    {
-        if (GetRandomValue(0, 1))
-        {
-            if (GetRandomValue(0, 1))
-                strcat(order, "CA");
-            else
-                strcat(order, "CH");
-        }
-    }
-    // Log the order
-    LogDebug(TextFormat("New order: %s", order));
-}
+    DrawCustomerInMenu(deltaTime);
 
+    QueueTextureEx(backgroundOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
 
-void DrawCustomer(Customer* customer)
-{
-    Vector2 pos = customer->position;
-    int frame = customer->textureType;
+    // Draw falling items in front of the menu
+    DrawMenuFallingItems(deltaTime, false);
 
-    if (customer == NULL) return;
+    EndSpriteQueue();
 
-    if (customer->visible)
-    {
+    // Music
+    DrawAtlasFrame(options->musicEnabled ? checkboxChecked : checkbox, 1, (Vector2) { state->musicRect.x + 10, state->musicRect.y + 10 }, 1.0f / 6.0f, ColorAlphaOverride(WHITE, state->isMusicHovered ? 0.75 : alpha));
+    DrawTextEx(meowFont, "Music", (Vector2) { state->musicRect.x + 80, state->musicRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, state->isMusicHovered ? 0.75 : alpha));
 
-        switch (customer->emotion)
-        {
-        case EMOTION_HAPPY:
-            DrawTextureEx(!customer->eyesClosed ? customersImageData[frame].happy : customersImageData[frame].happyEyesClosed, pos, 0.0f, 1.0f / 2.0f, WHITE);
-            break;
-        case EMOTION_FRUSTRATED:
-            DrawTextureEx(!customer->eyesClosed ? customersImageData[frame].frustrated : customersImageData[frame].frustratedEyesClosed, pos, 0.0f, 1.0f / 2.0f, WHITE);
-            break;
-        case EMOTION_ANGRY:
-            DrawTextureEx(!customer->eyesClosed ? customersImageData[frame].angry : customersImageData[frame].angryEyesClosed, pos, 0.0f, 1.0f / 2.0f, WHITE);
-            break;
-        default:
-            break;
-        }
+    // Sound FX
+    DrawAtlasFrame(options->soundFxEnabled ? checkboxChecked : checkbox, 1, (Vector2) { state->soundFxRect.x + 10, state->soundFxRect.y + 10 }, 1.0f / 6.0f, ColorAlphaOverride(WHITE, state->isSoundFxHovered ? 0.75 : alpha));
+    DrawTextEx(meowFont, "Sound FX", (Vector2) { state->soundFxRect.x + 80, state->soundFxRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, state->isSoundFxHovered ? 0.75 : alpha));
 
-    }
+    // Fullscreen
+    DrawAtlasFrame(options->fullscreen ? checkboxChecked : checkbox, 1, (Vector2) { state->fullscreenRect.x + 10, state->fullscreenRect.y + 10 }, 1.0f / 6.0f, ColorAlphaOverride(WHITE, state->isFullscreenHovered ? 0.75 : alpha));
+    DrawTextEx(meowFont, "Fullscreen", (Vector2) { state->fullscreenRect.x + 80, state->fullscreenRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, state->isFullscreenHovered ? 0.75 : alpha));
 
-    if (customer->visible && !customer->isDummy)
-    {
-        DrawTextureEx(bubbles, (Vector2) { pos.x + 350, pos.y + 100 }, 0.0f, 1.0f / 2.0f, WHITE);
+    // Debug
+    DrawAtlasFrame(options->showDebug ? checkboxChecked : checkbox, 1, (Vector2) { state->debugRect.x + 10, state->debugRect.y + 10 }, 1.0f / 6.0f, ColorAlphaOverride(WHITE, state->isDebugHovered ? 0.75 : alpha));
+    DrawTextEx(meowFont, "Debug", (Vector2) { state->debugRect.x + 80, state->debugRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, state->isDebugHovered ? 0.75 : alpha));
 
-        if (strstr(customer->order, "CPY") != NULL)
-            DrawTextureEx(cocoaChon.texture, (Vector2) { pos.x + 375, pos.y + 100 }, 0.0f, 1.0f / 2.0f, WHITE);
-        else if (strstr(customer->order, "GPY") != NULL)
-            DrawTextureEx(greenChon.texture, (Vector2) { pos.x + 375, pos.y + 100 }, 0.0f, 1.0f / 2.0f, WHITE);
+    // Difficulty
+    DrawAtlasFrame(left_arrow, 1, (Vector2) { state->difficultyDecrementRect.x, state->difficultyDecrementRect.y }, 1.0f / 5.0f, ColorAlphaOverride(WHITE, state->isDifficultyDecrementHovered ? 0.75 : alpha));
+    DrawAtlasFrame(right_arrow, 1, (Vector2) { state->difficultyIncrementRect.x, state->difficultyIncrementRect.y }, 1.0f / 5.0f, ColorAlphaOverride(WHITE, state->isDifficultyIncrementHovered ? 0.75 : alpha));
+    DrawTextEx(meowFont, "Difficulty", (Vector2) { state->difficultyRect.x + 80, state->difficultyRect.y + 10 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
+    DrawTextEx(meowFont, StringFromDifficultyEnum(options->difficulty), (Vector2) { state->difficultyRect.x + 80, state->difficultyRect.y + 42 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
 
-        if (strstr(customer->order, "CM") != NULL)
-            // DrawTextureEx(condensedMilk.texture, (Vector2) {pos.x + 425, pos.y + 100}, 0.0f, 1.0f / 2.0f, WHITE);
-            DrawTextureRec(condensedMilk.texture, condensedMilk.frameRectangle, (Vector2) { pos.x + 425, pos.y + 100 }, RAYWHITE);
-        else if (strstr(customer->order, "MI") != NULL)
-            // DrawTextureEx(normalMilk.texture, (Vector2) {pos.x + 425, pos.y + 100}, 0.0f, 1.0f / 2.0f, WHITE);
-            DrawTextureRec(normalMilk.texture, normalMilk.frameRectangle, (Vector2) { pos.x + 425, pos.y + 100 }, RAYWHITE);
+    // Resolution
+    DrawAtlasFrame(left_arrow, 1, (Vector2) { state->resolutionDecrementRect.x, state->resolutionDecrementRect.y }, 1.0f / 5.0f, ColorAlphaOverride(WHITE, state->isResolutionDecrementHovered ? 0.75 : alpha));
+    DrawAtlasFrame(right_arrow, 1, (Vector2) { state->resolutionIncrementRect.x, state->resolutionDecrementRect.y }, 1.0f / 5.0f, ColorAlphaOverride(WHITE, state->isResolutionIncrementHovered ? 0.75 : alpha));
+    DrawTextEx(meowFont, "Resolution", (Vector2) { state->resolutionRect.x + 80, state->resolutionRect.y + 10 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
+    DrawTextEx(meowFont, TextFormat("%dx%d", options->resolution.x, options->resolution.y), (Vector2) { state->resolutionRect.x + 80, state->resolutionRect.y + 42 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
 
-        if (strstr(customer->order, "MA") != NULL)
-            // DrawTextureEx(marshMellow.texture, (Vector2) {pos.x + 375, pos.y + 150}, 0.0f, 1.0f / 2.0f, WHITE);
-            DrawTextureRec(marshMellow.texture, marshMellow.frameRectangle, (Vector2) { pos.x + 375, pos.y + 150 }, RAYWHITE);
-        else if (strstr(customer->order, "WC") != NULL)
-            // DrawTextureEx(whippedCream.texture, (Vector2) {pos.x + 375, pos.y + 150}, 0.0f, 1.0f / 2.0f, WHITE);
-            DrawTextureRec(whippedCream.texture, whippedCream.frameRectangle, (Vector2) { pos.x + 375, pos.y + 150 }, RAYWHITE);
+    // FPS
+    DrawAtlasFrame(left_arrow, 1, (Vector2) { state->fpsDecrementRect.x, state->fpsDecrementRect.y }, 1.0f / 5.0f, ColorAlphaOverride(WHITE, state->isFpsDecrementHovered ? 0.75 : alpha));
+    DrawAtlasFrame(right_arrow, 1, (Vector2) { state->fpsIncrementRect.x, state->fpsDecrementRect.y }, 1.0f / 5.0f, ColorAlphaOverride(WHITE, state->isFpsIncrementHovered ? 0.75 : alpha));
+    DrawTextEx(meowFont, "Target FPS", (Vector2) { state->fpsRect.x + 80, state->fpsRect.y + 10 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
+    DrawTextEx(meowFont, TextFormat("%d FPS", options->targetFps), (Vector2) { state->fpsRect.x + 80, state->fpsRect.y + 42 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
 
-        if (strstr(customer->order, "CA") != NULL)
-            // DrawTextureEx(caramelSauce.texture, (Vector2) {pos.x + 425, pos.y + 150}, 0.0f, 1.0f / 2.0f, WHITE);
-            DrawTextureRec(caramelSauce.texture, caramelSauce.frameRectangle, (Vector2) { pos.x + 425, pos.y + 150 }, RAYWHITE);
-        else if (strstr(customer->order, "CH") != NULL)
-            // DrawTextureEx(chocolateSauce.texture, (Vector2) {pos.x + 425, pos.y + 150}, 0.0f, 1.0f / 2.0f, WHITE);
-            DrawTextureRec(chocolateSauce.texture, chocolateSauce.frameRectangle, (Vector2) { pos.x + 425, pos.y + 150 }, RAYWHITE);
-    }
 
+    // Back
+    DrawRectangleRec(state->backRect, state->isBackHovered ? ColorAlphaOverride(MAIN_ORANGE, alpha) : ColorAlphaOverride(MAIN_BROWN, alpha));
+    DrawTextEx(meowFont, "Back", (Vector2) { state->backRect.x + 60, state->backRect.y + 20 }, 32, 2, ColorAlphaOverride(WHITE, alpha));
+
+    // Draw debug
     if (options->showDebug && debugToolToggles.showObjects)
     {
-        DrawRectangleLinesEx((Rectangle) { pos.x, pos.y, customersImageData[frame].happy.width / 2, customersImageData[frame].happy.height / 2 }, 1, RED);
-        DrawRectangle(pos.x, pos.y - 20, 500, 60, Fade(GRAY, 0.7));
-        DrawTextEx(meowFont, TextFormat("%s | Blink %s (%.2f) %.2f/%.2f", StringFromCustomerEmotionEnum(customer->emotion), customer->eyesClosed ? "[Yes]" : "[No]", customer->blinkDuration, customer->blinkTimer, customer->normalDuration), (Vector2) { pos.x, pos.y - 20 }, 20, 1, WHITE);
-        if (customer->visible)
-            DrawTextEx(meowFont, TextFormat("Timeout %.2f/%.2f", (float)customer->currentTime, (float)customer->orderEnd), (Vector2) { pos.x, pos.y }, 20, 1, WHITE);
-        else
-            DrawTextEx(meowFont, TextFormat("Reset %.2f/%.2f", (float)customer->currentTime, (float)customer->resetTimer), (Vector2) { pos.x, pos.y }, 20, 1, WHITE);
-        DrawTextEx(meowFont, TextFormat("Visible %s | Order %s", customer->visible ? "[Yes]" : "[No]", customer->order), (Vector2) { pos.x, pos.y + 20 }, 20, 1, WHITE);
+        DrawRectangleLinesEx(state->difficultyRect, 1, RED);
+        DrawRectangleLinesEx(state->difficultyDecrementRect, 1, RED);
+        DrawRectangleLinesEx(state->difficultyIncrementRect, 1, RED);
+        DrawRectangleLinesEx(state->resolutionRect, 1, RED);
+        DrawRectangleLinesEx(state->resolutionDecrementRect, 1, RED);
+        DrawRectangleLinesEx(state->resolutionIncrementRect, 1, RED);
+        DrawRectangleLinesEx(state->fpsRect, 1, RED);
+        DrawRectangleLinesEx(state->fpsDecrementRect, 1, RED);
+        DrawRectangleLinesEx(state->fpsIncrementRect, 1, RED);
+
+        DrawRectangleLinesEx(state->musicRect, 1, RED);
+        DrawRectangleLinesEx(state->soundFxRect, 1, RED);
+        DrawRectangleLinesEx(state->fullscreenRect, 1, RED);
+        DrawRectangleLinesEx(state->debugRect, 1, RED);
     }
 
+    DrawOuterWorld();
 }
 
-void UpdateMenuCustomerBlink(Customer* customer, double deltaTime) {
-    customer->blinkTimer += deltaTime;
+int RandomCustomerTexture()
+{
+    int randomIndex = RandomInt(RANDOM_CUSTOMERS, 0, (int)(sizeof(customersImageData) / sizeof(customersImageData[0])) - 1);
+    return randomIndex;
+}
 
-    if (!customer->eyesClosed && customer->blinkTimer > customer->normalDuration) {
-        customer->blinkTimer = 0.0;
-        customer->eyesClosed = true;
-    }
-    else if (customer->eyesClosed && customer->blinkTimer > customer->blinkDuration) {
-        customer->blinkTimer = 0.0;
-        customer->eyesClosed = false;
-    }
+// Game scene
+
+// Drag and drop
+// Each frame the game puts everything that can be picked up or dropped on into a uniform grid over the base screen,
+// so picking and dropping only test the rectangles in the cells under the mouse or the carried sprite.
+// One controller holds the single thing being carried. Every customer of a full pool fits next to the counter items,
+// so the cost per frame grows with what is on screen but nothing is ever left out.
+#define DRAG_GRID_COLUMNS 16
+#define DRAG_GRID_ROWS 9
+#define DRAG_GRID_CELL_COUNT (DRAG_GRID_COLUMNS * DRAG_GRID_ROWS)
+#define DRAG_GRID_CELL_WIDTH ((float)BASE_SCREEN_WIDTH / DRAG_GRID_COLUMNS)
+#define DRAG_GRID_CELL_HEIGHT ((float)BASE_SCREEN_HEIGHT / DRAG_GRID_ROWS)
+#define DRAG_GRID_MAX_TARGETS (CUSTOMER_POOL_CAPACITY + INGREDIENT_COUNT + 3)  // Plus the cup stack, the cup and a spare
+
+typedef enum DragTargetKind {
+    DRAG_NONE = 0,
+    DRAG_INGREDIENT = 1,
+    DRAG_CUP = 2,
+    DRAG_CUPS_STACK = 4,    // Hands out a new cup
+    DROP_TRASH = 8,
+    DROP_CUSTOMER = 16
+} DragTargetKind;
+
+typedef struct DragTarget {
+    DragTargetKind kind;
+    int index;              // Ingredient or customer, unused otherwise
+    Rectangle bounds;
+} DragTarget;
+
+typedef struct DragGrid {
+    DragTarget targets[DRAG_GRID_MAX_TARGETS];  // In draw order, later ones are on top
+    int targetCount;
+    uint16_t cells[DRAG_GRID_CELL_COUNT][DRAG_GRID_MAX_TARGETS];
+    uint16_t cellCounts[DRAG_GRID_CELL_COUNT];
+
+    // A target spanning several cells is tested once per query, it is skipped once it holds the query's stamp
+    uint32_t testedStamps[DRAG_GRID_MAX_TARGETS];
+    uint32_t stamp;
+} DragGrid;
+
+typedef struct DragController {
+    DragGrid grid;
+    Vector2 mouse;          // World position, read once per frame
+    DragTargetKind kind;    // What is carried, DRAG_NONE when nothing is
+    int index;
+    Vector2 offset;
+    bool locked;            // The press started on nothing, ignore it until the button is released
+} DragController;
+
+static int GetDragGridColumn(float x)
+{
+    int column = (int)floorf((x - baseX) / DRAG_GRID_CELL_WIDTH);
+    return column < 0 ? 0 : (column >= DRAG_GRID_COLUMNS ? DRAG_GRID_COLUMNS - 1 : column);
 }
 
-void DrawCustomerInMenu(double deltaTime) {
-    UpdateMenuCustomerBlink(&menuCustomer1, deltaTime);
-    UpdateMenuCustomerBlink(&menuCustomer2, deltaTime);
+static int GetDragGridRow(float y)
+{
+    int row = (int)floorf((y - baseY) / DRAG_GRID_CELL_HEIGHT);
+    return row < 0 ? 0 : (row >= DRAG_GRID_ROWS ? DRAG_GRID_ROWS - 1 : row);
+}
 
-    // Update customer emotions according to difficulty
-    switch (options->difficulty)
+// Anything outside the base screen lands in the border cells, so it can still be found
+void AddDragTarget(DragGrid* grid, DragTargetKind kind, int index, Rectangle bounds)
+{
+    if (grid->targetCount >= DRAG_GRID_MAX_TARGETS)
     {
-        case FREEPLAY_EASY:
-        case EASY:
-            menuCustomer1.emotion = EMOTION_HAPPY;
-            menuCustomer2.emotion = EMOTION_HAPPY;
-            break;
-        case FREEPLAY_MEDIUM:
-        case MEDIUM:
-            menuCustomer1.emotion = EMOTION_FRUSTRATED;
-            menuCustomer2.emotion = EMOTION_FRUSTRATED;
-            break;
-        case FREEPLAY_HARD:
-        case HARD:
-            menuCustomer1.emotion = EMOTION_ANGRY;
-            menuCustomer2.emotion = EMOTION_ANGRY;
-            break;
-            break;
-        default:
-            menuCustomer1.emotion = EMOTION_HAPPY;
-            menuCustomer2.emotion = EMOTION_HAPPY;
-            break;
+        Log(LOG_WARNING, "Drag grid is full, %d targets", DRAG_GRID_MAX_TARGETS);
+        return;
     }
-    DrawCustomer(&menuCustomer1);
-    DrawCustomer(&menuCustomer2);
-}
 
-void DrawOuterWorld()
-{
-    // Draw area outside the view
-    DrawRectangle(baseX, baseY - 2000, BASE_SCREEN_WIDTH, 2000, BLACK);
-    DrawRectangle(baseX, baseY + BASE_SCREEN_HEIGHT, BASE_SCREEN_WIDTH, 2000, BLACK);
-    DrawRectangle(baseX - 2000, baseY, 2000, BASE_SCREEN_HEIGHT, BLACK);
-    DrawRectangle(baseX + BASE_SCREEN_WIDTH, baseY, 2000, BASE_SCREEN_HEIGHT, BLACK);
+    int target = grid->targetCount++;
+    grid->targets[target] = (DragTarget){ kind, index, bounds };
+
+    int minColumn = GetDragGridColumn(bounds.x);
+    int maxColumn = GetDragGridColumn(bounds.x + bounds.width);
+    int minRow = GetDragGridRow(bounds.y);
+    int maxRow = GetDragGridRow(bounds.y + bounds.height);
+
+    for (int row = minRow; row <= maxRow; row++)
+        for (int column = minColumn; column <= maxColumn; column++)
+        {
+            int cell = row * DRAG_GRID_COLUMNS + column;
+            grid->cells[cell][grid->cellCounts[cell]++] = (uint16_t)target;
+        }
 }
 
-void SetRuntimeResolution(Camera2D *camera, int screenWidth, int screenHeight)
+// Topmost target of one of the kinds under a point, -1 when none
+int FindDragTargetAt(const DragGrid* grid, Vector2 point, int kinds)
 {
-    SetWindowSize(screenWidth, screenHeight);
-    float currentAspectRatio = (float)screenWidth / (float)screenHeight;
-    float scale = (currentAspectRatio > targetAspectRatio) ? (float)screenHeight / BASE_SCREEN_HEIGHT : (float)screenWidth / BASE_SCREEN_WIDTH;
+    int cell = GetDragGridRow(point.y) * DRAG_GRID_COLUMNS + GetDragGridColumn(point.x);
 
-    camera->zoom = scale;
-    camera->offset.x = screenWidth / 2.0f;
-    camera->offset.y = screenHeight / 2.0f;
+    for (int i = grid->cellCounts[cell] - 1; i >= 0; i--)
+    {
+        const DragTarget* target = &grid->targets[grid->cells[cell][i]];
+        if ((target->kind & kinds) && CheckCollisionPointRec(point, target->bounds))
+            return grid->cells[cell][i];
+    }
 
-    options->resolution.x = screenWidth;
-    options->resolution.y = screenHeight;
+    return -1;
 }
 
-bool IsMousePositionInGameWindow(Camera2D * camera)
+// Topmost target of one of the kinds overlapping an area, or containing it whole when inside is set
+int FindDragTargetIn(DragGrid* grid, Rectangle area, int kinds, bool inside)
 {
-    Vector2 mouseWorldPos = GetScreenToWorld2D(GetMousePosition(), *camera);
-    return mouseWorldPos.x >= baseX && mouseWorldPos.x <= baseX + BASE_SCREEN_WIDTH && mouseWorldPos.y >= baseY && mouseWorldPos.y <= baseY + BASE_SCREEN_HEIGHT;
+    int minColumn = GetDragGridColumn(area.x);
+    int maxColumn = GetDragGridColumn(area.x + area.width);
+    int minRow = GetDragGridRow(area.y);
+    int maxRow = GetDragGridRow(area.y + area.height);
+
+    int found = -1;
+
+    // Stamps start over when the counter wraps, so an old stamp can never match
+    if (++grid->stamp == 0)
+    {
+        memset(grid->testedStamps, 0, sizeof(grid->testedStamps));
+        grid->stamp = 1;
+    }
+
+    for (int row = minRow; row <= maxRow; row++)
+        for (int column = minColumn; column <= maxColumn; column++)
+        {
+            int cell = row * DRAG_GRID_COLUMNS + column;
+            for (int i = 0; i < grid->cellCounts[cell]; i++)
+            {
+                int index = grid->cells[cell][i];
+                if (index <= found || grid->testedStamps[index] == grid->stamp)
+                    continue;
+                grid->testedStamps[index] = grid->stamp;
+
+                const DragTarget* target = &grid->targets[index];
+                if (!(target->kind & kinds))
+                    continue;
+
+                Rectangle bounds = target->bounds;
+                bool hit = inside
+                    ? area.x >= bounds.x && area.y >= bounds.y && area.x + area.width <= bounds.x + bounds.width && area.y + area.height <= bounds.y + bounds.height
+                    : CheckCollisionRecs(area, bounds);
+
+                if (hit)
+                    found = index;
+            }
+        }
 
+    return found;
 }
 
-void DrawDebugLogs(Camera2D* camera)
+Rectangle GetCupBounds(const Cup* cup)
 {
-    DrawRectangle(baseX, baseY + BASE_SCREEN_HEIGHT - 20 - (DEBUG_MAX_LOGS_HISTORY * 20), BASE_SCREEN_WIDTH, DEBUG_MAX_LOGS_HISTORY * 20 + 20, Fade(GRAY, 0.7));
-
-    for (int i = 0; i < DEBUG_MAX_LOGS_HISTORY; i++) {
-        int index = DEBUG_MAX_LOGS_HISTORY - i - 1;
-		if (DebugLogs[index].text != NULL) {
-			DrawTextEx(meowFont, DebugLogs[index].text, (Vector2) { baseX + 10, baseY + BASE_SCREEN_HEIGHT - 20 - (i * 20) }, 16, 1, GetTextColorFromLogType(DebugLogs[index].type));
-		}
-        else {
-			break;
-		}
-	}
+    return (Rectangle) { cup->position.x, cup->position.y, cup->region.sourceSize.x, cup->region.sourceSize.y };
 }
 
-void DrawFpsGraph(Camera2D* camera)
+Rectangle GetCustomerBounds(const Customer* customer)
 {
-    int graphWidth = DEBUG_MAX_FPS_HISTORY;
-    int graphHeight = 200;
-    int graphX = baseX + BASE_SCREEN_WIDTH - 15 - graphWidth;
-    int graphY = baseY + 25;
+    Vector2 size = GetAtlasFrameSize(customersImageData[customer->textureType].happy);
+    return (Rectangle) { customer->position.x, customer->position.y, size.x / 2, size.y / 2 };
+}
 
-    // Calculate the maximum value in the FPS history
-    float maxFpsValue = 0.0f;
-    for (int i = 0; i < DEBUG_MAX_FPS_HISTORY; i++) {
-        if (DebugFpsHistory[i] > maxFpsValue) {
-            maxFpsValue = (float)DebugFpsHistory[i];
-        }
-    }
+// Registered in draw order so the last match under the mouse is the one on top
+void BuildDragGrid(DragGrid* grid, const Cup* cup, CustomerPool* customers)
+{
+    grid->targetCount = 0;
+    memset(grid->cellCounts, 0, sizeof(grid->cellCounts));
 
-    // Adjust the scale based on the maximum value or target FPS
-    float fpsScale;
-    if ((float)options->targetFps > maxFpsValue) {
-        fpsScale = (float)graphHeight / (float)options->targetFps;
-    }
-    else {
-        fpsScale = (float)graphHeight / maxFpsValue;
+    for (int i = 0; i < customers->activeCount; i++)
+    {
+        int index = customers->active[i];
+        if (!customers->entries[index].isDummy)
+            AddDragTarget(grid, DROP_CUSTOMER, index, GetCustomerBounds(&customers->entries[index]));
     }
 
-    DrawRectangle(graphX, graphY, graphWidth, graphHeight, Fade(GRAY, 0.7));
-
-    // Draw the FPS history graph with color based on target FPS
-    for (int i = 1; i < DEBUG_MAX_FPS_HISTORY; i++) {
-        int x1 = graphX + i - 1;
-        int x2 = graphX + i;
-        int y1 = graphY + graphHeight - (DebugFpsHistory[(DebugFpsHistoryIndex + i - 1) % DEBUG_MAX_FPS_HISTORY] * fpsScale);
-        int y2 = graphY + graphHeight - (DebugFpsHistory[(DebugFpsHistoryIndex + i) % DEBUG_MAX_FPS_HISTORY] * fpsScale);
-
-        // Calculate the ratio of actual FPS to target FPS
-        float fpsRatio = (float)DebugFpsHistory[(DebugFpsHistoryIndex + i) % DEBUG_MAX_FPS_HISTORY] / (float)options->targetFps;
+    if (!cup->active)
+        AddDragTarget(grid, DRAG_CUPS_STACK, 0, (Rectangle) { oricupsPostion.x, oricupsPostion.y, cup->region.sourceSize.x, cup->region.sourceSize.y });
 
-        // Set color based on the ratio to target FPS
-        Color lineColor;
-        if (fpsRatio >= 0.9f) {
-            lineColor = GREEN; // FPS close to or exceeding target
-        }
-        else if (fpsRatio >= 0.7f) {
-            lineColor = YELLOW; // FPS above 70% of target
-        }
-        else {
-            lineColor = RED; // FPS below 70% of target
-        }
+    for (int i = 0; i < INGREDIENT_COUNT; i++)
+    {
+        int flags = ingredientTable[i].flags;
+        Rectangle bounds = GetIngredientBounds(&ingredients[i]);
 
-        DrawLine(x1, y1, x2, y2, lineColor);
+        if (flags & INGREDIENT_DRAGGABLE)
+            AddDragTarget(grid, DRAG_INGREDIENT, i, bounds);
+        else if (i == INGREDIENT_TRASH_CAN)
+            AddDragTarget(grid, DROP_TRASH, i, bounds);
     }
 
-    DrawTextEx(meowFont, "FPS", (Vector2) { baseX + BASE_SCREEN_WIDTH - 50, baseY + 5 }, 20, 2, GRAY);
-    DrawTextEx(meowFont, TextFormat("%.2f", maxFpsValue > options->targetFps ? maxFpsValue : options->targetFps), (Vector2) { graphX + 10, graphY + 10 }, 15, 2, WHITE);
-    DrawTextEx(meowFont, "0", (Vector2) { graphX + 10, graphY + graphHeight - 30 }, 15, 2, WHITE);
+    if (cup->active)
+        AddDragTarget(grid, DRAG_CUP, 0, GetCupBounds(cup));
 }
 
+void MoveDrag(DragController* drag, Cup* cup)
+{
+    Vector2 position = { drag->mouse.x - drag->offset.x, drag->mouse.y - drag->offset.y };
 
-void DrawFrameTime(Camera2D* camera) {
-    int graphWidth = DEBUG_MAX_FPS_HISTORY;
-    int graphHeight = 200;
-    int graphX = baseX + BASE_SCREEN_WIDTH - 15 - graphWidth;
-    int graphY = baseY + 255;
-
-    float targetFrameTime = 1000.0f / options->targetFps;
-
-    // Find the maximum value in the DebugFrameTimeHistory array
-    float maxFrameTime = 0.0f;
-    for (int i = 0; i < DEBUG_MAX_FPS_HISTORY; i++) {
-        if (DebugFrameTimeHistory[i] > maxFrameTime) {
-            maxFrameTime = DebugFrameTimeHistory[i];
-        }
+    if (drag->kind == DRAG_INGREDIENT)
+    {
+        ingredients[ingredientTable[drag->index].carried].position = position;
+        return;
     }
 
-    // Calculate the expected value based on the target FPS
-    float expectedFrameTime = 1000.0f / options->targetFps;
+    cup->position = position;
 
-    // Adjust the frameTimeScale based on the maximum value
-    float frameTimeScale = (maxFrameTime > 0) ? (float)graphHeight / maxFrameTime : 1.0f;
+    // Touching the trash can throws the drink away, the empty cup is carried on unseen until released
+    if (cup->active && FindDragTargetIn(&drag->grid, GetCupBounds(cup), DROP_TRASH, false) >= 0)
+    {
+        cup->contents = DRINK_EMPTY;
+        cup->active = false;
+    }
+}
 
-    DrawRectangle(graphX, graphY, graphWidth, graphHeight, Fade(GRAY, 0.7));
+void BeginDrag(DragController* drag, Cup* cup)
+{
+    int found = FindDragTargetAt(&drag->grid, drag->mouse, DRAG_INGREDIENT | DRAG_CUP | DRAG_CUPS_STACK);
+    if (found < 0)
+        return;
 
-    // Draw the frame time history graph with color based on expected value
-    for (int i = 1; i < DEBUG_MAX_FPS_HISTORY; i++) {
-        int x1 = graphX + i - 1;
-        int x2 = graphX + i;
-        int y1 = graphY + graphHeight - (DebugFrameTimeHistory[(DebugFrameTimeHistoryIndex + i - 1) % DEBUG_MAX_FPS_HISTORY] * frameTimeScale);
-        int y2 = graphY + graphHeight - (DebugFrameTimeHistory[(DebugFrameTimeHistoryIndex + i) % DEBUG_MAX_FPS_HISTORY] * frameTimeScale);
+    const DragTarget* target = &drag->grid.targets[found];
 
-        // Calculate the ratio of the frame time to the expected frame time
-        float ratioToExpected = DebugFrameTimeHistory[(DebugFrameTimeHistoryIndex + i) % DEBUG_MAX_FPS_HISTORY] / expectedFrameTime;
+    if (target->kind == DRAG_INGREDIENT)
+    {
+        const IngredientInfo* info = &ingredientTable[target->index];
+        Ingredient* item = &ingredients[target->index];
 
-        // Set color based on the ratio to expected value
-        Color lineColor;
-        if (ratioToExpected <= 1.0f) {
-            lineColor = GREEN;
-        }
-        else if (ratioToExpected <= 1.5f) {
-            lineColor = YELLOW;
+        if ((info->flags & INGREDIENT_BOILS) && !item->canChangeCupTexture)
+        {
+            PlaySoundFx(FX_FLICK);
+            boilWater(item);
+            return;
         }
-        else {
-            lineColor = RED;
+
+        Ingredient* carried = &ingredients[info->carried];
+        drag->kind = DRAG_INGREDIENT;
+        drag->offset = (Vector2){ carried->frameRectangle.width / 2, carried->frameRectangle.height / 2 };
+    }
+    else
+    {
+        // Taking a cup from the stack starts a new drink
+        if (target->kind == DRAG_CUPS_STACK)
+        {
+            SetCupCombination(cup, CUP_COMBINATION_EMPTY);
+            cup->contents = DRINK_EMPTY;
+            cup->active = true;
         }
 
-        DrawLine(x1, y1, x2, y2, lineColor);
+        drag->kind = DRAG_CUP;
+        drag->offset = (Vector2){ cup->region.sourceSize.x / 2, cup->region.sourceSize.y / 2 };
     }
 
-    DrawTextEx(meowFont, "Frame Time (ms)", (Vector2) { baseX - 135 + BASE_SCREEN_WIDTH - 50, graphY - 25 }, 20, 2, GRAY);
-    DrawTextEx(meowFont, TextFormat("%.2f", maxFrameTime > expectedFrameTime ? maxFrameTime : expectedFrameTime), (Vector2) { graphX + 10, graphY + 10 }, 15, 2, WHITE);
-    DrawTextEx(meowFont, "0", (Vector2) { graphX + 10, graphY + graphHeight - 30 }, 15, 2, WHITE);
+    drag->index = target->index;
+    MoveDrag(drag, cup);
 }
 
+// Scores the drink against the customer it was handed to
+void ServeCup(Cup* cup, CustomerPool* customers, int index)
+{
+    if (validiator(&customers->entries[index], cup->contents))
+    {
+        global_score += 50;
+        sessionStats.ordersServed++;
+        sessionStats.servedWaitTime += gameEvents.now - customers->entries[index].seatedTime;
+        PlaySoundFx(FX_CORRECT);
+        ReleaseCustomer(customers, index);
+    }
+    else
+    {
+        global_score -= 50;
+        sessionStats.wrongOrders++;
+        PlaySoundFx(FX_CONFUSED);
+    }
 
-void UpdateDebugFpsHistory() {
-    DebugFpsHistory[DebugFpsHistoryIndex] = GetFPS();
-    DebugFpsHistoryIndex = (DebugFpsHistoryIndex + 1) % DEBUG_MAX_FPS_HISTORY;
-}
-
-void UpdateDebugFrameTimeHistory() {
-	DebugFrameTimeHistory[DebugFrameTimeHistoryIndex] = GetFrameTime() * 1000;
-	DebugFrameTimeHistoryIndex = (DebugFrameTimeHistoryIndex + 1) % DEBUG_MAX_FPS_HISTORY;
+    SetCupCombination(cup, CUP_COMBINATION_EMPTY);
+    cup->contents = DRINK_EMPTY;
+    cup->active = false;
 }
 
-void DrawDebugStats(Camera2D* camera)
+void EndDrag(DragController* drag, Cup* cup, CustomerPool* customers)
 {
-    DrawRectangle(baseX, baseY, 1100, 70, Fade(GRAY, 0.7));
+    if (drag->kind == DRAG_INGREDIENT)
+    {
+        IngredientId id = (IngredientId)drag->index;
+        const IngredientInfo* info = &ingredientTable[id];
+        Ingredient* item = &ingredients[id];
+        Ingredient* carried = &ingredients[info->carried];
 
-    Color color = GREEN;
-    int fps = GetFPS();
+        bool overCup = FindDragTargetIn(&drag->grid, GetIngredientBounds(carried), DRAG_CUP, false) >= 0;
 
-    if (fps < options->targetFps * 0.7f) {
-		color = RED;
-	}
-	else if (fps < options->targetFps * 0.9f) {
-		color = YELLOW;
-	}
+        // Poured, boiling ingredients have to boil again for the next cup
+        if (overCup && item->canChangeCupTexture && UpdateCup(cup, id) && (info->flags & INGREDIENT_BOILS))
+            StopBoiling(item);
 
-    Vector2 mousePosition = GetMousePosition();
-    Vector2 mouseWorldPos = GetScreenToWorld2D(mousePosition, *camera);
+        carried->position = carried->originalPosition;
+    }
+    else if (drag->kind == DRAG_CUP)
+    {
+        // Customers only take the cup when it is let go high enough and whole inside them
+        Rectangle cupRect = { cup->position.x, cup->position.y, cup->frameRectangle.width, cup->frameRectangle.height };
+        int customer = cup->active && drag->mouse.y <= 15 ? FindDragTargetIn(&drag->grid, cupRect, DROP_CUSTOMER, true) : -1;
 
-    DrawTextEx(meowFont, TextFormat("%d FPS | Target FPS %d | Window (%dx%d) | Render (%dx%d) | Fullscreen ", fps, options->targetFps, options->resolution.x, options->resolution.y, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, options->fullscreen ? "[Yes]" : "[No]"), (Vector2) { baseX + 10, baseY + 5 }, 20, 2, color);
-    DrawTextEx(meowFont, TextFormat("Cursor %.2f,%.2f (%dx%d) | World %.2f,%.2f (%dx%d) | R Base World %.2f,%.2f", mousePosition.x, mousePosition.y, options->resolution.x, options->resolution.y, mouseWorldPos.x, mouseWorldPos.y, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, mouseWorldPos.x - baseX, mouseWorldPos.y - baseY), (Vector2) { baseX + 10, baseY + 25 }, 20, 2, WHITE);
-    DrawTextEx(meowFont, TextFormat("Zoom %.2f | In View %s", camera->zoom, IsMousePositionInGameWindow(camera) ? "[Yes]" : "[No]"), (Vector2) { baseX + 10, baseY + 45 }, 20, 2, WHITE);
+        if (customer >= 0)
+            ServeCup(cup, customers, drag->grid.targets[customer].index);
+        else
+        {
+            // Back onto the plate
+            int offset_x = 10;
+            int offset_y = -40;
+
+            cup->position.x = plate.position.x + offset_x + plate.region.sourceSize.x / 2 - cup->frameRectangle.width / 2;
+            cup->position.y = plate.position.y + offset_y + plate.region.sourceSize.y / 2 - cup->frameRectangle.height / 2;
+        }
+    }
+
+    drag->kind = DRAG_NONE;
 }
 
-void DrawDebugOverlay(Camera2D *camera)
+void UpdateDragController(DragController* drag, Cup* cup, CustomerPool* customers)
 {
-    if (options->showDebug)
+    if (!HasFrameInput(INPUT_MOUSE_LEFT_DOWN))
     {
-        // F1 - Toggle debug logs
-        if (IsKeyPressed(KEY_F1))
-        {
-            debugToolToggles.showDebugLogs = !debugToolToggles.showDebugLogs;
-        }
-        // F2 - Toggle debug stats
-        else if (IsKeyPressed(KEY_F2))
-        {
-            debugToolToggles.showStats = !debugToolToggles.showStats;
-        }
-        // F3 - Toggle debug graph
-        else if (IsKeyPressed(KEY_F3))
-        {
-            debugToolToggles.showGraph = !debugToolToggles.showGraph;
-        }
-        //  F4 - Toggle debug objects
-        else if (IsKeyPressed(KEY_F4))
-        {
-            debugToolToggles.showObjects = !debugToolToggles.showObjects;
-        }
+        if (drag->kind != DRAG_NONE)
+            EndDrag(drag, cup, customers);
+
+        drag->locked = false;
+        return;
     }
 
-    UpdateDebugFpsHistory();
-    UpdateDebugFrameTimeHistory();
-
-    DrawRectangle(baseX + BASE_SCREEN_WIDTH - 15 - 300, baseY + BASE_SCREEN_HEIGHT - 15 - 110, 300, 140, Fade(GRAY, 0.7));
-    DrawTextEx(meowFont, "Debug Tools", (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 100 }, 20, 2, WHITE);
-    DrawTextEx(meowFont, TextFormat("Logs | %s | F1", debugToolToggles.showDebugLogs ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 80 }, 20, 2, debugToolToggles.showDebugLogs ? GREEN : WHITE);
-    DrawTextEx(meowFont, TextFormat("Stats | %s | F2", debugToolToggles.showStats ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 60 }, 20, 2, debugToolToggles.showStats ? GREEN : WHITE);
-    DrawTextEx(meowFont, TextFormat("Graph | %s | F3", debugToolToggles.showGraph ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 40 }, 20, 2, debugToolToggles.showGraph ? GREEN : WHITE);
-    DrawTextEx(meowFont, TextFormat("Objects | %s | F4", debugToolToggles.showObjects ? "[On]" : "[Off]"), (Vector2) { baseX + BASE_SCREEN_WIDTH - 15 - 290, baseY + BASE_SCREEN_HEIGHT - 15 - 20 }, 20, 2, debugToolToggles.showObjects ? GREEN : WHITE);
-    
-    if (debugToolToggles.showDebugLogs)
-        DrawDebugLogs(camera);
-    if(debugToolToggles.showStats)
-        DrawDebugStats(camera);
-    if (debugToolToggles.showGraph)
+    if (drag->kind != DRAG_NONE)
     {
-        DrawFpsGraph(camera);
-        DrawFrameTime(camera);
+        MoveDrag(drag, cup);
+        return;
     }
 
+    if (!drag->locked)
+        BeginDrag(drag, cup);
+
+    // A press that picked nothing up stays dead until released
+    drag->locked = drag->kind == DRAG_NONE;
 }
 
-Customer CreateCustomerWithOrder(int patience, double currentTime, int orderEnd, Vector2 pos, int textureType, double resetTimer) {
-    Customer newCustomer = CreateCustomer(EMOTION_HAPPY, 0, 0, 0.25, true, pos, textureType, resetTimer);
-    RandomCustomerBlinkTime(&newCustomer);
+void DrawDragGrid(const DragGrid* grid)
+{
+    for (int row = 0; row < DRAG_GRID_ROWS; row++)
+        for (int column = 0; column < DRAG_GRID_COLUMNS; column++)
+        {
+            int count = grid->cellCounts[row * DRAG_GRID_COLUMNS + column];
+            if (count == 0)
+                continue;
 
-    newCustomer.currentTime = currentTime;
-    newCustomer.orderEnd = orderEnd * patience;
-	strcpy(newCustomer.order, "");
-	RandomGenerateOrder(newCustomer.order);
-    return newCustomer;
+            Rectangle cell = { baseX + column * DRAG_GRID_CELL_WIDTH, baseY + row * DRAG_GRID_CELL_HEIGHT, DRAG_GRID_CELL_WIDTH, DRAG_GRID_CELL_HEIGHT };
+            DrawRectangleLinesEx(cell, 1, Fade(YELLOW, 0.5f));
+            DrawTextEx(meowFont, TextFormat("%d", count), (Vector2) { cell.x + 4, cell.y + 4 }, 20, 1, YELLOW);
+        }
 }
 
-// void create_order(Order *order, char *first, char *second, char *third, char *fourth) {
-// 	order->first = first;
-// 	order->second = second;
-// 	order->third = third;
-// 	order->fourth = fourth;
-// }
+typedef struct GameState {
+    bool isDragging;
+    bool isDraggingOnce;
 
-// void distribute_points(Order* order, char* first, char* second, char* third, char* fourth)
-// {
-//     if (first)
-//     {
-//         global_score += 50;
-//     }
-//     if (second)
-//     {
-//         global_score += 50;
-//     }
-//     if (third)
-//     {
-//         global_score += 50;
-//     }
-//     if (fourth)
-//     {
-//         global_score += 50;
-//     }
-// }
+    bool isHovering;
+    bool hoversoundPlayed;
+
+    bool passedInitialPhrase;
+    bool isEndSceneHovered;
+
+    Cup cup;
+    AtlasRegion cups;
+    DragController drag;
+
+    CustomerPool* customers;
+    Rectangle endScene;
+
+    LayerCache counterLayer;
+    float counterLayerKey[INGREDIENT_COUNT * 4];
+} GameState;
 
-bool validiator(Customer *customer, char *order)
+GameState gameScene;
+
+bool IsIngredientIdle(Ingredient* item)
 {
-    LogDebug("Validating order: %s against %s", order, customer->order);
-	if (strcmp(customer->order, order) == 0)
-	{
-        return true;
-	}
-	else
-	{
-        return false;
-	}
+    return item->position.x == item->originalPosition.x && item->position.y == item->originalPosition.y;
 }
 
-//create customer image at either position 1 2 or 3
-void render_customers(Customers *customers)
+// The counter (overlay, plate, cups and idle ingredients) is cached unless debug outlines are drawn on top of it
+bool IsGameCounterCached()
 {
-    if(customers != NULL)  // Check the customers pointer instead of address
+    return !(options->showDebug && debugToolToggles.showObjects);
+}
+
+// Draws either the idle part of the counter, or the ingredients currently away from their spot
+void DrawGameCounter(GameState* state, bool idle)
+{
+    if (idle)
     {
-        DrawCustomer(&customers->customer1);
-        DrawCustomer(&customers->customer2);
-        DrawCustomer(&customers->customer3);
+        float scaleX = (float)BASE_SCREEN_WIDTH / backgroundOverlayTexture.width;
+        float scaleY = (float)BASE_SCREEN_HEIGHT / backgroundOverlayTexture.height;
+
+        QueueTextureEx(backgroundOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+        QueueAtlasFrame(plate.region, 1, oriplatePosition, 1.0f, WHITE);
     }
-}
 
-//Yandere dev inspired programming.
+    bool cupsDrawn = false;
 
-void RemoveCustomer(Customer *customer)
-{
-	customer->visible = false;
-    customer->currentTime = 0;
-    customer->orderEnd = 0;
-    customer->resetTimer = RandomCustomerResetBasedOnDifficulty();
-}
+    for (int i = 0; i < INGREDIENT_COUNT; i++)
+    {
+        const IngredientInfo* info = &ingredientTable[i];
+        Ingredient* item = &ingredients[i];
 
-void UpdateCustomerState(Customer* customer, float deltaTime) {
+        if (idle && !cupsDrawn && (info->flags & INGREDIENT_OVER_CUPS))
+        {
+            QueueAtlasFrame(state->cups, 1, oricupsPostion, 1.0f, WHITE);
+            cupsDrawn = true;
+        }
 
-    customer->currentTime += deltaTime;
+        // Sprites that are not on the counter only show up while carried
+        if (IsIngredientIdle(item) != idle || (idle && !(info->flags & INGREDIENT_ON_COUNTER)))
+            continue;
 
-    if (customer->visible == true) {
+        DrawDragableItemFrame(*item);
+    }
+}
 
-        if ((float)customer->currentTime < (float)customer->orderEnd) {
-            // Calculate a ratio of how close to the orderEnd the currentTime is
-            float ratio = (float)customer->currentTime / (float)customer->orderEnd;
+// Redraws the cached counter only when a hover frame, boil frame or drag state changed, or the window was resized
+void UpdateGameCounterLayer(GameState* state, Camera2D* camera)
+{
+    // Anything may have changed while the cache was bypassed
+    if (!IsGameCounterCached())
+    {
+        state->counterLayer.dirty = true;
+        return;
+    }
 
-            if (ratio > 0.75) {
-                customer->emotion = EMOTION_ANGRY;
-            }
-            else if (ratio > 0.5) {
-                customer->emotion = EMOTION_FRUSTRATED;
-            }
-            else {
-                customer->emotion = EMOTION_HAPPY;
-            }
-        }
-        else {
-            PlaySoundFx(FX_ANGRY);
-            RemoveCustomer(customer);
-            global_score -= 50;
-        }
+    float key[INGREDIENT_COUNT * 4] = { 0 };
+    for (int i = 0; i < INGREDIENT_COUNT; i++)
+    {
+        Ingredient* item = &ingredients[i];
+        if (!(ingredientTable[i].flags & INGREDIENT_ON_COUNTER))
+            continue;
+
+        key[i * 4 + 0] = item->frameRectangle.x;
+        key[i * 4 + 1] = item->frameRectangle.y;
+        key[i * 4 + 2] = (float)item->currentFrame;
+        key[i * 4 + 3] = IsIngredientIdle(item) ? 1.0f : 0.0f;
     }
-    else {
 
-        if ((float)customer->currentTime > customer->resetTimer) {
-            customer->currentTime = 0;
-            customer->orderEnd = RandomCustomerTimeoutBasedOnDifficulty();
-            customer->visible = true;
-            strcpy(customer->order, "");
-            RandomGenerateOrder(customer->order);
-        }
+    if (memcmp(key, state->counterLayerKey, sizeof(key)) != 0)
+    {
+        memcpy(state->counterLayerKey, key, sizeof(key));
+        state->counterLayer.dirty = true;
     }
+
+    if (!LayerCacheNeedsRedraw(&state->counterLayer, camera))
+        return;
+
+    BeginLayerCache(&state->counterLayer);
+    BeginSpriteQueue();
+    DrawGameCounter(state, true);
+    EndSpriteQueue();
+    EndLayerCache(&state->counterLayer);
 }
 
+void GameEnter(Camera2D *camera)
+{
+    GameState* state = &gameScene;
+
+    // The drag grid makes the state too large for a temporary on the stack
+    memset(state, 0, sizeof(*state));
+
+    // Start from night
+    currentColorIndex = 3;
+
+    dayNightCycleDuration = gameDuration * 3;
+    colorTransitionTime = 0.2f;
+
+    state->cup = (Cup){
+        .texture = cupCombinationRegions[CUP_COMBINATION_EMPTY].texture,
+        .position = (Vector2) {0, 0},
+        .contents = DRINK_EMPTY,
+        .active = false
+    };
+    SetCupCombination(&state->cup, CUP_COMBINATION_EMPTY);
+
+    // Counter sprites stay resident in the atlas, nothing to release in GameExit
+    plate = (DropArea){ GetAtlasRegion(&spriteAtlas, "spritesheets/MAT"), oriplatePosition };
+    state->cups = GetAtlasRegion(&spriteAtlas, "spritesheets/CUPS");
 
+    CreateIngredients();
 
-void Tick(Customers *customers, float deltaTime) {
-    UpdateCustomerState(&customers->customer1, deltaTime);
-    UpdateCustomerState(&customers->customer2, deltaTime);
-    UpdateCustomerState(&customers->customer3, deltaTime);
+
+    state->endScene = (Rectangle){ 770, -500, 140, 70 };
+
+    // Three seats along the counter, customers walk up on their own
+    sessionStats = (SessionStats){ 0 };
+    state->customers = &customerPool;
+    InitCustomerPool(state->customers, 3, (Vector2) { baseX + 50, baseY + 100 }, 600, 0);
 }
 
-void ResetGameState();
-void PlaySoundFx(SoundFxType type) {
-    int randomIndex = 0;
+void GameUpdate(Camera2D *camera, double deltaTime)
+{
+    GameState* state = &gameScene;
+    Cup* cup = &state->cup;
 
-    if (!options->soundFxEnabled) return;
+    // Esc key to return to main menu
+    if (HasFrameInput(INPUT_ESCAPE_PRESSED))
+    {
+        ResetGameState();
+        ChangeSceneToMainMenu(false);
+        return;
+    }
 
-    switch (type) {
-    case FX_ANGRY: {
-        Sound angrySounds[] = { angry1Fx, angry2Fx, angry3Fx, angry4Fx };
-        randomIndex = rand() % (sizeof(angrySounds) / sizeof(angrySounds[0]));
-        PlaySound(angrySounds[randomIndex]);
-        break;
+    // Mouse and hit-test rectangles for this frame, then pick up, carry or drop
+    DragController* drag = &state->drag;
+    drag->mouse = frameInput.mouse;
+    PROFILE_BEGIN("Drag");
+    BuildDragGrid(&drag->grid, cup, state->customers);
+    UpdateDragController(drag, cup, state->customers);
+    PROFILE_END();
+
+    Vector2 mousePos = drag->mouse;
+
+    bool previousIsDragging = state->isDragging;
+
+    // If something is dragged now, play sound
+    if (drag->kind != DRAG_NONE && !state->isDraggingOnce)
+    {
+        PlaySoundFx(FX_PICKUP);
+        state->isDraggingOnce = true;
     }
-    case FX_BOTTLE: {
-        Sound bottleSounds[] = { bottle1Fx, bottle2Fx, bottle3Fx };
-        randomIndex = rand() % (sizeof(bottleSounds) / sizeof(bottleSounds[0]));
-        PlaySound(bottleSounds[randomIndex]);
-        break;
+    else if (drag->kind == DRAG_NONE)
+    {
+        if (previousIsDragging != state->isDraggingOnce)
+            PlaySoundFx(FX_DROP);
+
+        state->isDraggingOnce = false;
     }
-    case FX_CONFUSED: {
-        Sound confusedSounds[] = { confused1Fx, confused2Fx, confused3Fx, confused4Fx };
-        randomIndex = rand() % (sizeof(confusedSounds) / sizeof(confusedSounds[0]));
-        PlaySound(confusedSounds[randomIndex]);
-        break;
+
+    state->isHovering = false;
+    // check mouse not down
+    if (!HasFrameInput(INPUT_MOUSE_LEFT_DOWN)) {
+        // call highlightItem for each item
+        for (int i = 0; i < INGREDIENT_COUNT; i++)
+        {
+            if (ingredientTable[i].flags & INGREDIENT_HOVERABLE)
+                state->isHovering = highlightItem(&ingredients[i], mousePos) || state->isHovering;
+        }
     }
-    case FX_CORRECT:
-        PlaySound(correctFx);
-        break;
-    case FX_DROP: {
-        Sound dropSounds[] = { drop1Fx, drop2Fx, drop3Fx };
-        randomIndex = rand() % (sizeof(dropSounds) / sizeof(dropSounds[0]));
-        PlaySound(dropSounds[randomIndex]);
-        break;
+    else {
+        state->isHovering = false;
     }
-    case FX_PICKUP: {
-        Sound pickupSounds[] = { pickup1Fx, pickup2Fx, pickup3Fx };
-        randomIndex = rand() % (sizeof(pickupSounds) / sizeof(pickupSounds[0]));
-        PlaySound(pickupSounds[randomIndex]);
-        break;
+    if (state->isHovering && !state->hoversoundPlayed) {
+
+        state->hoversoundPlayed = true;
+        //PlaySound(hover);
+
     }
-    case FX_POUR: {
-        Sound pourSounds[] = { pour1Fx, pour2Fx, pour3Fx };
-        randomIndex = rand() % (sizeof(pourSounds) / sizeof(pourSounds[0]));
-        PlaySound(pourSounds[randomIndex]);
-        break;
+    else if (!state->isHovering) {
+        state->hoversoundPlayed = false;
     }
-    case FX_STIR: {
-        Sound stirSounds[] = { stir1Fx, stir2Fx, stir3Fx };
-        randomIndex = rand() % (sizeof(stirSounds) / sizeof(stirSounds[0]));
-        PlaySound(stirSounds[randomIndex]);
-        break;
+
+    if (CheckCollisionPointRec(mousePos, (Rectangle) { cup->position.x, cup->position.y, cup->frameRectangle.width, cup->frameRectangle.height })) {
+        cup->frameRectangle = frameRectCup(*cup, 2);
     }
-    case FX_BOONG:
-        PlaySound(boongFx);
-        break;
-    case FX_HOVER:
-        PlaySound(hoverFx);
-        break;
-    case FX_SELECT:
-        PlaySound(selectFx);
-        break;
-    case FX_FLICK:
-        PlaySound(flickFx);
+    else {
+        cup->frameRectangle = frameRectCup(*cup, 1);
     }
-}
-void WindowUpdate(Camera2D* camera)
-{
-    if (IsWindowResized())
-    {
-        int screenWidth = GetScreenWidth();
-        int screenHeight = GetScreenHeight();
 
+    state->isEndSceneHovered = CheckCollisionPointRec(mousePos, state->endScene);
 
-        float currentAspectRatio = (float)screenWidth / (float)screenHeight;
-        float scale = (currentAspectRatio > targetAspectRatio) ? (float)screenHeight / BASE_SCREEN_HEIGHT : (float)screenWidth / BASE_SCREEN_WIDTH;
+    if (!state->passedInitialPhrase && currentColorIndex == 0)
+        state->passedInitialPhrase = true;
 
-        camera->zoom = scale;
-        camera->offset.x = screenWidth / 2.0f;
-        camera->offset.y = screenHeight / 2.0f;
+    bool isFreeplay = options->difficulty == FREEPLAY_EASY || options->difficulty == FREEPLAY_MEDIUM || options->difficulty == FREEPLAY_HARD;
 
-        options->resolution.x = screenWidth;
-        options->resolution.y = screenHeight;
+    // Day ended, show end scene
+    if (state->passedInitialPhrase && currentColorIndex >= 2 && !isFreeplay)
+    {
+        ChangeScene(SCENE_ENDGAME);
+        return;
     }
 
-    // Alt - Enter fullscreen
-    if (IsKeyDown(KEY_LEFT_ALT) && IsKeyPressed(KEY_ENTER) || IsKeyDown(KEY_RIGHT_ALT) && IsKeyPressed(KEY_ENTER))
+    // End game
+    if (isFreeplay && HasFrameInput(INPUT_MOUSE_LEFT_PRESSED) && state->isEndSceneHovered)
     {
-        SetRuntimeResolution(camera, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT);
-        ToggleFullscreen();
+        ChangeScene(SCENE_ENDGAME);
+        return;
     }
 
-    if(currentBgm != NULL)
-        UpdateMusicStream(*currentBgm);
+    UpdateGameCounterLayer(state, camera);
 }
 
-void LoadGlobalAssets()
+void GameDraw(Camera2D *camera, double deltaTime)
 {
-    double startTime = GetTime();
-    backgroundTexture = LoadTexture(ASSETS_PATH"image/backgrounds/main.png");
-    backgroundOverlayTexture = LoadTexture(ASSETS_PATH"image/backgrounds/main_overlay_1.png");
-    backgroundOverlaySidebarTexture = LoadTexture(ASSETS_PATH"image/backgrounds/main_overlay_2.png");
-    pawTexture = LoadTexture(ASSETS_PATH"image/elements/paw.png");
-
-    checkbox = LoadTexture(ASSETS_PATH"image/elements/checkbox.png");
-    checkboxChecked = LoadTexture(ASSETS_PATH"image/elements/checkbox_checked.png");
-    left_arrow = LoadTexture(ASSETS_PATH"image/elements/left_arrow.png");
-    right_arrow = LoadTexture(ASSETS_PATH"image/elements/right_arrow.png");
-
-	customerTexture_first_happy = LoadTexture(ASSETS_PATH"image/sprite/customer_happy.png");
-	customerTexture_second_happy = LoadTexture(ASSETS_PATH"image/sprite/customer_happy.png");
-	customerTexture_third_happy = LoadTexture(ASSETS_PATH"image/sprite/customer_happy.png");
-	customerTexture_first_normal = LoadTexture(ASSETS_PATH"image/sprite/customer_normal.png");
-	customerTexture_second_normal = LoadTexture(ASSETS_PATH"image/sprite/customer_normal.png");
-	customerTexture_third_normal = LoadTexture(ASSETS_PATH"image/sprite/customer_normal.png");
-	customerTexture_first_angry = LoadTexture(ASSETS_PATH"image/sprite/customer_angry.png");
-	customerTexture_second_angry = LoadTexture(ASSETS_PATH"image/sprite/customer_angry.png");
-	customerTexture_third_angry = LoadTexture(ASSETS_PATH"image/sprite/customer_angry.png");
-
-    hoverFx = LoadSound(ASSETS_PATH"audio/hover.wav");
-    selectFx = LoadSound(ASSETS_PATH"audio/select.wav");
-    boongFx = LoadSound(ASSETS_PATH"audio/boong.wav");
-
-    angry1Fx = LoadSound(ASSETS_PATH"audio/angry_1.wav");
-    angry2Fx = LoadSound(ASSETS_PATH"audio/angry_2.wav");
-    angry3Fx = LoadSound(ASSETS_PATH"audio/angry_3.wav");
-    angry4Fx = LoadSound(ASSETS_PATH"audio/angry_4.wav");
-
-    bottle1Fx = LoadSound(ASSETS_PATH"audio/bottle_1.wav");
-    bottle2Fx = LoadSound(ASSETS_PATH"audio/bottle_2.wav");
-    bottle3Fx = LoadSound(ASSETS_PATH"audio/bottle_3.wav");
-
-    confused1Fx = LoadSound(ASSETS_PATH"audio/confused_1.wav");
-    confused2Fx = LoadSound(ASSETS_PATH"audio/confused_2.wav");
-    confused3Fx = LoadSound(ASSETS_PATH"audio/confused_3.wav");
-    confused4Fx = LoadSound(ASSETS_PATH"audio/confused_4.wav");
-
-    correctFx = LoadSound(ASSETS_PATH"audio/correct.wav");
-
-    drop1Fx = LoadSound(ASSETS_PATH"audio/drop_1.wav");
-    drop2Fx = LoadSound(ASSETS_PATH"audio/drop_2.wav");
-    drop3Fx = LoadSound(ASSETS_PATH"audio/drop_3.wav");
-
-    pickup1Fx = LoadSound(ASSETS_PATH"audio/pickup_1.wav");
-    pickup2Fx = LoadSound(ASSETS_PATH"audio/pickup_2.wav");
-    pickup3Fx = LoadSound(ASSETS_PATH"audio/pickup_3.wav");
-
-    pour1Fx = LoadSound(ASSETS_PATH"audio/pour_1.wav");
-    pour2Fx = LoadSound(ASSETS_PATH"audio/pour_2.wav");
-    pour3Fx = LoadSound(ASSETS_PATH"audio/pour_3.wav");
-
-    stir1Fx = LoadSound(ASSETS_PATH"audio/stir_1.wav");
-    stir2Fx = LoadSound(ASSETS_PATH"audio/stir_2.wav");
-    stir3Fx = LoadSound(ASSETS_PATH"audio/stir_3.wav");
-
-    flickFx = LoadSound(ASSETS_PATH"audio/flick.wav");
-
-    menuFallingItemTextures[0] = LoadTexture(ASSETS_PATH"image/falling_items/cara.png");
-    menuFallingItemTextures[1] = LoadTexture(ASSETS_PATH"image/falling_items/cmilk.png");
-    menuFallingItemTextures[2] = LoadTexture(ASSETS_PATH"image/falling_items/cocoa.png");
-    menuFallingItemTextures[3] = LoadTexture(ASSETS_PATH"image/falling_items/gar.png");
-    menuFallingItemTextures[4] = LoadTexture(ASSETS_PATH"image/falling_items/marshmello.png");
-    menuFallingItemTextures[5] = LoadTexture(ASSETS_PATH"image/falling_items/matcha.png");
-    menuFallingItemTextures[6] = LoadTexture(ASSETS_PATH"image/falling_items/milk.png");
-    menuFallingItemTextures[7] = LoadTexture(ASSETS_PATH"image/falling_items/wcream.png");
-
-    teaPowderTexture = LoadTexture(ASSETS_PATH"/spritesheets/GP.png");
-    cocoaPowderTexture = LoadTexture(ASSETS_PATH"/spritesheets/CP.png");
-    caramelSauceTexture = LoadTexture(ASSETS_PATH"/spritesheets/CA.png");
-    chocolateSauceTexture = LoadTexture(ASSETS_PATH"/spritesheets/CH.png");
-    condensedMilkTexture = LoadTexture(ASSETS_PATH"/spritesheets/CM.png");
-    normalMilkTexture = LoadTexture(ASSETS_PATH"/spritesheets/MI.png");
-    marshMellowTexture = LoadTexture(ASSETS_PATH"/spritesheets/MA.png");
-    whippedCreamTexture = LoadTexture(ASSETS_PATH"/spritesheets/WC.png");
-    hotWaterTexture = LoadTexture(ASSETS_PATH"/spritesheets/GAR.png");
-    greenChonTexture = LoadTexture(ASSETS_PATH"/spritesheets/greenchon.png");
-    cocoaChonTexture = LoadTexture(ASSETS_PATH"/spritesheets/cocoachon.png");
-
-    trashCanTexture = LoadTexture(ASSETS_PATH"spritesheets/TRASHCAN.png");
+    GameState* state = &gameScene;
+    Cup* cup = &state->cup;
 
-    for (int i = 0; i < 3; i++)
-    {
-        customersImageData[i].happy = LoadTexture(TextFormat(ASSETS_PATH"image/sprite/customer_%d/happy.png", i + 1));
-		customersImageData[i].happyEyesClosed = LoadTexture(TextFormat(ASSETS_PATH"image/sprite/customer_%d/happy_eyes_closed.png", i + 1));
-        customersImageData[i].frustrated = LoadTexture(TextFormat(ASSETS_PATH"image/sprite/customer_%d/frustrated.png", i + 1));
-        customersImageData[i].frustratedEyesClosed = LoadTexture(TextFormat(ASSETS_PATH"image/sprite/customer_%d/frustrated_eyes_closed.png", i + 1));
-        customersImageData[i].angry = LoadTexture(TextFormat(ASSETS_PATH"image/sprite/customer_%d/angry.png", i + 1));
-        customersImageData[i].angryEyesClosed = LoadTexture(TextFormat(ASSETS_PATH"image/sprite/customer_%d/angry_eyes_closed.png", i + 1));
-	}
-
-    cloud1Texture = LoadTexture(ASSETS_PATH"image/sprite/cloud_1.png");
-    cloud2Texture = LoadTexture(ASSETS_PATH"image/sprite/cloud_2.png");
-    cloud3Texture = LoadTexture(ASSETS_PATH"image/sprite/cloud_3.png");
+    ClearBackground(BLACK);
 
-    star1Texture = LoadTexture(ASSETS_PATH"image/sprite/star_1.png");
-    star2Texture = LoadTexture(ASSETS_PATH"image/sprite/star_2.png");
-	//orders
-	bubbles = LoadTexture(ASSETS_PATH"image/elements/bubbles.png");
+    BeginSpriteQueue();
 
-	//
-
-    menuBgm = LoadMusicStream(ASSETS_PATH"audio/bgm/Yojo_Summer_My_Heart.wav");
-
-    menuCustomer1 = CreateCustomer(EMOTION_HAPPY, 2.0, 4.0, 0.25, true, (Vector2) { baseX + 650, baseY + 55 }, 1, 0);
-    menuCustomer2 = CreateCustomer(EMOTION_HAPPY, 0.4, 5.2, 0.3, true, (Vector2) { baseX + 1200, baseY + 52 }, 2, 0);
-    RandomCustomerBlinkTime(&menuCustomer1);
-    RandomCustomerBlinkTime(&menuCustomer2);
-    menuCustomer1.isDummy = true;
-    menuCustomer2.isDummy = true;
+    DrawDayNightCycle(deltaTime);
 
-    loadDurationTimer = GetTime() - startTime;
-    isGlobalAssetsLoadFinished = true;
-}
+    PROFILE_BEGIN("Customers");
+    render_customers(state->customers);
+    PROFILE_END();
 
-void UnloadGlobalAssets()
-{
-    UnloadTexture(backgroundTexture);
-    UnloadTexture(backgroundOverlayTexture);
-    UnloadTexture(backgroundOverlaySidebarTexture);
-    UnloadTexture(pawTexture);
-    UnloadFont(meowFont);
+    // Static counter from the cache, then whatever is being dragged on top of it
+    if (IsGameCounterCached())
+    {
+        FlushSpriteQueue();
+        DrawLayerCache(&state->counterLayer);
+    }
+    else
+        DrawGameCounter(state, true);
 
-    UnloadTexture(checkbox);
-	UnloadTexture(checkboxChecked);
-    UnloadTexture(left_arrow);
-    UnloadTexture(right_arrow);
+    DrawGameCounter(state, false);
 
-    UnloadSound(hoverFx);
-    UnloadSound(selectFx);
+    // DrawTexture(cup->texture, cup->position.x, cup->position.y, WHITE);
 
-    for(int i = 0; i < 8; i++)
-		UnloadTexture(menuFallingItemTextures[i]);
+    if (cup->active)
+        QueueTextureRec(cup->texture, cup->frameRectangle, cup->position, WHITE);
 
-    UnloadTexture(logoTexture);
-    UnloadTexture(splashBackgroundTexture);
-    UnloadTexture(splashOverlayTexture);
+    EndSpriteQueue();
 
-    for (int i = 0; i < 3; i++)
+    // Draw debug for cup
+    if (options->showDebug && debugToolToggles.showObjects)
     {
-        UnloadTexture(customersImageData[i].happy);
-		UnloadTexture(customersImageData[i].happyEyesClosed);
-		UnloadTexture(customersImageData[i].frustrated);
-		UnloadTexture(customersImageData[i].frustratedEyesClosed);
-		UnloadTexture(customersImageData[i].angry);
-		UnloadTexture(customersImageData[i].angryEyesClosed);
+        DrawRectangleLinesEx((Rectangle) { cup->position.x, cup->position.y, cup->frameRectangle.width, cup->frameRectangle.height }, 1, RED);
+        DrawRectangle(cup->position.x, cup->position.y - 60, 400, 60, Fade(GRAY, 0.7));
+        DrawTextEx(meowFont, TextFormat("Powder type: %d, Water: %d, Creamer: %d", GetDrinkIngredient(cup->contents, DRINK_POWDER), HasDrinkSlot(cup->contents, DRINK_WATER), GetDrinkIngredient(cup->contents, DRINK_CREAMER)), (Vector2) { cup->position.x, cup->position.y - 20 }, 20, 1, WHITE);
+        DrawTextEx(meowFont, TextFormat("Topping: %d, Sauce: %d", GetDrinkIngredient(cup->contents, DRINK_TOPPING), GetDrinkIngredient(cup->contents, DRINK_SAUCE)), (Vector2) { cup->position.x, cup->position.y - 40 }, 20, 1, WHITE);
+        DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Active %s", "Cup", cup->position.x, cup->position.y, cup->active ? "[Yes]" : "[No]"), (Vector2) { cup->position.x, cup->position.y - 60 }, 20, 1, WHITE);
+
+        // Cups
+        DrawRectangleLinesEx((Rectangle) { oricupsPostion.x, oricupsPostion.y, state->cups.sourceSize.x, state->cups.sourceSize.y }, 1, RED);
+        DrawRectangle(oricupsPostion.x, oricupsPostion.y - 20, 400, 20, Fade(GRAY, 0.7));
+        DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Grabbable %s", "Cups", oricupsPostion.x, oricupsPostion.y, cup->active ? "[No]" : "[Yes]"), (Vector2) { oricupsPostion.x, oricupsPostion.y - 20 }, 20, 1, WHITE);
+
+        DrawDragGrid(&state->drag.grid);
+
+        // Plate
+        DrawRectangleLinesEx((Rectangle) { oriplatePosition.x, oriplatePosition.y, plate.region.sourceSize.x, plate.region.sourceSize.y }, 1, RED);
+        DrawRectangle(oriplatePosition.x, oriplatePosition.y - 20, 300, 20, Fade(GRAY, 0.7));
+        DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f", "Plate", oriplatePosition.x, oriplatePosition.y), (Vector2) { oriplatePosition.x, oriplatePosition.y - 20 }, 20, 1, WHITE);
     }
 
-    UnloadMusicStream(menuBgm);
-}
+    DrawTextEx(meowFont, TextFormat("Score: %d", global_score), (Vector2) { baseX + 20, baseY + 20 }, 26, 2, WHITE);
+    if (state->customers->waitingCount > 0)
+        DrawTextEx(meowFont, TextFormat("Waiting: %d", state->customers->waitingCount), (Vector2) { baseX + 20, baseY + 50 }, 26, 2, WHITE);
 
+    DrawOuterWorld();
 
-void PlayBgm(Music *bgm)
-{
-    if (bgm == currentBgm)
+    // End game
+    if (options->difficulty == FREEPLAY_EASY || options->difficulty == FREEPLAY_MEDIUM || options->difficulty == FREEPLAY_HARD)
     {
-        if (isCurrentBgmPaused && options->musicEnabled)
-        {
-            PlayMusicStream(*bgm);
-            bgm->looping = true;
-            isCurrentBgmPaused = false;
-        }
-        return;
+        DrawRectangleRec(state->endScene, ColorAlphaOverride(RED, state->isEndSceneHovered ? 0.5f : 1.0f));
+        DrawTextEx(meowFont, "End", (Vector2) { state->endScene.x + 42, state->endScene.y + 22 }, 32, 2, ColorAlphaOverride(WHITE, state->isEndSceneHovered ? 0.5f : 1.0f));
     }
-
-    currentBgm = bgm;
-	StopMusicStream(*currentBgm);
-	PlayMusicStream(*currentBgm);
-    SetMusicVolume(*currentBgm, bgmVolume);
-    bgm->looping = true;
-    isCurrentBgmPaused = false;
 }
 
-void PlayBgmIfStopped(Music* bgm)
+void GameExit(Camera2D *camera)
 {
-    if (bgm == currentBgm)
-    {
-        if (isCurrentBgmPaused && options->musicEnabled)
-        {
-            PlayMusicStream(*bgm);
-            SetMusicVolume(*bgm, bgmVolume);
-            bgm->looping = true;
-            isCurrentBgmPaused = false;
-        }
-        return;
-    }
+    GameState* state = &gameScene;
 
-    currentBgm = bgm;
-    PlayMusicStream(*currentBgm);
-    SetMusicVolume(*currentBgm, bgmVolume);
-    bgm->looping = true;
-    isCurrentBgmPaused = false;
+    // Customers and the kettle stop with the game
+    ClearScheduler(&gameEvents);
+    UnloadLayerCache(&state->counterLayer);
 }
 
-void PauseBgm(Music *bgm)
+void ResetGameState()
 {
-	if (bgm != currentBgm) return;
-	if (isCurrentBgmPaused) return;
+    global_score = 0;
 
-	PauseMusicStream(*bgm);
-	isCurrentBgmPaused = true;
+    // Reset hotWater boiling
+    StopBoiling(&ingredients[INGREDIENT_HOT_WATER]);
 }
 
-void StopBgm(Music *bgm)
+// Endgame scene
+typedef struct EndgameState {
+    Rectangle scoreRec;
+    Rectangle tryagain;
+    float centerX;
+    float centerY;
+    bool istryagainHovered;
+} EndgameState;
+
+EndgameState endgameScene;
+
+void EndgameEnter(Camera2D *camera)
 {
-	StopMusicStream(*bgm);
-    isCurrentBgmPaused = false;
-    currentBgm = NULL;
+    EndgameState* state = &endgameScene;
+
+    state->scoreRec = (Rectangle){ -277,-241,600,450 };
+    state->centerX = state->scoreRec.x + (state->scoreRec.width / 2);
+    state->centerY = state->scoreRec.y + (state->scoreRec.height / 2);
+    state->tryagain = (Rectangle){ state->centerX - 90 , state->centerY + 50, 200, 70 };
+    state->istryagainHovered = false;
 }
 
-Color ColorAlphaOverride(Color color, float alpha)
+void EndgameUpdate(Camera2D *camera, double deltaTime)
 {
-	return (Color) { color.r, color.g, color.b, (unsigned char)(alpha * 255) };
+    EndgameState* state = &endgameScene;
+
+    Vector2 mouseWorldPos = frameInput.mouse;
+    state->istryagainHovered = CheckCollisionPointRec(mouseWorldPos, state->tryagain);
+
+    if (HasFrameInput(INPUT_MOUSE_LEFT_PRESSED) && (state->istryagainHovered))
+    {
+        ResetGameState();
+        ChangeSceneToMainMenu(false);
+    }
 }
 
-void DrawDayNightCycle(double deltaTime)
+void EndgameDraw(Camera2D *camera, double deltaTime)
 {
-    const Color dayNightColors[] = {
-        (Color){173, 216, 230, 255},  // Morning (Anime Light Blue)
-        (Color){0, 102, 204, 255},    // Afternoon (Anime Blue)
-        (Color){245, 161, 59, 255},    // Evening (Anime Orange)
-        (Color){0, 0, 102, 255}       // Night (Anime Dark Blue)
-    };
+    EndgameState* state = &endgameScene;
 
-    float colorTransitionSpeed = (float)(sizeof(dayNightColors) / sizeof(dayNightColors[0])) / dayNightCycleDuration;
+    int imageWidth = backgroundTexture.width;
+    int imageHeight = backgroundTexture.height;
 
-    // Determine the color to interpolate from and to
-    int fromColorIndex = currentColorIndex;
-    int toColorIndex = (currentColorIndex + 1) % (sizeof(dayNightColors) / sizeof(dayNightColors[0]));
+    float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
+    float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
 
-    // Calculate the interpolation factor (0 to 1) based on colorTransitionTime
-    float t = fmin(colorTransitionTime, 1.0f);
+    ClearBackground(RAYWHITE);
 
-    // Interpolate between the colors
-    Color fromColor = dayNightColors[fromColorIndex];
-    Color toColor = dayNightColors[toColorIndex];
-    Color currentColor = ColorLerp(fromColor, toColor, t);
+    DrawTextureEx(backgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+    DrawRectangleRec(state->scoreRec, MAIN_BROWN);
+    DrawRectangleLinesEx((Rectangle) {-217,-195, 480, 360}, 5, WHITE);
 
-    // Draw the day/night color overlay with the scaled dimensions
-    DrawRectangle(baseX, baseY, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, currentColor);
+    Vector2 scorePos;
+    scorePos.x = state->centerX - (MeasureText("Score", 55) / 2);
+    scorePos.y = state->centerY - 150;
+    DrawTextEx(meowFont, "Score", scorePos, 55, 2, WHITE);
 
-    // Draw moving clouds
-    DrawMovingCloudAndStar(deltaTime);
+    const char *scoreText = TextFormat("%d", global_score);
+    Vector2 scoreTextPos;
+    scoreTextPos.x = state->centerX - (MeasureText(scoreText, 100) / 2);
+    scoreTextPos.y = state->centerY - 80;
+    DrawTextEx(meowFont, scoreText, scoreTextPos, 100, 2, WHITE);
 
-    // Draw day/night cycle debug overlay
-    if (options->showDebug && debugToolToggles.showObjects)
+    DrawRectangleRec(state->tryagain, ColorAlphaOverride(RED, state->istryagainHovered ? 0.5f : 1.0f));
+    DrawTextEx(meowFont, "Menu", (Vector2) {-10,55}, 32, 2, ColorAlphaOverride(WHITE, state->istryagainHovered ? 0.5f : 1.0f));
+}
+
+// Input recording
+// MEOW_RECORD=<file> writes the seed and the input of every frame, MEOW_REPLAY=<file> feeds it back through the same
+// code, at the recorded pace or as fast as possible with MEOW_REPLAY_FAST=1. The session starts when the main menu
+// first appears, the loading before it depends on disk and thread timing. Each frame also stores a hash of the
+// game state, the replay reports the first frame where its own hash differs.
+//
+// Layout, native endianness:
+//   InputRecordingHeader
+//   InputRecordingFrame for every frame
+#define INPUT_RECORDING_MAGIC "MEOWREC"
+#define INPUT_RECORDING_VERSION 2
+
+typedef struct InputRecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t seed;
+} InputRecordingHeader;
+
+typedef struct InputRecordingFrame {
+    double deltaTime;
+    float mouseX;
+    float mouseY;
+    uint32_t flags;
+    uint32_t stateHash;     // After the frame's update
+} InputRecordingFrame;
+
+typedef enum InputMode {
+    INPUT_LIVE,
+    INPUT_RECORDING,
+    INPUT_REPLAYING
+} InputMode;
+
+typedef struct InputRecorder {
+    InputMode mode;
+    FILE* file;
+    uint32_t seed;
+    bool started;
+    int frame;
+    uint32_t expectedHash;  // Of the frame being replayed
+    int firstMismatch;      // -1 while every replayed hash matched
+} InputRecorder;
+
+InputRecorder inputRecorder = { .mode = INPUT_LIVE, .firstMismatch = -1 };
+
+uint32_t HashBytes(uint32_t hash, const void* data, size_t size)
+{
+    // FNV-1a
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+// Everything a replay has to reproduce: scene, score, clock, customers and the cup
+uint32_t HashGameState()
+{
+    uint32_t hash = 2166136261u;
+    hash = HashBytes(hash, &currentScene, sizeof(currentScene));
+    hash = HashBytes(hash, &global_score, sizeof(global_score));
+    hash = HashBytes(hash, &gameEvents.now, sizeof(gameEvents.now));
+    hash = HashBytes(hash, &gameEvents.count, sizeof(gameEvents.count));
+    hash = HashBytes(hash, &currentColorIndex, sizeof(currentColorIndex));
+    hash = HashBytes(hash, &gameScene.cup.contents, sizeof(gameScene.cup.contents));
+    hash = HashBytes(hash, &gameScene.drag.kind, sizeof(gameScene.drag.kind));
+    hash = HashBytes(hash, &customerPool.waitingCount, sizeof(customerPool.waitingCount));
+
+    for (int i = 0; i < customerPool.activeCount; i++)
     {
-        DrawRectangle(baseX + 500, baseY + 25, 400, 20, Fade(GRAY, 0.7));
-        DrawTextEx(meowFont, TextFormat("Time %.2f/%.2f | Phrase %d/%d", colorTransitionTime * dayNightCycleDuration, dayNightCycleDuration, currentColorIndex + 1, (sizeof(dayNightColors) / sizeof(dayNightColors[0]))), (Vector2) { baseX + BASE_SCREEN_WIDTH - 500, baseY + 25 }, 20, 2, WHITE);
+        const Customer* customer = &customerPool.entries[customerPool.active[i]];
+        hash = HashBytes(hash, &customer->slot, sizeof(customer->slot));
+        hash = HashBytes(hash, &customer->order, sizeof(customer->order));
+        hash = HashBytes(hash, &customer->emotion, sizeof(customer->emotion));
+        hash = HashBytes(hash, &customer->orderEnd, sizeof(customer->orderEnd));
     }
 
-    // Update the colorTransitionTime
-    if (colorTransitionTime >= 1.0f)
+    return hash;
+}
+
+// Reads MEOW_RECORD or MEOW_REPLAY, the game stays live when neither is set or the file cannot be used
+void OpenInputRecorder()
+{
+    const char* recordPath = getenv("MEOW_RECORD");
+    const char* replayPath = getenv("MEOW_REPLAY");
+
+    if (replayPath != NULL)
     {
-        currentColorIndex = toColorIndex;
-        colorTransitionTime = 0;
+        InputRecordingHeader header;
+        FILE* file = fopen(replayPath, "rb");
+        if (file == NULL || fread(&header, sizeof(header), 1, file) != 1
+            || memcmp(header.magic, INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC)) != 0 || header.version != INPUT_RECORDING_VERSION)
+        {
+            Log(LOG_WARNING, "Cannot replay %s, it is missing or not an input recording", replayPath);
+            if (file != NULL)
+                fclose(file);
+            return;
+        }
+
+        inputRecorder.mode = INPUT_REPLAYING;
+        inputRecorder.file = file;
+        inputRecorder.seed = header.seed;
+        Log(LOG_INFO, "Replaying %s, seed %u", replayPath, header.seed);
     }
-    else
+    else if (recordPath != NULL)
     {
-        colorTransitionTime += GetFrameTime() * colorTransitionSpeed;
+        FILE* file = fopen(recordPath, "wb");
+        InputRecordingHeader header = { 0 };
+        memcpy(header.magic, INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC));
+        header.version = INPUT_RECORDING_VERSION;
+        header.seed = (uint32_t)time(NULL);
+
+        if (file == NULL || fwrite(&header, sizeof(header), 1, file) != 1)
+        {
+            Log(LOG_WARNING, "Cannot record input to %s", recordPath);
+            if (file != NULL)
+                fclose(file);
+            return;
+        }
+
+        inputRecorder.mode = INPUT_RECORDING;
+        inputRecorder.file = file;
+        inputRecorder.seed = header.seed;
+        Log(LOG_INFO, "Recording input to %s, seed %u", recordPath, header.seed);
     }
 }
 
-void OptionsUpdate(Camera2D* camera)
+// Seeds the random streams the first time the main menu is entered. Loading takes as long as the disk and the
+// loader threads need, so the session also restarts the scheduler clock and drops what loading scheduled. Both menu
+// customers drew their blink timing before the seed, they draw it again. MainMenuEnter starts their blinks after this.
+void StartInputSession()
 {
-    int currentHoveredButton = NO_BUTTON;
-    Rectangle difficultyRect = { baseX + 780, baseY + 595, 340, 70 };
-    Rectangle difficultyDecrementRect = { difficultyRect.x, difficultyRect.y, 60, 70 };
-    Rectangle difficultyIncrementRect = { difficultyRect.x + 280, difficultyRect.y, 60, 70 };
-    
-    Rectangle resolutionRect = { baseX + 780, baseY + 675, 340, 70 };
-    Rectangle resolutionDecrementRect = { resolutionRect.x, resolutionRect.y, 60, 70 };
-    Rectangle resolutionIncrementRect = { resolutionRect.x + 280, resolutionRect.y, 60, 70 };
+    if (inputRecorder.mode == INPUT_LIVE || inputRecorder.started)
+        return;
 
-    Rectangle fpsRect = { baseX + 1200, baseY + 595, 340, 70 };
-    Rectangle fpsDecrementRect = { fpsRect.x, fpsRect.y, 60, 70 };
-    Rectangle fpsIncrementRect = { fpsRect.x + 280, fpsRect.y, 60, 70 };
+    inputRecorder.started = true;
+    SeedRandomStreams(inputRecorder.seed);
 
-    Rectangle musicRect = { baseX + 100, baseY + 595, 200, 70 };
-    Rectangle soundFxRect = { baseX + 100, baseY + 675, 250, 70 };
+    ClearScheduler(&gameEvents);
+    gameEvents.now = 0;
 
-    Rectangle fullscreenRect = { baseX + 400, baseY + 595, 300, 70 };
-    Rectangle debugRect = { baseX + 400, baseY + 675, 200, 70 };
+    RandomCustomerBlinkTime(&menuCustomer1);
+    RandomCustomerBlinkTime(&menuCustomer2);
+}
 
-    Rectangle backRect = { baseX + 100, baseY + 840, 200, 70 };
+void CloseInputRecorder()
+{
+    if (inputRecorder.file == NULL)
+        return;
 
-    bool firstRender = true;
-    double lastFrameTime = GetTime();
+    if (inputRecorder.mode == INPUT_RECORDING)
+        Log(LOG_INFO, "Recorded %d frames, score %d, state hash %08x", inputRecorder.frame, global_score, HashGameState());
+    else if (inputRecorder.firstMismatch >= 0)
+        Log(LOG_WARNING, "Replayed %d frames, score %d, state hash %08x, diverged from the recording at frame %d", inputRecorder.frame, global_score, HashGameState(), inputRecorder.firstMismatch);
+    else
+        Log(LOG_INFO, "Replayed %d frames, score %d, state hash %08x, matches the recording", inputRecorder.frame, global_score, HashGameState());
 
-    bool isHovering = false;
+    fclose(inputRecorder.file);
+    inputRecorder.file = NULL;
+}
 
-    float alpha = 0.0f;
-    double fadeInDuration = 0.35;
-    double fadeOutDuration = 0.35;
-    bool isFadingIn = true;
-    bool isFadingOut = false;
+bool UpdateAutoplayer(double deltaTime);
 
-    PlayBgmIfStopped(&menuBgm);
+// Fills frameInput for this frame, from the recording while replaying, from the autoplayer when it is on
+void UpdateFrameInput(Camera2D* camera, double deltaTime)
+{
+    if (inputRecorder.mode != INPUT_REPLAYING || !inputRecorder.started)
+    {
+        if (!UpdateAutoplayer(deltaTime))
+            CaptureFrameInput(camera, deltaTime);
+        return;
+    }
 
-    while (!WindowShouldClose())
+    InputRecordingFrame record;
+    if (inputRecorder.file == NULL || fread(&record, sizeof(record), 1, inputRecorder.file) != 1)
     {
-        // Calculate delta time
-        double deltaTime = GetTime() - lastFrameTime;
-        lastFrameTime = GetTime();
+        // End of the recording
+        frameInput = (FrameInput){ deltaTime, frameInput.mouse, 0 };
+        CloseInputRecorder();
+        ExitApplication();
+        return;
+    }
 
-        WindowUpdate(camera);
+    frameInput.deltaTime = record.deltaTime;
+    frameInput.mouse = (Vector2){ record.mouseX, record.mouseY };
+    frameInput.flags = record.flags;
+    inputRecorder.expectedHash = record.stateHash;
+}
 
-        if (isFadingIn)
-		{
-			alpha += deltaTime / fadeInDuration;
-			if (alpha >= 1.0f)
-			{
-				alpha = 1.0f;
-				isFadingIn = false;
-			}
-		}
+// Writes or checks the frame once the scene has updated
+void FinishInputFrame()
+{
+    if (inputRecorder.file == NULL || !inputRecorder.started)
+        return;
 
-	    if (isFadingOut)
-        {
-            alpha -= deltaTime / fadeOutDuration;
-            if (alpha <= 0.0f)
-            {
-                alpha = 0.0f;
-                isFadingOut = false;
-                MainMenuUpdate(camera, false);
-            }
-        }
+    uint32_t hash = HashGameState();
 
-        Vector2 mouseWorldPos = GetScreenToWorld2D(GetMousePosition(), *camera);
-
-        bool isDifficultyIncrementHovered = CheckCollisionPointRec(mouseWorldPos, difficultyIncrementRect);
-        bool isDifficultyDecrementHovered = CheckCollisionPointRec(mouseWorldPos, difficultyDecrementRect);
-        
-        bool isResolutionIncrementHovered = CheckCollisionPointRec(mouseWorldPos, resolutionIncrementRect);
-        bool isResolutionDecrementHovered = CheckCollisionPointRec(mouseWorldPos, resolutionDecrementRect);
-
-        bool isFpsIncrementHovered = CheckCollisionPointRec(mouseWorldPos, fpsIncrementRect);
-        bool isFpsDecrementHovered = CheckCollisionPointRec(mouseWorldPos, fpsDecrementRect);
-        
-        bool isMusicHovered = CheckCollisionPointRec(mouseWorldPos, musicRect);
-        bool isSoundFxHovered = CheckCollisionPointRec(mouseWorldPos, soundFxRect);
-        bool isFullscreenHovered = CheckCollisionPointRec(mouseWorldPos, fullscreenRect);
-        bool isDebugHovered = CheckCollisionPointRec(mouseWorldPos, debugRect);
-
-        bool isBackHovered = CheckCollisionPointRec(mouseWorldPos, backRect);
-
-        // Handle user input
-        if (!firstRender && IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !isFadingIn && !isFadingOut) {
-            if (isDifficultyIncrementHovered) {
-                if (options->difficulty == EASY) {
-					options->difficulty = FREEPLAY_EASY;
-				}
-                else if (options->difficulty == FREEPLAY_EASY) {
-                    options->difficulty = MEDIUM;
-                }
-                else if (options->difficulty == MEDIUM) {
-                    options->difficulty = FREEPLAY_MEDIUM;
-                }
-                else if (options->difficulty == FREEPLAY_MEDIUM) {
-                    options->difficulty = HARD;
-                }
-                else if (options->difficulty == HARD) {
-                    options->difficulty = FREEPLAY_HARD;
-                }
-                PlaySoundFx(FX_SELECT);
-            }
-            else if (isDifficultyDecrementHovered) {
-                if (options->difficulty == FREEPLAY_HARD) {
-                    options->difficulty = HARD;
-                }
-                else if (options->difficulty == HARD) {
-                    options->difficulty = FREEPLAY_MEDIUM;
-                }
-                else if (options->difficulty == FREEPLAY_MEDIUM) {
-                    options->difficulty = MEDIUM;
-                }
-				else if (options->difficulty == MEDIUM) {
-                    options->difficulty = FREEPLAY_EASY;
-				}
-                else if (options->difficulty == FREEPLAY_EASY) {
-                    options->difficulty = EASY;
-				}
-                PlaySoundFx(FX_SELECT);
-			}
-            else if (isResolutionIncrementHovered) {
-                // 720p -> 1080p
-                if (options->resolution.x == 1280) {
-                    options->resolution.x = 1920;
-                    options->resolution.y = 1080;
-                }
-                // Custom resize resolution
-				else
-				{
-                    // If current resolution is less than 720p, set it to 720p
-                    if (options->resolution.x < 1280 || options->resolution.y < 720) {
-						options->resolution.x = 1280;
-						options->resolution.y = 720;
-					}
-				}
-                SetRuntimeResolution(camera, options->resolution.x, options->resolution.y);
-                PlaySoundFx(FX_SELECT);
-            }
-            else if (isResolutionDecrementHovered) {
-                // 1080p -> 720p
-                if (options->resolution.x == 1920) {
-					options->resolution.x = 1280;
-					options->resolution.y = 720;
-				}
-                // Custom resize resolution
-                else {
-                    // If current resolution is more than 1080p, set it to 1080p
-                    if (options->resolution.x > 1920 || options->resolution.y > 1080) {
-                        options->resolution.x = 1920;
-                        options->resolution.y = 1080;
-                    }
-                }
-                SetRuntimeResolution(camera, options->resolution.x, options->resolution.y);
-                PlaySoundFx(FX_SELECT);
-            }
-            else if (isFpsIncrementHovered) {
-                // Change target FPS 30, 60, 120, 144, 240, Basically Unlimited (1000)
-                if (options->targetFps == 30) {
-                    options->targetFps = 60;
-                }
-                else if (options->targetFps == 60) {
-                    options->targetFps = 120;
-                }
-                else if (options->targetFps == 120) {
-                    options->targetFps = 144;
-                }
-                else if (options->targetFps == 144) {
-                    options->targetFps = 240;
-                }
-                else if (options->targetFps == 240) {
-                    options->targetFps = 1000;
-                }
+    if (inputRecorder.mode == INPUT_RECORDING)
+    {
+        InputRecordingFrame record = { frameInput.deltaTime, frameInput.mouse.x, frameInput.mouse.y, frameInput.flags, hash };
+        fwrite(&record, sizeof(record), 1, inputRecorder.file);
+    }
+    else if (hash != inputRecorder.expectedHash && inputRecorder.firstMismatch < 0)
+    {
+        inputRecorder.firstMismatch = inputRecorder.frame;
+        Log(LOG_WARNING, "Replay diverged at frame %d, state hash %08x instead of %08x", inputRecorder.frame, hash, inputRecorder.expectedHash);
+    }
 
-                SetTargetFPS(options->targetFps);
-                PlaySoundFx(FX_SELECT);
-            }
-            else if (isFpsDecrementHovered) {
-                // Change target FPS 30, 60, 120, 144, 240, Basically Unlimited (1000)
-                if (options->targetFps == 60) {
-                    options->targetFps = 30;
-                }
-                else if (options->targetFps == 120) {
-                    options->targetFps = 60;
-                }
-                else if (options->targetFps == 144) {
-                    options->targetFps = 120;
-                }
-                else if (options->targetFps == 240) {
-                    options->targetFps = 144;
-                }
-                else if (options->targetFps == 1000) {
-					options->targetFps = 240;
-				}
+    inputRecorder.frame++;
+}
 
-                SetTargetFPS(options->targetFps);
-                PlaySoundFx(FX_SELECT);
-            }
-            else if (isFullscreenHovered) {
-                // Toggle fullscreen
-                options->fullscreen = !options->fullscreen;
-                SetRuntimeResolution(camera, options->resolution.x, options->resolution.y);
-                ToggleFullscreen();
-                PlaySoundFx(FX_SELECT);
-            }
-            else if (isDebugHovered) {
-				// Toggle debug
-				options->showDebug = !options->showDebug;
-                PlaySoundFx(FX_SELECT);
-			}
-			else if (isBackHovered) {
-				// Go back to main menu
-                isFadingOut = true;
-                PlaySoundFx(FX_SELECT);
-			}
-		    else if (isMusicHovered) {
-				// Toggle music
-				options->musicEnabled = !options->musicEnabled;
-                PlaySoundFx(FX_SELECT);
-                if (options->musicEnabled)
-                    PlayBgm(&menuBgm);
-				else
-                    PauseBgm(&menuBgm);
-			}
-			else if (isSoundFxHovered) {
-				// Toggle sound fx
-				options->soundFxEnabled = !options->soundFxEnabled;
-                PlaySoundFx(FX_SELECT);
-			}
-        }
-
-        // Play sound when hovering over a button, but only once
-        if (!isFadingIn && !isFadingOut)
-        {
-            if (isDifficultyIncrementHovered)
-            {
-                if (!isHovering || currentHoveredButton != 0)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 0;
-            }
-            else if (isDifficultyDecrementHovered)
-            {
-                if (!isHovering || currentHoveredButton != 1)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 1;
-            }
-            else if (isResolutionIncrementHovered)
-            {
-                if (!isHovering || currentHoveredButton != 2)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 2;
-            }
-            else if (isResolutionDecrementHovered)
-            {
-                if (!isHovering || currentHoveredButton != 3)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 3;
-            }
-            else if (isFpsIncrementHovered)
-            {
-                if (!isHovering || currentHoveredButton != 4)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 4;
-            }
-            else if (isFpsDecrementHovered)
-            {
-                if (!isHovering || currentHoveredButton != 5)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 5;
-            }
-            else if (isFullscreenHovered)
-            {
-                if (!isHovering || currentHoveredButton != 6)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 6;
-            }
-            else if (isDebugHovered)
-            {
-                if (!isHovering || currentHoveredButton != 7)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 7;
-            }
-            else if (isBackHovered)
-            {
-                if (!isHovering || currentHoveredButton != 8)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 8;
-            }
-            else if (isMusicHovered)
-            {
-                if (!isHovering || currentHoveredButton != 9)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 9;
-            }
-            else if (isSoundFxHovered)
-            {
-                if (!isHovering || currentHoveredButton != 10)
-                {
-                    PlaySoundFx(FX_HOVER);
-                    isHovering = true;
-                }
-                currentHoveredButton = 10;
-            }
-            else
-            {
-                currentHoveredButton = NO_BUTTON;  // Use NO_BUTTON instead of NULL
-                isHovering = false;
-            }
-        }
-        else
-        {
-            isDifficultyIncrementHovered = false;
-            isDifficultyDecrementHovered = false;
-            isResolutionIncrementHovered = false;
-            isResolutionDecrementHovered = false;
-            isFpsIncrementHovered = false;
-            isFpsDecrementHovered = false;
-            isMusicHovered = false;
-            isSoundFxHovered = false;
-            isFullscreenHovered = false;
-            isDebugHovered = false;
-            isBackHovered = false;
-        }
-        if (firstRender)
-            firstRender = false;
+// Main menu scene
+typedef struct MainMenuState {
+    bool playFade;
+    int currentHoveredButton;
+    float fadeOutDuration;
+    double currentTime;
+    bool isHovering;
+    SceneType transitionTarget;
 
-        // Draw
+    float transitionOffset;
 
-        BeginDrawing();
-        ClearBackground(BLACK);
+    bool isFadeOutDone;
+    bool isTransitioningIn;
+    bool isTransitioningOut;
 
+    Rectangle startButtonRect;
+    Rectangle optionsButtonRect;
+    Rectangle exitButtonRect;
 
-        BeginMode2D(*camera);
+    bool isStartButtonHovered;
+    bool isOptionsButtonHovered;
+    bool isExitButtonHovered;
+} MainMenuState;
 
-        int imageWidth = backgroundTexture.width;
-        int imageHeight = backgroundTexture.height;
+MainMenuState mainMenuScene;
 
-        float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
-        float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
+void ChangeSceneToMainMenu(bool playFade)
+{
+    mainMenuScene.playFade = playFade;
+    ChangeScene(SCENE_MAIN_MENU);
+}
 
-        // Draw the background with the scaled dimensions
-        //DrawTextureEx(backgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+void MainMenuEnter(Camera2D* camera)
+{
+    MainMenuState* state = &mainMenuScene;
+    bool playFade = state->playFade;
 
-        DrawDayNightCycle(deltaTime);
+    StartInputSession();
 
-        // Draw falling items behind the menu
-        DrawMenuFallingItems(deltaTime, true);
+    *state = (MainMenuState){ 0 };
+    state->playFade = playFade;
+    state->currentHoveredButton = NO_BUTTON;
+    state->fadeOutDuration = 1.0f;
 
-        DrawCustomerInMenu(deltaTime);
+    StartCustomerBlink(&menuCustomer1);
+    StartCustomerBlink(&menuCustomer2);
+    state->transitionTarget = SCENE_NONE;
 
-        DrawTextureEx(backgroundOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+    state->isFadeOutDone = false;
+    state->isTransitioningIn = !playFade;
+    state->isTransitioningOut = false;
 
-        // Draw falling items in front of the menu
-        DrawMenuFallingItems(deltaTime, false);
+    if (state->isTransitioningIn)
+        state->transitionOffset = BASE_SCREEN_WIDTH / 2;
 
-        // Music
-        DrawTextureEx(options->musicEnabled ? checkboxChecked : checkbox, (Vector2) { musicRect.x + 10, musicRect.y + 10 }, 0.0f, 1.0f / 6.0f, ColorAlphaOverride(WHITE, isMusicHovered ? 0.75 : alpha));
-		DrawTextEx(meowFont, "Music", (Vector2) { musicRect.x + 80, musicRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, isMusicHovered ? 0.75 : alpha));
+    trashCanPosition = (Vector2){baseX , baseY + BASE_SCREEN_HEIGHT - 200};
 
-        // Sound FX
-        DrawTextureEx(options->soundFxEnabled ? checkboxChecked : checkbox, (Vector2) { soundFxRect.x + 10, soundFxRect.y + 10 }, 0.0f, 1.0f / 6.0f, ColorAlphaOverride(WHITE, isSoundFxHovered ? 0.75 : alpha));
-        DrawTextEx(meowFont, "Sound FX", (Vector2) { soundFxRect.x + 80, soundFxRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, isSoundFxHovered ? 0.75 : alpha));
+    PlayBgmIfStopped(&menuBgm);
 
-        // Fullscreen
-        DrawTextureEx(options->fullscreen ? checkboxChecked : checkbox, (Vector2) { fullscreenRect.x + 10, fullscreenRect.y + 10 }, 0.0f, 1.0f / 6.0f, ColorAlphaOverride(WHITE, isFullscreenHovered ? 0.75 : alpha));
-        DrawTextEx(meowFont, "Fullscreen", (Vector2) { fullscreenRect.x + 80, fullscreenRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, isFullscreenHovered ? 0.75 : alpha));
+    if (playFade)
+    {
+        movingClouds[0] = (MovingCloud){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), RandomDouble(RANDOM_VISUALS, baseY, 0) }, 250.0f, 1.0f, cloud1Texture, false };
+        movingClouds[1] = (MovingCloud){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), RandomDouble(RANDOM_VISUALS, baseY, 0) }, 200.0f, 1.0f, cloud2Texture, false };
+        movingClouds[2] = (MovingCloud){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), RandomDouble(RANDOM_VISUALS, baseY, 0) }, 150.0f, 2.0f, cloud3Texture, true };
+        movingClouds[3] = (MovingCloud){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), RandomDouble(RANDOM_VISUALS, baseY, 0) }, 250.0f, 1.0f, cloud1Texture, false };
+        movingClouds[4] = (MovingCloud){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), RandomDouble(RANDOM_VISUALS, baseY, 0) }, 100.0f, 1.7f, cloud2Texture, false };
+        movingClouds[5] = (MovingCloud){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), RandomDouble(RANDOM_VISUALS, baseY, 0) }, 200.0f, 1.0f, cloud3Texture, true };
+        movingClouds[6] = (MovingCloud){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), RandomDouble(RANDOM_VISUALS, baseY, 0) }, 150.0f, 1.0f, cloud3Texture, true };
 
-        // Debug
-        DrawTextureEx(options->showDebug ? checkboxChecked : checkbox, (Vector2) { debugRect.x + 10, debugRect.y + 10 }, 0.0f, 1.0f / 6.0f, ColorAlphaOverride(WHITE, isDebugHovered ? 0.75 : alpha));
-		DrawTextEx(meowFont, "Debug", (Vector2) { debugRect.x + 80, debugRect.y + 22 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, isDebugHovered ? 0.75 : alpha));
+        movingStars[0] = (MovingStar){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), baseY }, 50.0f, 3.0f, star1Texture };
+        movingStars[1] = (MovingStar){ (Vector2) { RandomDouble(RANDOM_VISUALS, baseX - 200, baseX), baseY }, 25.0f, 2.0f, star2Texture };
 
-        // Difficulty
-        DrawTextureEx(left_arrow, (Vector2) { difficultyDecrementRect.x , difficultyDecrementRect.y}, 0.0f, 1.0f / 5.0f, ColorAlphaOverride(WHITE, isDifficultyDecrementHovered ? 0.75 : alpha));
-        DrawTextureEx(right_arrow, (Vector2) { difficultyIncrementRect.x, difficultyIncrementRect.y }, 0.0f, 1.0f / 5.0f, ColorAlphaOverride(WHITE, isDifficultyIncrementHovered ? 0.75 : alpha));
-        DrawTextEx(meowFont, "Difficulty", (Vector2) { difficultyRect.x + 80, difficultyRect.y + 10 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
-        DrawTextEx(meowFont, StringFromDifficultyEnum(options->difficulty), (Vector2) { difficultyRect.x + 80, difficultyRect.y + 42 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
+        for (int i = 0; i < 20; i++) {
+            menuFallingItems[i].position = (Vector2){ RandomDouble(RANDOM_VISUALS, baseX, baseX + BASE_SCREEN_WIDTH - 20), baseY - RandomDouble(RANDOM_VISUALS, 200, 1000) };
+            menuFallingItems[i].textureIndex = RandomInt(RANDOM_VISUALS, 0, menuFallingItemsNumber - 1);
 
-        // Resolution
-        DrawTextureEx(left_arrow, (Vector2) { resolutionDecrementRect.x, resolutionDecrementRect.y }, 0.0f, 1.0f / 5.0f, ColorAlphaOverride(WHITE, isResolutionDecrementHovered ? 0.75 : alpha));
-        DrawTextureEx(right_arrow, (Vector2) { resolutionIncrementRect.x, resolutionDecrementRect.y }, 0.0f, 1.0f / 5.0f, ColorAlphaOverride(WHITE, isResolutionIncrementHovered ? 0.75 : alpha));
-        DrawTextEx(meowFont, "Resolution", (Vector2) { resolutionRect.x + 80, resolutionRect.y + 10 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
-        DrawTextEx(meowFont, TextFormat("%dx%d", options->resolution.x, options->resolution.y), (Vector2) { resolutionRect.x + 80, resolutionRect.y + 42 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
+            // Random rotation and falling speed
+            menuFallingItems[i].rotation = RandomDouble(RANDOM_VISUALS, -360, 360);
+            menuFallingItems[i].fallingSpeed = RandomDouble(RANDOM_VISUALS, 1, 3);
+            menuFallingItems[i].fallingSpeed *= 100;
 
-        // FPS
-        DrawTextureEx(left_arrow, (Vector2) { fpsDecrementRect.x, fpsDecrementRect.y }, 0.0f, 1.0f / 5.0f, ColorAlphaOverride(WHITE, isFpsDecrementHovered ? 0.75 : alpha));
-        DrawTextureEx(right_arrow, (Vector2) { fpsIncrementRect.x, fpsDecrementRect.y }, 0.0f, 1.0f / 5.0f, ColorAlphaOverride(WHITE, isFpsIncrementHovered ? 0.75 : alpha));
-		DrawTextEx(meowFont, "Target FPS", (Vector2) { fpsRect.x + 80, fpsRect.y + 10 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
-        DrawTextEx(meowFont, TextFormat("%d FPS", options->targetFps), (Vector2) { fpsRect.x + 80, fpsRect.y + 42 }, 32, 2, ColorAlphaOverride(MAIN_BROWN, alpha));
+            // Rotation speed is between -3 and 3, but should not execeed falling speed and should not be 0
+            menuFallingItems[i].rotationSpeed = RandomInt(RANDOM_VISUALS, -3, 3);
+            if (fabsf(menuFallingItems[i].rotationSpeed) > menuFallingItems[i].fallingSpeed)
+                menuFallingItems[i].rotationSpeed = menuFallingItems[i].fallingSpeed;
+            if (menuFallingItems[i].rotationSpeed == 0)
+                menuFallingItems[i].rotationSpeed = 1;
 
+            menuFallingItems[i].rotationSpeed *= 100;
 
-        // Back
-        DrawRectangleRec(backRect, isBackHovered ? ColorAlphaOverride(MAIN_ORANGE, alpha) : ColorAlphaOverride(MAIN_BROWN, alpha));
-        DrawTextEx(meowFont, "Back", (Vector2) { backRect.x + 60, backRect.y + 20 }, 32, 2, ColorAlphaOverride(WHITE, alpha));
+        }
+    }
+}
 
-        // Draw debug
-        if (options->showDebug && debugToolToggles.showObjects)
-        {
-            DrawRectangleLinesEx(difficultyRect, 1, RED);
-            DrawRectangleLinesEx(difficultyDecrementRect, 1, RED);
-            DrawRectangleLinesEx(difficultyIncrementRect, 1, RED);
-            DrawRectangleLinesEx(resolutionRect, 1, RED);
-            DrawRectangleLinesEx(resolutionDecrementRect, 1, RED);
-            DrawRectangleLinesEx(resolutionIncrementRect, 1, RED);
-            DrawRectangleLinesEx(fpsRect, 1, RED);
-            DrawRectangleLinesEx(fpsDecrementRect, 1, RED);
-            DrawRectangleLinesEx(fpsIncrementRect, 1, RED);
+void MainMenuUpdate(Camera2D* camera, double deltaTime)
+{
+    MainMenuState* state = &mainMenuScene;
 
-            DrawRectangleLinesEx(musicRect, 1, RED);
-            DrawRectangleLinesEx(soundFxRect, 1, RED);
-            DrawRectangleLinesEx(fullscreenRect, 1, RED);
-            DrawRectangleLinesEx(debugRect, 1, RED);
-        }
+    if (!state->isFadeOutDone)
+        state->currentTime += deltaTime;
 
-        DrawOuterWorld();
+    // If transitioning out, move the background to the left
+    if (state->isTransitioningOut)
+    {
+        float pixelsToMove = 900.0f;
+        float durationInSeconds = 0.6f;
+        float transitionSpeed = pixelsToMove / durationInSeconds;
 
-        if (options->showDebug)
-            DrawDebugOverlay(camera);
+        state->transitionOffset += transitionSpeed * deltaTime;
 
-        EndMode2D();
-        EndDrawing();
+        if (state->transitionOffset >= BASE_SCREEN_WIDTH / 2)
+        {
+            state->transitionOffset = 0;
+            state->isTransitioningOut = false;
+            ChangeScene(state->transitionTarget);
+            return;
+        }
     }
 
-    ExitApplication();
-}
-
-int RandomCustomerTexture()
-{
-    int randomIndex = rand() % (sizeof(customersImageData) / sizeof(customersImageData[0]));
-    return randomIndex;
-}
-void GameUpdate(Camera2D *camera)
-{
-    double lastFrameTime = GetTime();
-    bool isDragging = false;
-    bool isDraggingOnce = false;
+    // If transitioning in, move the background to the right
+    if (state->isTransitioningIn)
+    {
+        float pixelsToMove = 900.0f;
+        float durationInSeconds = 0.6f;
+        float transitionSpeed = pixelsToMove / durationInSeconds;
 
-    bool isHovering = false;
-    bool hoversoundPlayed = false;
+        state->transitionOffset -= transitionSpeed * deltaTime;
 
-    // Start from night
-    currentColorIndex = 3;
+        if (state->transitionOffset <= 0)
+        {
+            state->transitionOffset = 0;
+            state->isTransitioningIn = false;
+        }
+    }
 
-    dayNightCycleDuration = gameDuration * 3;
-    colorTransitionTime = 0.2f;
+    // Button positions and dimensions
+    state->startButtonRect = (Rectangle){ baseX + 50 - state->transitionOffset, baseY + 600 + 60, 400, 100 };
+    state->optionsButtonRect = (Rectangle){ baseX + 50 - state->transitionOffset, baseY + 600 + 160, 400, 100 };
+    state->exitButtonRect = (Rectangle){ baseX + 50 - state->transitionOffset, baseY + 600 + 350, 400, 100 };
 
-    bool passedInitialPhrase = false;
-
-    Cup cup = {
-        LoadTexture(ASSETS_PATH"combination/EMPTY.png"),
-        (Vector2) {0, 0},
-        NONE,
-        false,
-        NONE,
-        NONE,
-        NONE,
-        false,
-        '\0'
-    };
+    // Convert mouse position from screen space to world space
+    Vector2 mouseWorldPos = frameInput.mouse;
 
-    plate = (DropArea){ LoadTexture(ASSETS_PATH"/spritesheets/MAT.png"), oriplatePosition };
-    Texture2D cups = LoadTexture(ASSETS_PATH"/spritesheets/CUPS.png");
+    state->isStartButtonHovered = CheckCollisionPointRec(mouseWorldPos, state->startButtonRect);
+    state->isOptionsButtonHovered = CheckCollisionPointRec(mouseWorldPos, state->optionsButtonRect);
+    state->isExitButtonHovered = CheckCollisionPointRec(mouseWorldPos, state->exitButtonRect);
 
-    teaPowder = (Ingredient){ teaPowderTexture, true, oriteapowderPosition, oriteapowderPosition };
-    teaPowder.totalFrames = 3;
-    teaPowder.currentFrame = 1;
-    teaPowder.frameRectangle = frameRect(teaPowder, teaPowder.totalFrames, teaPowder.currentFrame);
+    // Check for button clicks
+    if (HasFrameInput(INPUT_MOUSE_LEFT_PRESSED) && !state->isTransitioningOut && !state->isTransitioningIn)
+    {
+        if (state->isStartButtonHovered)
+        {
+            PlaySoundFx(FX_SELECT);
+            state->transitionTarget = SCENE_GAME;
+            state->isTransitioningOut = true;
+        }
+        else if (state->isOptionsButtonHovered)
+        {
+            PlaySoundFx(FX_SELECT);
+            state->transitionTarget = SCENE_OPTIONS;
+            state->isTransitioningOut = true;
+        }
+        else if (state->isExitButtonHovered)
+        {
+            ExitApplication();
+        }
+    }
 
-    cocoaPowder = (Ingredient){ cocoaPowderTexture, true, oricocoapowderPosition, oricocoapowderPosition };
-    cocoaPowder.totalFrames = 3;
-    cocoaPowder.currentFrame = 1;
-    cocoaPowder.frameRectangle = frameRect(cocoaPowder, cocoaPowder.totalFrames, cocoaPowder.currentFrame);
+    // Play sound when hovering over a button, but only once
+    if (state->isStartButtonHovered)
+    {
+        if (!state->isHovering || state->currentHoveredButton != 0)
+        {
+            PlaySoundFx(FX_HOVER);
+            state->isHovering = true;
+        }
+        state->currentHoveredButton = 0;
+    }
+    else if (state->isOptionsButtonHovered)
+    {
+        if (!state->isHovering || state->currentHoveredButton != 1)
+        {
+            PlaySoundFx(FX_HOVER);
+            state->isHovering = true;
+        }
+        state->currentHoveredButton = 1;
+    }
+    else if (state->isExitButtonHovered)
+    {
+        if (!state->isHovering || state->currentHoveredButton != 2)
+        {
+            PlaySoundFx(FX_HOVER);
+            state->isHovering = true;
+        }
+        state->currentHoveredButton = 2;
+    }
+    else
+    {
+        state->currentHoveredButton = NO_BUTTON;  // Use NO_BUTTON instead of NULL
+        state->isHovering = false;
+    }
+}
 
-    caramelSauce = (Ingredient){ caramelSauceTexture, true, oricaramelPosition, oricaramelPosition };
-    caramelSauce.totalFrames = 3;
-    caramelSauce.currentFrame = 1;
-    caramelSauce.frameRectangle = frameRect(caramelSauce, caramelSauce.totalFrames, caramelSauce.currentFrame);
+void MainMenuDraw(Camera2D* camera, double deltaTime)
+{
+    MainMenuState* state = &mainMenuScene;
 
-    chocolateSauce = (Ingredient){ chocolateSauceTexture, true, orichocolatePosition, orichocolatePosition };
-    chocolateSauce.totalFrames = 3;
-    chocolateSauce.currentFrame = 1;
-    chocolateSauce.frameRectangle = frameRect(chocolateSauce, chocolateSauce.totalFrames, chocolateSauce.currentFrame);
+    ClearBackground(RAYWHITE);
 
-    condensedMilk = (Ingredient){ condensedMilkTexture, true, oricondensedmilkPosition, oricondensedmilkPosition };
-    condensedMilk.totalFrames = 2;
-    condensedMilk.currentFrame = 1;
-    condensedMilk.frameRectangle = frameRect(condensedMilk, condensedMilk.totalFrames, condensedMilk.currentFrame);
+    int splashBackgroundImageWidth = splashBackgroundTexture.width;
+    int splashBackgroundImageHeight = splashBackgroundTexture.height;
 
-    normalMilk = (Ingredient){ normalMilkTexture, true, orimilkPosition, orimilkPosition };
-    normalMilk.totalFrames = 2;
-    normalMilk.currentFrame = 1;
-    normalMilk.frameRectangle = frameRect(normalMilk, normalMilk.totalFrames, normalMilk.currentFrame);
+    float splashBackgroundScaleX = (float)BASE_SCREEN_WIDTH / splashBackgroundImageWidth;
+    float splashBackgroundScaleY = (float)BASE_SCREEN_HEIGHT / splashBackgroundImageHeight;
 
-    marshMellow = (Ingredient){ marshMellowTexture, true, orimarshmellowPosition, orimarshmellowPosition };
-    marshMellow.totalFrames = 2;
-    marshMellow.currentFrame = 1;
-    marshMellow.frameRectangle = frameRect(marshMellow, marshMellow.totalFrames, marshMellow.currentFrame);
+    int imageWidth = backgroundTexture.width;
+    int imageHeight = backgroundTexture.height;
 
-    whippedCream = (Ingredient){ whippedCreamTexture, true, oriwhippedPosition, oriwhippedPosition };
-    whippedCream.totalFrames = 2;
-    whippedCream.currentFrame = 1;
-    whippedCream.frameRectangle = frameRect(whippedCream, whippedCream.totalFrames, whippedCream.currentFrame);
+    float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
+    float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
 
-    hotWater = (Ingredient){ hotWaterTexture, true, oriwaterPosition, oriwaterPosition };
-    hotWater.totalFrames = 17;
-    hotWater.currentFrame = 1;
-    hotWater.frameRectangle = frameRect(hotWater, hotWater.totalFrames, hotWater.currentFrame);
-    hotWater.canChangeCupTexture = false;
+    int imageLogoWidth = logoTexture.width;
+    int imageLogoHeight = logoTexture.height;
 
-    greenChon = (Ingredient){ greenChonTexture, false, hiddenPosition, hiddenPosition };
-    greenChon.totalFrames = 1;
-    greenChon.currentFrame = 1;
-    greenChon.frameRectangle = frameRect(greenChon, greenChon.totalFrames, greenChon.currentFrame);
+    float scaleLogoX = (float)BASE_SCREEN_WIDTH / imageLogoWidth / 4;
+    float scaleLogoY = (float)BASE_SCREEN_HEIGHT / imageLogoHeight / 4;
 
-    cocoaChon = (Ingredient){ cocoaChonTexture, false, hiddenPosition, hiddenPosition };
-    cocoaChon.totalFrames = 1;
-    cocoaChon.currentFrame = 1;
-	cocoaChon.frameRectangle = frameRect(cocoaChon, cocoaChon.totalFrames, cocoaChon.currentFrame);
+    // Draw the background with the scaled dimensions
+    // DrawTextureEx(backgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
 
+    BeginSpriteQueue();
 
-    trashCan = (Ingredient){ trashCanTexture, false, trashCanPosition, trashCanPosition };
-    trashCan.currentFrame = 1;
-    trashCan.totalFrames = 2;
-    trashCan.frameRectangle = frameRect(trashCan, trashCan.totalFrames, trashCan.currentFrame);
+    DrawDayNightCycle(deltaTime);
 
-    Texture2D* currentDrag = NULL;
+    // Draw falling items behind the menu
+    DrawMenuFallingItems(deltaTime, true);
 
-    Customer customer1;
-    Customer customer2;
-    Customer customer3;
+    // Draw customer images
+    DrawCustomerInMenu(deltaTime);
 
-    Customers customers;
+    QueueTextureEx(backgroundOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
 
-    Vector2 customer1Position = { baseX + 50, baseY + 100 };
-    Vector2 customer2Position = { baseX + 650, baseY + 100 };
-    Vector2 customer3Position = { baseX + 1250, baseY + 100 };
+    // Draw falling items in front of the menu
+    DrawMenuFallingItems(deltaTime, false);
 
-    Rectangle endScene = { 770, -500, 140, 70 };
+    // Left sidebar white
+    QueueTextureEx(backgroundOverlaySidebarTexture, (Vector2) { baseX - state->transitionOffset, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
 
-    double initialReset[3];
-    RandomCustomerInitialResetBasedOnDifficulty(&initialReset);
-
-    customer1 = CreateCustomerWithOrder(1, 0, RandomCustomerTimeoutBasedOnDifficulty(), customer1Position, RandomCustomerTexture(), initialReset[0]);
-    customer2 = CreateCustomerWithOrder(1, 0, RandomCustomerTimeoutBasedOnDifficulty(), customer2Position, RandomCustomerTexture(), initialReset[1]);
-    customer3 = CreateCustomerWithOrder(1, 0, RandomCustomerTimeoutBasedOnDifficulty(), customer3Position, RandomCustomerTexture(), initialReset[2]);
-    customer1.visible = false;
-    customer2.visible = false;
-    customer3.visible = false;
-
-    customers.customer1 = customer1;
-    customers.customer2 = customer2;
-    customers.customer3 = customer3;
-    
-    while (!WindowShouldClose())
-    {
-        // Calculate delta time
-        double deltaTime = GetTime() - lastFrameTime;
-        lastFrameTime = GetTime();
+    // Logo
+    QueueTextureEx(logoTexture, (Vector2) { baseX - state->transitionOffset, baseY - 50 }, 0.0f, fmax(scaleLogoX, scaleLogoY), WHITE);
 
-         // Esc key to return to main menu
-        if (IsKeyPressed(KEY_ESCAPE))
-        {
-            ResetGameState();
-            MainMenuUpdate(camera, false);
-            return;
-        }
+    EndSpriteQueue();
 
-        WindowUpdate(camera);
-
-        bool anyDragDetected = false;
-
-        if (!IsMouseButtonDown(MOUSE_LEFT_BUTTON))
-        {
-            dragAndDropLocked = false;
-        }
-
-        if (!dragAndDropLocked)
-        {
-            // Dragable items
-            if (currentDrag == NULL || currentDrag == &teaPowder.texture) {
-                currentDrag = DragAndDropIngredientPop(&teaPowder, &greenChon, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &cocoaPowder.texture) {
-                // currentDrag = DragAndDropIngredient(&cocoaPowder, &plate, &cup, camera);
-                currentDrag = DragAndDropIngredientPop(&cocoaPowder, &cocoaChon, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &condensedMilk.texture) {
-                currentDrag = DragAndDropIngredient(&condensedMilk, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &normalMilk.texture) {
-                currentDrag = DragAndDropIngredient(&normalMilk, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &whippedCream.texture) {
-                currentDrag = DragAndDropIngredient(&whippedCream, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &marshMellow.texture) {
-                currentDrag = DragAndDropIngredient(&marshMellow, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &caramelSauce.texture) {
-                currentDrag = DragAndDropIngredient(&caramelSauce, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &chocolateSauce.texture) {
-                currentDrag = DragAndDropIngredient(&chocolateSauce, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }if (currentDrag == NULL || currentDrag == &hotWater.texture) {
-                currentDrag = DragAndDropIngredient(&hotWater, &cup, camera);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }
-            if (currentDrag == NULL || currentDrag == &cup.texture) {
-                currentDrag = DragAndDropCup(&cup, &plate, camera, &customers, &trashCan);
-                if (currentDrag != NULL) anyDragDetected = true;
-            }
-        }
+    // Draw button labels
+    DrawTextEx(meowFont, "Start Game", (Vector2) { (int)(state->startButtonRect.x + 40), (int)(state->startButtonRect.y + 15) }, 60, 2, state->isStartButtonHovered ? MAIN_ORANGE : MAIN_BROWN);
+    DrawTextEx(meowFont, "Settings", (Vector2) { (int)(state->optionsButtonRect.x + 40), (int)(state->optionsButtonRect.y + 15) }, 60, 2, state->isOptionsButtonHovered ? MAIN_ORANGE : MAIN_BROWN);
+    DrawTextEx(meowFont, "Exit", (Vector2) { (int)(state->exitButtonRect.x + 40), (int)(state->exitButtonRect.y + 15) }, 60, 2, state->isExitButtonHovered ? MAIN_ORANGE : MAIN_BROWN);
 
-        
+    // Draw debug
+    if (options->showDebug && debugToolToggles.showObjects)
+    {
+        DrawRectangleLinesEx(state->startButtonRect, 1, RED);
+        DrawRectangleLinesEx(state->optionsButtonRect, 1, RED);
+        DrawRectangleLinesEx(state->exitButtonRect, 1, RED);
+    }
 
-        if (!dragAndDropLocked && !anyDragDetected && IsMouseButtonDown(MOUSE_LEFT_BUTTON))
-        {
-            dragAndDropLocked = true;
-        }
+    DrawOuterWorld();
 
-        bool previousIsDragging = isDragging;
+    // Calculate alpha based on the current time
+    if (state->playFade)
+    {
+        float alpha = (float)(255.0 * (1.0 - fmin(state->currentTime / state->fadeOutDuration, 1.0)));
+        if (!state->isFadeOutDone && alpha != 0)
+            DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(splashBackgroundScaleX, splashBackgroundScaleY), (Color) { 255, 255, 255, alpha });
+        else
+            state->isFadeOutDone = true;
+    }
+}
 
-        // If something is dragged now, play sound
-        if (currentDrag != NULL && !isDraggingOnce)
-		{
-            PlaySoundFx(FX_PICKUP);
-            isDraggingOnce = true;
-		}
-		else if (currentDrag == NULL)
-		{
-            if(previousIsDragging != isDraggingOnce)
-                PlaySoundFx(FX_DROP);
+void MainMenuExit(Camera2D* camera)
+{
+    // Only the splash screen asks for the fade in
+    mainMenuScene.playFade = false;
+}
 
-            isDraggingOnce = false;
-		}
+// Autoplayer
+// MEOW_AUTOPLAY=<seed> lets a bot play in place of the mouse, for soak tests and repeatable performance runs. It only
+// writes the FrameInput a player would produce: it starts a round from the main menu, takes a cup, drags the
+// ingredients of the most impatient customer's order onto it, boils the kettle and serves. Now and then it throws
+// a drink into the trash. Rounds follow each other until the game is closed. The seed feeds the bot's own
+// generator and, unless a recording already did, the game's, so the same seed plays the same rounds.
+#define AUTOPLAYER_MOVE_TIME 0.25
+#define AUTOPLAYER_THINK_TIME 0.2
+#define AUTOPLAYER_MENU_TIME 1.0
+#define AUTOPLAYER_TRASH_CHANCE 10  // Percent of drinks thrown away
+
+typedef struct Autoplayer {
+    bool enabled;
+    uint32_t seed;
+    Vector2 mouse;
+    SceneType scene;        // Scene of the last frame, a change drops whatever the bot was doing
+    int rounds;
+
+    // The button is held while the mouse moves from gestureFrom to gestureTo, a click when both are the same
+    bool gestureActive;
+    Vector2 gestureFrom;
+    Vector2 gestureTo;
+    double gestureDuration;
+    double gestureTime;
+    int gestureFrame;
+    double thinkTime;       // Idle until this runs out
+
+    int customer;           // Pool index of the customer being served, -1 when idle
+    uint32_t generation;    // Of that customer, a change means they left
+    bool trashDrink;        // Throw this drink away after its first ingredient
+} Autoplayer;
+
+Autoplayer autoplayer = { .customer = -1, .scene = SCENE_NONE };
+
+void InitAutoplayer()
+{
+    const char* seed = getenv("MEOW_AUTOPLAY");
+    if (seed == NULL || strtoul(seed, NULL, 10) == 0)
+        return;
 
-        isHovering = false;
-        // check mouse not down
-        if (IsMouseButtonUp(MOUSE_LEFT_BUTTON)) {
-            // call highlightItem for each item
-            isHovering = highlightItem(&teaPowder, camera) || isHovering;
-            isHovering = highlightItem(&cocoaPowder, camera) || isHovering;
-            isHovering = highlightItem(&condensedMilk, camera) || isHovering;
-            isHovering = highlightItem(&normalMilk, camera) || isHovering;
-            isHovering = highlightItem(&whippedCream, camera) || isHovering;
-            isHovering = highlightItem(&marshMellow, camera) || isHovering;
-            isHovering = highlightItem(&caramelSauce, camera) || isHovering;
-            isHovering = highlightItem(&chocolateSauce, camera) || isHovering;
-            isHovering = highlightItem(&hotWater, camera) || isHovering;
-            isHovering = highlightItem(&trashCan,camera) || isHovering;
-        }
-        else {
-            isHovering = false;
-        }
-        if (isHovering && !hoversoundPlayed) {
+    autoplayer.enabled = true;
+    autoplayer.seed = (uint32_t)strtoul(seed, NULL, 10);
+    Log(LOG_INFO, "Autoplayer on, seed %u", autoplayer.seed);
+}
 
-            hoversoundPlayed = true;
-            //PlaySound(hover);
+static inline Vector2 GetRectangleCenter(Rectangle rectangle)
+{
+    return (Vector2) { rectangle.x + rectangle.width / 2, rectangle.y + rectangle.height / 2 };
+}
 
-        }
-        else if (!isHovering) {
-            hoversoundPlayed = false;
-        }
+void StartAutoplayerGesture(Autoplayer* bot, Vector2 from, Vector2 to, double duration)
+{
+    bot->gestureActive = true;
+    bot->gestureFrom = from;
+    bot->gestureTo = to;
+    bot->gestureDuration = duration;
+    bot->gestureTime = 0;
+    bot->gestureFrame = 0;
+}
 
-        Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        if (CheckCollisionPointRec(mousePos, (Rectangle) { cup.position.x, cup.position.y, cup.frameRectangle.width, cup.frameRectangle.height })) {
-            cup.frameRectangle = frameRectCup(cup, 2, 2);
-        }
-        else {
-            cup.frameRectangle = frameRectCup(cup, 2, 1);
-        }
+// Presses on the first frame, holds while moving and lets go once the gesture took its time
+void StepAutoplayerGesture(Autoplayer* bot, double deltaTime)
+{
+    if (bot->gestureFrame == 0)
+    {
+        bot->mouse = bot->gestureFrom;
+        frameInput.flags = INPUT_MOUSE_LEFT_DOWN | INPUT_MOUSE_LEFT_PRESSED;
+    }
+    else if (bot->gestureTime < bot->gestureDuration)
+    {
+        float t = (float)(bot->gestureTime / bot->gestureDuration);
+        bot->mouse = (Vector2){ bot->gestureFrom.x + (bot->gestureTo.x - bot->gestureFrom.x) * t, bot->gestureFrom.y + (bot->gestureTo.y - bot->gestureFrom.y) * t };
+        frameInput.flags = INPUT_MOUSE_LEFT_DOWN;
+    }
+    else
+    {
+        bot->mouse = bot->gestureTo;
+        bot->gestureActive = false;
+        bot->thinkTime = AUTOPLAYER_THINK_TIME;
+    }
 
-        Vector2 mouseWorldPos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        bool isendSceneHovered = CheckCollisionPointRec(mouseWorldPos, endScene);
-        void (*transitionCallback)(Camera2D * camera) = NULL;
+    bot->gestureFrame++;
+    bot->gestureTime += deltaTime;
+}
 
-        if (!passedInitialPhrase && currentColorIndex == 0)
-            passedInitialPhrase = true;
+// Picks the next step of the drink for the customer being served
+void PlanAutoplayerMove(Autoplayer* bot)
+{
+    GameState* state = &gameScene;
+    Cup* cup = &state->cup;
+    CustomerPool* pool = state->customers;
+    Vector2 trash = GetRectangleCenter(GetIngredientBounds(&ingredients[INGREDIENT_TRASH_CAN]));
 
-        // Day ended, show end scene
-        if (passedInitialPhrase && currentColorIndex >= 2)
+    // The customer left before the drink was done
+    if (bot->customer >= 0 && pool->entries[bot->customer].generation != bot->generation)
+    {
+        bot->customer = -1;
+        if (cup->active)
         {
-            // If not freeplay
-            if (options->difficulty != FREEPLAY_EASY && options->difficulty != FREEPLAY_MEDIUM && options->difficulty != FREEPLAY_HARD)
-			{
-                endgameUpdate(camera);
-			}
+            StartAutoplayerGesture(bot, GetRectangleCenter(GetCupBounds(cup)), trash, AUTOPLAYER_MOVE_TIME);
+            return;
         }
-        
-        Tick(&customers, deltaTime);
-        tickBoil(&hotWater);
-
-        // Draw
-
-        BeginDrawing();
-        ClearBackground(BLACK);
-
+    }
 
-        BeginMode2D(*camera);
-        
+    if (bot->customer < 0)
+    {
+        bot->customer = FindMostImpatientCustomer(pool);
+        if (bot->customer < 0)
+        {
+            bot->thinkTime = AUTOPLAYER_THINK_TIME;
+            return;
+        }
 
-        int imageWidth = backgroundTexture.width;
-        int imageHeight = backgroundTexture.height;
+        bot->generation = pool->entries[bot->customer].generation;
+        bot->trashDrink = RandomInt(RANDOM_AUTOPLAYER, 0, 99) < AUTOPLAYER_TRASH_CHANCE;
+    }
 
-        float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
-        float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
+    if (!cup->active)
+    {
+        Rectangle stack = { oricupsPostion.x, oricupsPostion.y, cup->region.sourceSize.x, cup->region.sourceSize.y };
+        Vector2 plateCenter = { plate.position.x + plate.region.sourceSize.x / 2, plate.position.y + plate.region.sourceSize.y / 2 };
+        StartAutoplayerGesture(bot, GetRectangleCenter(stack), plateCenter, AUTOPLAYER_MOVE_TIME);
+        return;
+    }
 
-        DrawDayNightCycle(deltaTime);
+    Vector2 cupCenter = GetRectangleCenter(GetCupBounds(cup));
 
-		render_customers(&customers);
+    if (bot->trashDrink && cup->contents != DRINK_EMPTY)
+    {
+        bot->trashDrink = false;
+        StartAutoplayerGesture(bot, cupCenter, trash, AUTOPLAYER_MOVE_TIME);
+        return;
+    }
 
-        DrawTextureEx(backgroundOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+    Customer* customer = &pool->entries[bot->customer];
 
-        DrawTexture(plate.texture, oriplatePosition.x, oriplatePosition.y, WHITE);
+    DrinkSlot next = DRINK_POWDER;
+    while (next < DRINK_SLOT_COUNT && (!HasDrinkSlot(customer->order, next) || HasDrinkSlot(cup->contents, next)))
+        next++;
 
-        DrawDragableItemFrame(trashCan);
+    if (next == DRINK_SLOT_COUNT)
+    {
+        StartAutoplayerGesture(bot, cupCenter, GetRectangleCenter(GetCustomerBounds(customer)), AUTOPLAYER_MOVE_TIME);
+        return;
+    }
 
+    Ingredient* item = &ingredients[FindIngredientForSlot(customer->order, next)];
+    Vector2 itemCenter = GetRectangleCenter(GetIngredientBounds(item));
 
-        DrawDragableItemFrame(hotWater);
-        DrawDragableItemFrame(condensedMilk);
-        DrawDragableItemFrame(normalMilk);
-        DrawTexture(cups, oricupsPostion.x, oricupsPostion.y, WHITE);
+    // Put the kettle on and wait for it
+    if (!item->canChangeCupTexture)
+    {
+        if (!triggerHotWater)
+            StartAutoplayerGesture(bot, itemCenter, itemCenter, 0);
+        else
+            bot->thinkTime = AUTOPLAYER_THINK_TIME;
+        return;
+    }
 
-        DrawDragableItemFrame(cocoaPowder);
-        DrawDragableItemFrame(teaPowder);
+    StartAutoplayerGesture(bot, itemCenter, cupCenter, AUTOPLAYER_MOVE_TIME);
+}
 
-        DrawDragableItemFrame(chocolateSauce);
-        DrawDragableItemFrame(caramelSauce);
+// Writes this frame's input when the autoplayer is on, false leaves it to the mouse
+bool UpdateAutoplayer(double deltaTime)
+{
+    Autoplayer* bot = &autoplayer;
+    if (!bot->enabled)
+        return false;
 
-        DrawDragableItemFrame(marshMellow);
-        DrawDragableItemFrame(whippedCream);
+    frameInput.deltaTime = deltaTime;
+    frameInput.flags = 0;
 
-        // DrawTexture(cup.texture, cup.position.x, cup.position.y, WHITE);
+    if (currentScene != bot->scene)
+    {
+        // The first main menu seeds the game, a recording has already done that with its own seed
+        if (currentScene == SCENE_MAIN_MENU && bot->scene == SCENE_SPLASH && inputRecorder.mode == INPUT_LIVE)
+        {
+            SeedRandomStreams(bot->seed);
+        }
 
-        DrawTexture(greenChon.texture, greenChon.position.x, greenChon.position.y, WHITE);
-        DrawTexture(cocoaChon.texture, cocoaChon.position.x, cocoaChon.position.y, WHITE);
-        
+        if (currentScene == SCENE_ENDGAME)
+            Log(LOG_INFO, "Autoplayer finished round %d, score %d", ++bot->rounds, global_score);
 
-        if (cup.active)
-            DrawTextureRec(cup.texture, cup.frameRectangle, cup.position, WHITE);
+        bot->scene = currentScene;
+        bot->gestureActive = false;
+        bot->customer = -1;
+        bot->thinkTime = AUTOPLAYER_MENU_TIME;
+    }
 
-        // Draw debug for cup
-        if (options->showDebug && debugToolToggles.showObjects)
+    if (!bot->gestureActive)
+    {
+        bot->thinkTime -= deltaTime;
+        if (bot->thinkTime <= 0)
         {
-            DrawRectangleLinesEx((Rectangle) { cup.position.x, cup.position.y, cup.frameRectangle.width, cup.frameRectangle.height }, 1, RED);
-            DrawRectangle(cup.position.x, cup.position.y - 60, 400, 60, Fade(GRAY, 0.7));
-            DrawTextEx(meowFont, TextFormat("Powder type: %d, Water: %d, Creamer: %d", cup.powderType, cup.hasWater, cup.creamerType), (Vector2) { cup.position.x, cup.position.y - 20 }, 20, 1, WHITE);
-            DrawTextEx(meowFont, TextFormat("Topping: %d, Sauce: %d", cup.toppingType, cup.sauceType), (Vector2) { cup.position.x, cup.position.y - 40 }, 20, 1, WHITE);
-			DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Active %s", "Cup", cup.position.x, cup.position.y, cup.active ? "[Yes]" : "[No]"), (Vector2) { cup.position.x, cup.position.y - 60 }, 20, 1, WHITE);
-            
-            // Cups
-            DrawRectangleLinesEx((Rectangle) { oricupsPostion.x, oricupsPostion.y, cups.width, cups.height }, 1, RED);
-            DrawRectangle(oricupsPostion.x, oricupsPostion.y - 20, 400, 20, Fade(GRAY, 0.7));
-            DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f | Grabbable %s", "Cups", oricupsPostion.x, oricupsPostion.y, cup.active ? "[No]" : "[Yes]"), (Vector2) { oricupsPostion.x, oricupsPostion.y - 20 }, 20, 1, WHITE);
-
-            // Plate
-            DrawRectangleLinesEx((Rectangle) { oriplatePosition.x, oriplatePosition.y, plate.texture.width, plate.texture.height }, 1, RED);
-            DrawRectangle(oriplatePosition.x, oriplatePosition.y - 20, 300, 20, Fade(GRAY, 0.7));
-            DrawTextEx(meowFont, TextFormat("%s | XY %.2f,%.2f", "Plate", oriplatePosition.x, oriplatePosition.y), (Vector2) { oriplatePosition.x, oriplatePosition.y - 20 }, 20, 1, WHITE);
+            bot->thinkTime = AUTOPLAYER_MENU_TIME;
+
+            if (currentScene == SCENE_MAIN_MENU)
+                StartAutoplayerGesture(bot, GetRectangleCenter(mainMenuScene.startButtonRect), GetRectangleCenter(mainMenuScene.startButtonRect), 0);
+            else if (currentScene == SCENE_ENDGAME)
+                StartAutoplayerGesture(bot, GetRectangleCenter(endgameScene.tryagain), GetRectangleCenter(endgameScene.tryagain), 0);
+            else if (currentScene == SCENE_GAME)
+                PlanAutoplayerMove(bot);
         }
+    }
 
-		/* Customers TEST AREA END*/
-        if(&customers.customer1 != NULL)
-            UpdateMenuCustomerBlink(&customers.customer1, deltaTime);
-        if (&customers.customer2 != NULL)
-            UpdateMenuCustomerBlink(&customers.customer2, deltaTime);
-        if (&customers.customer3 != NULL)
-            UpdateMenuCustomerBlink(&customers.customer3, deltaTime);
-
+    if (bot->gestureActive)
+        StepAutoplayerGesture(bot, deltaTime);
 
-        DrawTextEx(meowFont, TextFormat("Score: %d", global_score), (Vector2) { baseX + 20, baseY + 20 }, 26, 2, WHITE);
+    frameInput.mouse = bot->mouse;
+    return true;
+}
 
-        DrawOuterWorld();
+// Splash scene
+typedef enum {
+    SPLASH_PHASE_BEFORE_START,
+    SPLASH_PHASE_SHOW,
+    SPLASH_PHASE_AFTER_END
+} SplashPhase;
 
-        if (options->showDebug)
-            DrawDebugOverlay(camera);
+typedef struct SplashState {
+    SplashPhase phase;
+    double currentTime;
+    double splashDuration;
+    bool isLoadingGlobalAssets;
+    Sound systemLoad;
+} SplashState;
 
-        // End game
-        if(options->difficulty == FREEPLAY_EASY || options->difficulty == FREEPLAY_MEDIUM || options->difficulty == FREEPLAY_HARD)
-		{
-            DrawRectangleRec(endScene, ColorAlphaOverride(RED, isendSceneHovered ? 0.5f : 1.0f));
-            DrawTextEx(meowFont, "End", (Vector2) { endScene.x + 42, endScene.y + 22 }, 32, 2, ColorAlphaOverride(WHITE, isendSceneHovered ? 0.5f : 1.0f));
+SplashState splashScene;
 
-			if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && (isendSceneHovered))
-			{
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    if (isendSceneHovered) {
-                        endgameUpdate(camera);
-                    }
-                }
+#if DEBUG_FASTLOAD
+const double splashBeforeStart = 0;
+const double splashDefaultDuration = 0;
+const double splashFadeInDuration = 0;
+const double splashStayDuration = 0;
+const double splashFadeOutDuration = 0;
+const double splashAfterEnd = 0;
+#else
+const double splashBeforeStart = 1.0;
+const double splashDefaultDuration = 8.0;
+const double splashFadeInDuration = 2.0;
+const double splashStayDuration = 3.0;
+const double splashFadeOutDuration = 2.0;
+const double splashAfterEnd = 2.0;
+#endif
 
-			}
-		}
+void SplashEnter(Camera2D* camera)
+{
+    SplashState* state = &splashScene;
+    *state = (SplashState){ 0 };
 
-        EndMode2D();
-        EndDrawing();
-    }
+    state->phase = SPLASH_PHASE_BEFORE_START;
+    state->splashDuration = splashDefaultDuration;
 
-    UnloadTexture(backgroundTexture);
-    CloseWindow();
+    // Held until the menu takes over, so the menu assets load while the splash plays
+    AcquireAssetSet(&menuAssets);
 
+#if DEBUG_FASTLOAD
+    LoadGlobalAssets();
+    ChangeSceneToMainMenu(true);
+#else
+    // Decoding starts right away, the splash only waits for whatever is left after the fade in
+    RequestGlobalAssets();
+    state->isLoadingGlobalAssets = true;
+#endif
 }
 
-void ResetGameState()
+void SplashUpdate(Camera2D* camera, double deltaTime)
 {
-    global_score = 0;
+    SplashState* state = &splashScene;
 
-    // Reset hotWater boiling
-    triggerHotWater = false;
-    hotWater.canChangeCupTexture = false;
-    hotWater.currentFrame = 1;
-}
+    state->currentTime += deltaTime;
 
-void endgameUpdate(Camera2D *camera){
+    if (state->isLoadingGlobalAssets)
+    {
+        UpdateAssetLoader(ASSET_LOADER_FRAME_BUDGET);
 
-    int imageWidth = backgroundTexture.width;
-    int imageHeight = backgroundTexture.height;
+        if (IsAssetLoaderDone())
+        {
+            FinishGlobalAssets();
+            state->isLoadingGlobalAssets = false;
+        }
+    }
 
-    float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
-    float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
+    switch (state->phase)
+    {
+    case SPLASH_PHASE_BEFORE_START:
+        if (state->currentTime >= splashBeforeStart)
+        {
+            state->systemLoad = TrackSound(LoadSound(ASSETS_PATH"audio/Meow1.mp3"));
+            PlaySound(state->systemLoad);
 
-    Rectangle scoreRec = {-277,-241,600,450};
-    float centerX = scoreRec.x + (scoreRec.width / 2);
-    float centerY = scoreRec.y + (scoreRec.height / 2);
-    Rectangle tryagain = { centerX - 90 , centerY + 50, 200, 70 };
+            // Reset time
+            state->currentTime = 0;
+            state->phase = SPLASH_PHASE_SHOW;
+        }
+        break;
+    case SPLASH_PHASE_SHOW:
+        // Holds the splash fully visible until loading is done
+        if (state->isLoadingGlobalAssets && state->currentTime > splashFadeInDuration + splashStayDuration)
+            state->currentTime = splashFadeInDuration + splashStayDuration;
 
+        if (state->currentTime >= state->splashDuration)
+        {
+            // Reset time
+            state->currentTime = 0;
+            state->phase = SPLASH_PHASE_AFTER_END;
+        }
+        break;
+    case SPLASH_PHASE_AFTER_END:
+        if (state->currentTime >= splashAfterEnd)
+            ChangeSceneToMainMenu(true);
+        break;
+    }
+}
 
-    while (!WindowShouldClose()){
-        WindowUpdate(camera);
-        Vector2 mouseWorldPos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        bool istryagainHovered = CheckCollisionPointRec(mouseWorldPos, tryagain);
+void SplashDraw(Camera2D* camera, double deltaTime)
+{
+    SplashState* state = &splashScene;
 
-        BeginDrawing();
-        ClearBackground(RAYWHITE);
-        BeginMode2D(*camera);
+    int imageWidth = splashBackgroundTexture.width;
+    int imageHeight = splashBackgroundTexture.height;
 
-        DrawTextureEx(backgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
-        DrawRectangleRec(scoreRec, MAIN_BROWN);
-        DrawRectangleLinesEx((Rectangle) {-217,-195, 480, 360}, 5, WHITE);
+    float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
+    float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
 
-        Vector2 scorePos;
-        scorePos.x = centerX - (MeasureText("Score", 55) / 2);
-        scorePos.y = centerY - 150; 
-        DrawTextEx(meowFont, "Score", scorePos, 55, 2, WHITE);
+    ClearBackground(RAYWHITE);
 
-        char *scoreText = TextFormat("%d", global_score);
-        Vector2 scoreTextPos;
-        scoreTextPos.x = centerX - (MeasureText(scoreText, 100) / 2);
-        scoreTextPos.y = centerY - 80; 
-        DrawTextEx(meowFont, scoreText, scoreTextPos, 100, 2, WHITE);
+    switch (state->phase)
+    {
+    case SPLASH_PHASE_BEFORE_START:
+    {
+        float alpha = (float)(255.0 * (1.0 - fmin(state->currentTime / splashBeforeStart, 1.0)));
 
-        DrawRectangleRec(tryagain, ColorAlphaOverride(RED, istryagainHovered ? 0.5f : 1.0f));
-        DrawTextEx(meowFont, "Menu", (Vector2) {-10,55}, 32, 2, ColorAlphaOverride(WHITE, istryagainHovered ? 0.5f : 1.0f));
+        DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+        DrawRectangle(baseX, baseY, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, (Color) { 255, 255, 255, alpha });
+        break;
+    }
+    case SPLASH_PHASE_SHOW:
+    {
+        int alpha = 0;
 
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && (istryagainHovered))
-        {
-            ResetGameState();
-            MainMenuUpdate(camera, false);
+        // Calculate alpha based on the current time
+        if (state->currentTime < splashFadeInDuration) {
+            // Fading in
+            alpha = (int)(255.0 * (state->currentTime / splashFadeInDuration));
+        }
+        else if (state->currentTime < splashFadeInDuration + splashStayDuration) {
+            // Fully visible (staying)
+            alpha = 255;
+        }
+        else {
+            // Fading out
+            alpha = (int)(255.0 * (1.0 - fmin((state->currentTime - splashFadeInDuration - splashStayDuration) / splashFadeOutDuration, 1.0)));
         }
 
-        if(options->showDebug)
-            DrawDebugOverlay(camera);
+        DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+        DrawTextureEx(splashOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), (Color) { 255, 255, 255, alpha });
 
-        EndMode2D();
-        EndDrawing();
+        // Loading progress, one step per finished asset
+        float progressWidth = 800.0f;
+        Rectangle progressBar = { baseX + (BASE_SCREEN_WIDTH - progressWidth) / 2.0f, baseY + BASE_SCREEN_HEIGHT - 120.0f, progressWidth, 8.0f };
+        DrawRectangleRec(progressBar, Fade(MAIN_BROWN, 0.25f * alpha / 255.0f));
+        progressBar.width *= GetAssetLoaderProgress();
+        DrawRectangleRec(progressBar, Fade(MAIN_BROWN, alpha / 255.0f));
+        break;
+    }
+    case SPLASH_PHASE_AFTER_END:
+        DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+        DrawTextureEx(splashOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+        break;
     }
 }
 
-void MainMenuUpdate(Camera2D* camera, bool playFade)
+void SplashExit(Camera2D* camera)
 {
-    int currentHoveredButton = NO_BUTTON;
-    float fadeOutDuration = 1.0f;
-    double currentTime = 0;
-    double lastFrameTime = GetTime();  // Add lastFrameTime declaration
-    bool isHovering = false;
-    void (*transitionCallback)(Camera2D* camera) = NULL;
+    SplashState* state = &splashScene;
 
-    int splashBackgroundImageWidth = splashBackgroundTexture.width;
-    int splashBackgroundImageHeight = splashBackgroundTexture.height;
+    if (state->systemLoad.frameCount > 0)
+        UnloadTrackedSound(state->systemLoad);
+    state->systemLoad = (Sound){ 0 };
 
-    float splashBackgroundScaleX = (float)BASE_SCREEN_WIDTH / splashBackgroundImageWidth;
-    float splashBackgroundScaleY = (float)BASE_SCREEN_HEIGHT / splashBackgroundImageHeight;
+    ReleaseAssetSet(&menuAssets);
+}
 
-    float transitionOffset = 0;
+// Scene table, indexed by SceneType
+const Scene scenes[SCENE_COUNT] = {
+    [SCENE_SPLASH] = { SplashEnter, SplashUpdate, SplashDraw, SplashExit, NULL },
+    [SCENE_MAIN_MENU] = { MainMenuEnter, MainMenuUpdate, MainMenuDraw, MainMenuExit, &menuAssets },
+    [SCENE_OPTIONS] = { OptionsEnter, OptionsUpdate, OptionsDraw, NULL, &menuAssets },
+    [SCENE_GAME] = { GameEnter, GameUpdate, GameDraw, GameExit, &gameAssets },
+    [SCENE_ENDGAME] = { EndgameEnter, EndgameUpdate, EndgameDraw, NULL, &sharedAssets },
+};
 
-    bool isFadeOutDone = false;
-    bool isTransitioningIn = !playFade;
-    bool isTransitioningOut = false;
+void ChangeScene(SceneType scene)
+{
+    nextScene = scene;
+}
 
-    if(isTransitioningIn)
-        transitionOffset = BASE_SCREEN_WIDTH / 2;
+// Scene switches happen between frames, so the leaving scene always gets to release its resources
+void ApplySceneChange(Camera2D* camera)
+{
+    if (nextScene == SCENE_NONE)
+        return;
 
-    trashCanPosition = (Vector2){baseX , baseY + BASE_SCREEN_HEIGHT - 200};
+    SceneType scene = nextScene;
+    nextScene = SCENE_NONE;
 
-    PlayBgmIfStopped(&menuBgm);
+    // The next scene's assets are acquired before the current ones are released, so shared assets stay loaded
+    AcquireAssetSet(scenes[scene].assets);
+    FlushAssetLoader();
 
-    if(playFade)
+    if (currentScene != SCENE_NONE)
     {
-        movingClouds[0] = (MovingCloud){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), GetRandomDoubleValue(baseY, 0) }, 250.0f, 1.0f, cloud1Texture, false };
-        movingClouds[1] = (MovingCloud){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), GetRandomDoubleValue(baseY, 0) }, 200.0f, 1.0f, cloud2Texture, false };
-        movingClouds[2] = (MovingCloud){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), GetRandomDoubleValue(baseY, 0) }, 150.0f, 2.0f, cloud3Texture, true };
-        movingClouds[3] = (MovingCloud){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), GetRandomDoubleValue(baseY, 0) }, 250.0f, 1.0f, cloud1Texture, false };
-        movingClouds[4] = (MovingCloud){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), GetRandomDoubleValue(baseY, 0) }, 100.0f, 1.7f, cloud2Texture, false };
-        movingClouds[5] = (MovingCloud){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), GetRandomDoubleValue(baseY, 0) }, 200.0f, 1.0f, cloud3Texture, true };
-        movingClouds[6] = (MovingCloud){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), GetRandomDoubleValue(baseY, 0) }, 150.0f, 1.0f, cloud3Texture, true };
+        if (scenes[currentScene].exit != NULL)
+            scenes[currentScene].exit(camera);
 
-        movingStars[0] = (MovingStar){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), baseY }, 50.0f, 3.0f, star1Texture };
-        movingStars[1] = (MovingStar){ (Vector2) { GetRandomDoubleValue(baseX - 200, baseX), baseY }, 25.0f, 2.0f, star2Texture };
+        ReleaseAssetSet(scenes[currentScene].assets);
+    }
 
-        for (int i = 0; i < 20; i++) {
-            menuFallingItems[i].position = (Vector2){ GetRandomDoubleValue(baseX, baseX + BASE_SCREEN_WIDTH - 20), baseY - GetRandomDoubleValue(200, 1000) };
-            menuFallingItems[i].textureIndex = GetRandomValue(0, menuFallingItemsNumber - 1);
+    currentScene = scene;
 
-            // Random rotation and falling speed
-            menuFallingItems[i].rotation = GetRandomDoubleValue(-360, 360);
-            menuFallingItems[i].fallingSpeed = GetRandomDoubleValue(1, 3);
-            menuFallingItems[i].fallingSpeed *= 100;
+    if (scenes[currentScene].enter != NULL)
+        scenes[currentScene].enter(camera);
 
-            // Rotation speed is between -3 and 3, but should not execeed falling speed and should not be 0
-            menuFallingItems[i].rotationSpeed = GetRandomValue(-3, 3);
-            if (fabsf(menuFallingItems[i].rotationSpeed) > menuFallingItems[i].fallingSpeed)
-                menuFallingItems[i].rotationSpeed = menuFallingItems[i].fallingSpeed;
-            if (menuFallingItems[i].rotationSpeed == 0)
-                menuFallingItems[i].rotationSpeed = 1;
+    // Should stay the same from one round to the next
+    if (isGlobalAssetsLoadFinished)
+        LogAssetUsage("after the scene change");
 
-            menuFallingItems[i].rotationSpeed *= 100;
+    // Do not count the time spent loading the scene as frame time
+    sceneLastFrameTime = GetTime();
+}
 
-        }
-    }
+void UpdateDrawFrame(Camera2D* camera)
+{
+    double frameStartTime = GetTime();
+    UpdateDebugFrameTimeHistory(frameStartTime);
+    ResetSpriteQueueStats();
+    BeginGpuFrame(options->showDebug && debugToolToggles.showStats, options->showDebug && debugToolToggles.showOverdraw, camera->zoom);
+    BeginProfileFrame(options->showDebug && debugToolToggles.showProfiler);
 
-    while (!WindowShouldClose())
-    {
-        // Calculate delta time
-        double deltaTime = GetTime() - lastFrameTime;
-        lastFrameTime = GetTime();
+    PROFILE_BEGIN("Scene change");
+    ApplySceneChange(camera);
 
-        if (!isFadeOutDone)
-            currentTime += GetFrameTime();
+    // An enter callback may immediately hand over to another scene (fast splash)
+    ApplySceneChange(camera);
+    PROFILE_END();
 
-        WindowUpdate(camera);
+    BeginAllocationFrame(currentScene == SCENE_GAME, IsWindowResized(), options->showDebug && debugToolToggles.showStats);
 
-        // Button positions and dimensions
-        Rectangle startButtonRect = { baseX + 50 - transitionOffset, baseY + 600 + 60, 400, 100 };
-        Rectangle optionsButtonRect = { baseX + 50 - transitionOffset, baseY + 600 + 160, 400, 100 };
-        Rectangle exitButtonRect = { baseX + 50 - transitionOffset, baseY + 600 + 350, 400, 100 };
+    // Calculate delta time
+    double deltaTime = fixedFrameTime > 0 ? fixedFrameTime : GetTime() - sceneLastFrameTime;
+    sceneLastFrameTime = GetTime();
 
-        // Convert mouse position from screen space to world space
-        Vector2 mouseWorldPos = GetScreenToWorld2D(GetMousePosition(), *camera);
+    // A replay brings its own frame time
+    PROFILE_BEGIN("Input");
+    UpdateFrameInput(camera, deltaTime);
+    deltaTime = frameInput.deltaTime;
 
-        bool isStartButtonHovered = CheckCollisionPointRec(mouseWorldPos, startButtonRect);
-        bool isOptionsButtonHovered = CheckCollisionPointRec(mouseWorldPos, optionsButtonRect);
-        bool isExitButtonHovered = CheckCollisionPointRec(mouseWorldPos, exitButtonRect);
+    WindowUpdate(camera);
+    PROFILE_END();
 
-        // Check for button clicks
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !isTransitioningOut && !isTransitioningIn)
-        {
-            if (isStartButtonHovered)
-            {
-                PlaySoundFx(FX_SELECT);
-                transitionCallback = GameUpdate;
-                isTransitioningOut = true;
-            }
-            else if (isOptionsButtonHovered)
-            {
-                PlaySoundFx(FX_SELECT);
-                transitionCallback = OptionsUpdate;
-                isTransitioningOut = true;
-            }
-            else if (isExitButtonHovered)
-            {
-                ExitApplication();
-            }
-        }
+    BeginUpdateAllocations();
 
-        // Play sound when hovering over a button, but only once
-        if (isStartButtonHovered)
-        {
-            if (!isHovering || currentHoveredButton != 0)
-            {
-                PlaySoundFx(FX_HOVER);
-                isHovering = true;
-            }
-            currentHoveredButton = 0;
-        }
-        else if (isOptionsButtonHovered)
-        {
-            if (!isHovering || currentHoveredButton != 1)
-            {
-                PlaySoundFx(FX_HOVER);
-                isHovering = true;
-            }
-            currentHoveredButton = 1;
-        }
-        else if (isExitButtonHovered)
-        {
-            if (!isHovering || currentHoveredButton != 2)
-            {
-                PlaySoundFx(FX_HOVER);
-                isHovering = true;
-            }
-            currentHoveredButton = 2;
-        }
-        else
-        {
-            currentHoveredButton = NO_BUTTON;  // Use NO_BUTTON instead of NULL
-            isHovering = false;
-        }
+    PROFILE_BEGIN("Events");
+    RunGameEvents(deltaTime);
+    PROFILE_END();
+
+    PROFILE_BEGIN("Update");
+    scenes[currentScene].update(camera, deltaTime);
+    FinishInputFrame();
+    PROFILE_END();
+
+    EndUpdateAllocations();
 
-        // Draw
+    double updateEndTime = GetTime();
+    frameUpdateTime = updateEndTime - frameStartTime;
 
-        BeginDrawing();
-        BeginMode2D(*camera);
-        ClearBackground(RAYWHITE);
+    // Draw
+    BeginDrawing();
+    BeginMode2D(*camera);
 
-        int imageWidth = backgroundTexture.width;
-        int imageHeight = backgroundTexture.height;
+    PROFILE_BEGIN("Draw");
+    scenes[currentScene].draw(camera, deltaTime);
+    FlushGpuBatch();
+    PROFILE_END();
 
-        float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
-        float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
+    if (gpuCounters.overdraw)
+        DrawOverdrawHeatmap();
+    EndGpuFrame();
 
-        int imageLogoWidth = logoTexture.width;
-        int imageLogoHeight = logoTexture.height;
+    if (options->showDebug)
+    {
+        PROFILE_BEGIN("Debug overlay");
+        DrawDebugOverlay(camera);
+        PROFILE_END();
+    }
 
-        float scaleLogoX = (float)BASE_SCREEN_WIDTH / imageLogoWidth / 4;
-        float scaleLogoY = (float)BASE_SCREEN_HEIGHT / imageLogoHeight / 4;
+    EndMode2D();
 
-        // Draw the background with the scaled dimensions
-        // DrawTextureEx(backgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
-        
-        DrawDayNightCycle(deltaTime);
+    double drawEndTime = GetTime();
+    frameDrawTime = drawEndTime - updateEndTime;
+    frameCpuTime = drawEndTime - frameStartTime;
+    frameCpuTimeAverage += (frameCpuTime - frameCpuTimeAverage) * 0.05;
 
-        // Draw falling items behind the menu
-        DrawMenuFallingItems(deltaTime, true);
+#if defined(PLATFORM_WEB)
+    if (drawEndTime - webCpuReportTime >= WEB_CPU_REPORT_INTERVAL)
+    {
+        Log(LOG_INFO, "Frame CPU %.2f ms average (%s loop)", frameCpuTimeAverage * 1000.0, MAIN_LOOP_NAME);
+        webCpuReportTime = drawEndTime;
+    }
+#endif
 
-        // Draw customer images
-        DrawCustomerInMenu(deltaTime);
+    PROFILE_BEGIN("Present");
+    EndDrawing();
+    PROFILE_END();
+    framePresentTime = GetTime() - drawEndTime;
+    EndProfileFrame();
 
-        DrawTextureEx(backgroundOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+    // Only does anything in builds without threads, elsewhere the flush thread writes the log out
+    FlushLogRing(logRing);
+}
 
-        // Draw falling items in front of the menu
-        DrawMenuFallingItems(deltaTime, false);
+// Benchmark
+// MEOW_BENCH=<csv file> runs fixed scenarios in place of the game and writes one CSV row per scenario, see the bench
+// target in CMakeLists.txt. Frames are not capped and every frame advances the game by 1/60 s, so a run does the
+// same work on any machine. Frame times are in milliseconds, the phases are averages over the scenario.
+#define BENCH_MAX_FRAMES 4096
+#define BENCH_FRAME_TIME (1.0 / 60.0)
+
+typedef struct BenchScenario {
+    const char* name;
+    SceneType scene;
+    int frames;             // The splash ends earlier once loading is done
+    int customerSlots;      // Game only, all of them seated from the first frame
+    bool autoplay;          // The autoplayer drags cups and ingredients
+    double rushInterval;    // Seconds between extra customers that queue for a slot, 0 for none
+} BenchScenario;
+
+// The crowd scenarios play freeplay hard rounds, which never end by themselves. Customers time out and the queue
+// refills their slots while the autoplayer serves, so they time the update, the drag grid and the drawing over every
+// seated customer with the pool churning.
+static const BenchScenario benchScenarios[] = {
+    { "splash_load", SCENE_SPLASH, 1800, 0, false, 0 },
+    { "main_menu", SCENE_MAIN_MENU, 600, 0, false, 0 },
+    { "game_idle", SCENE_GAME, 600, 3, false, 0 },
+    { "game_drag", SCENE_GAME, 1200, 3, true, 0 },
+    { "game_crowd_drag", SCENE_GAME, 1200, 12, true, 0 },
+    { "game_crowd_100", SCENE_GAME, 2400, 100, true, 0.5 },
+    { "game_crowd_1000", SCENE_GAME, 2400, 1000, true, 0.05 },
+    { "endgame", SCENE_ENDGAME, 300, 0, false, 0 },
+};
 
-        // If transitioning out, move the background to the left
-        if (isTransitioningOut)
-        {
-            float pixelsToMove = 900.0f;
-            float durationInSeconds = 0.6f;
-            float transitionSpeed = pixelsToMove / durationInSeconds;
+typedef struct BenchFrame {
+    double frame;
+    double update;
+    double draw;
+    double present;
+    int customers;          // Seated
+    int queued;
+} BenchFrame;
 
-            transitionOffset += transitionSpeed * deltaTime;
+BenchFrame benchFrames[BENCH_MAX_FRAMES];
 
-            if (transitionOffset >= BASE_SCREEN_WIDTH / 2)
-            {
-                transitionOffset = 0;
-                isTransitioningOut = false;
-                transitionCallback(camera);
-                break;
-            }
-        }
+void WriteBenchRow(FILE* file, const char* name, int frameCount)
+{
+    static double sorted[BENCH_MAX_FRAMES];
+    double total = 0, update = 0, draw = 0, present = 0, customers = 0, queued = 0;
 
-        // If transitioning in, move the background to the right
-        if (isTransitioningIn)
-        {
-            float pixelsToMove = 900.0f;
-            float durationInSeconds = 0.6f;
-            float transitionSpeed = pixelsToMove / durationInSeconds;
+    for (int i = 0; i < frameCount; i++)
+    {
+        sorted[i] = benchFrames[i].frame;
+        total += benchFrames[i].frame;
+        update += benchFrames[i].update;
+        draw += benchFrames[i].draw;
+        present += benchFrames[i].present;
+        customers += benchFrames[i].customers;
+        queued += benchFrames[i].queued;
+    }
 
-            transitionOffset -= transitionSpeed * deltaTime;
+    qsort(sorted, frameCount, sizeof(double), CompareDoubles);
 
-            if (transitionOffset <= 0)
-            {
-                transitionOffset = 0;
-                isTransitioningIn = false;
-            }
-        }
+    double count = frameCount > 0 ? frameCount : 1;
+    double max = frameCount > 0 ? sorted[frameCount - 1] : 0;
+    double p50 = frameCount > 0 ? GetPercentile(sorted, frameCount, 50) : 0;
+    double p95 = frameCount > 0 ? GetPercentile(sorted, frameCount, 95) : 0;
+    double p99 = frameCount > 0 ? GetPercentile(sorted, frameCount, 99) : 0;
 
+    fprintf(file, "%s,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.1f,%.1f\n", name, frameCount, total / count * 1000.0, p50 * 1000.0, p95 * 1000.0, p99 * 1000.0, max * 1000.0, update / count * 1000.0, draw / count * 1000.0, present / count * 1000.0, customers / count, queued / count);
+    Log(LOG_INFO, "Bench %-16s %5d frames, mean %.3f ms, p99 %.3f ms, max %.3f ms", name, frameCount, total / count * 1000.0, p99 * 1000.0, max * 1000.0);
+}
 
-        // Left sidebar white 
-        DrawTextureEx(backgroundOverlaySidebarTexture, (Vector2) { baseX - transitionOffset, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
+// Runs from the splash that main() already queued, returns false if the CSV could not be written
+bool RunBenchmarkSuite(Camera2D* camera, const char* csvPath)
+{
+    FILE* file = fopen(csvPath, "w");
+    if (file == NULL)
+    {
+        Log(LOG_ERROR, "Cannot write benchmark results to %s", csvPath);
+        return false;
+    }
 
-        // Logo
-        DrawTextureEx(logoTexture, (Vector2) { baseX - transitionOffset, baseY - 50 }, 0.0f, fmax(scaleLogoX, scaleLogoY), WHITE);
+    fprintf(file, "scenario,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,update_ms,draw_ms,present_ms,customers,queued\n");
 
-        // Draw button labels
-        DrawTextEx(meowFont, "Start Game", (Vector2) { (int)(startButtonRect.x + 40), (int)(startButtonRect.y + 15) }, 60, 2, isStartButtonHovered ? MAIN_ORANGE : MAIN_BROWN);
-        DrawTextEx(meowFont, "Settings", (Vector2) { (int)(optionsButtonRect.x + 40), (int)(optionsButtonRect.y + 15) }, 60, 2, isOptionsButtonHovered ? MAIN_ORANGE : MAIN_BROWN);
-        DrawTextEx(meowFont, "Exit", (Vector2) { (int)(exitButtonRect.x + 40), (int)(exitButtonRect.y + 15) }, 60, 2, isExitButtonHovered ? MAIN_ORANGE : MAIN_BROWN);
+    SetTargetFPS(0);
+    fixedFrameTime = BENCH_FRAME_TIME;
+    options->soundFxEnabled = false;
+    options->musicEnabled = false;
 
-        // Draw debug
-        if (options->showDebug && debugToolToggles.showObjects)
-        {
-            DrawRectangleLinesEx(startButtonRect, 1, RED);
-            DrawRectangleLinesEx(optionsButtonRect, 1, RED);
-            DrawRectangleLinesEx(exitButtonRect, 1, RED);
-        }
+    Difficulty difficulty = options->difficulty;
+    SeedRandomStreams(1);
 
-        DrawOuterWorld();
+    for (int i = 0; i < (int)(sizeof(benchScenarios) / sizeof(benchScenarios[0])) && !WindowShouldClose(); i++)
+    {
+        const BenchScenario* scenario = &benchScenarios[i];
+        autoplayer.enabled = scenario->autoplay;
+        options->difficulty = scenario->rushInterval > 0 ? FREEPLAY_HARD : difficulty;
 
-        // Calculate alpha based on the current time
-        if (playFade)
+        if (currentScene != scenario->scene)
         {
-            float alpha = (float)(255.0 * (1.0 - fmin(currentTime / fadeOutDuration, 1.0)));
-            if (!isFadeOutDone && alpha != 0)
-                DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(splashBackgroundScaleX, splashBackgroundScaleY), (Color) { 255, 255, 255, alpha });
-            else
-                isFadeOutDone = true;
+            ChangeScene(scenario->scene);
+            ApplySceneChange(camera);
         }
 
+        if (scenario->customerSlots > 0)
+        {
+            float spacing = 1800.0f / scenario->customerSlots;
+            InitCustomerPool(&customerPool, scenario->customerSlots, (Vector2) { baseX + 50, baseY + 100 }, spacing, scenario->rushInterval);
+            for (int slot = 0; slot < scenario->customerSlots; slot++)
+                SeatCustomer(&customerPool, SpawnCustomer(&customerPool), slot);
+        }
 
-        if(options->showDebug)
-            DrawDebugOverlay(camera);
+        int frameCount = 0;
+        int frames = scenario->frames < BENCH_MAX_FRAMES ? scenario->frames : BENCH_MAX_FRAMES;
+        while (frameCount < frames && !WindowShouldClose())
+        {
+            double start = GetTime();
+            UpdateDrawFrame(camera);
+
+            benchFrames[frameCount].frame = GetTime() - start;
+            benchFrames[frameCount].update = frameUpdateTime;
+            benchFrames[frameCount].draw = frameDrawTime;
+            benchFrames[frameCount].present = framePresentTime;
+            benchFrames[frameCount].customers = customerPool.activeCount;
+            benchFrames[frameCount].queued = customerPool.waitingCount;
+            frameCount++;
+
+            // The splash is over once it handed over to the main menu
+            if (scenario->scene == SCENE_SPLASH && (currentScene != SCENE_SPLASH || nextScene != SCENE_NONE))
+                break;
+        }
 
-        EndMode2D();
-        EndDrawing();
+        WriteBenchRow(file, scenario->name, frameCount);
     }
 
-    UnloadTexture(backgroundTexture);
-    CloseWindow();
+    autoplayer.enabled = false;
+    options->difficulty = difficulty;
+    fixedFrameTime = 0;
+    fclose(file);
+    Log(LOG_INFO, "Benchmark results written to %s", csvPath);
+    return true;
+}
 
-    // Execute transition if set
-    if (transitionCallback != NULL)
+#if USE_BROWSER_MAIN_LOOP
+// Called once per browser animation frame, every scene resumes from its saved state
+void UpdateDrawFrameWeb(void* arg)
+{
+    if (applicationShouldExit)
     {
-        transitionCallback(camera);
+        emscripten_cancel_main_loop();
+        return;
     }
+
+    UpdateDrawFrame((Camera2D*)arg);
 }
+#endif
 
-void SplashUpdate(Camera2D* camera)
+// Headless simulation
+// Plays a round on a simulated clock without a window, audio or assets, as fast as the CPU allows. A simulated
+// barista makes the drink of the customer closest to running out of patience, one ingredient per step, boils the
+// kettle when the drink needs water and serves it through the same code as a drop on the customer.
+#define SIMULATION_STEP (1.0 / 60.0)
+#define SIMULATION_BARISTA_STEP 1.5
+
+typedef struct SimulatedBarista {
+    double stepTime;        // Seconds to add one ingredient or to hand over the drink
+    double busyTime;        // Until the current step is done
+    int customer;           // Pool index of the customer being served, -1 when idle
+    uint32_t generation;    // Of that customer, a change means they left before the drink was done
+    int drinksTrashed;
+} SimulatedBarista;
+
+void UpdateSimulatedBarista(SimulatedBarista* barista, Cup* cup, CustomerPool* pool, double deltaTime)
 {
-#if DEBUG_FASTLOAD
-    const double beforeStart = 0;
-    double splashDuration = 0;
-    const double fadeInDuration = 0;
-    const double stayDuration = 0;
-    const double fadeOutDuration = 0;
-    const double afterEnd = 0;
+    // The customer ran out of patience, the half made drink goes into the trash
+    if (barista->customer >= 0 && pool->entries[barista->customer].generation != barista->generation)
+    {
+        cup->contents = DRINK_EMPTY;
+        cup->active = false;
+        barista->customer = -1;
+        barista->drinksTrashed++;
+    }
 
-    LoadGlobalAssets();
-    MainMenuUpdate(camera, true);
-#else
-    const double beforeStart = 1.0;
-    double splashDuration = 8.0;
-    const double fadeInDuration = 2.0;
-    const double stayDuration = 3.0;
-    const double fadeOutDuration = 2.0;
-    const double afterEnd = 2.0;
-#endif
+    barista->busyTime -= deltaTime;
+    if (barista->busyTime > 0)
+        return;
 
-    double startTime = GetTime();
-    double currentTime = 0;
+    if (barista->customer < 0)
+    {
+        barista->customer = FindMostImpatientCustomer(pool);
+        if (barista->customer < 0)
+            return;
 
-    int imageWidth = splashBackgroundTexture.width;
-    int imageHeight = splashBackgroundTexture.height;
+        barista->generation = pool->entries[barista->customer].generation;
+        cup->contents = DRINK_EMPTY;
+        cup->active = true;
+    }
 
-    float scaleX = (float)BASE_SCREEN_WIDTH / imageWidth;
-    float scaleY = (float)BASE_SCREEN_HEIGHT / imageHeight;
+    Drink order = pool->entries[barista->customer].order;
 
-    BeginDrawing();
-    BeginMode2D(*camera);
-    ClearBackground(RAYWHITE);
+    DrinkSlot next = DRINK_POWDER;
+    while (next < DRINK_SLOT_COUNT && (!HasDrinkSlot(order, next) || HasDrinkSlot(cup->contents, next)))
+        next++;
 
-    if (options->showDebug)
-        DrawDebugOverlay(camera);
+    if (next == DRINK_SLOT_COUNT)
+    {
+        ServeCup(cup, pool, barista->customer);
+        barista->customer = -1;
+        barista->busyTime = barista->stepTime;
+        return;
+    }
 
-    EndMode2D();
-    EndDrawing();
+    IngredientId id = FindIngredientForSlot(order, next);
+    Ingredient* item = &ingredients[id];
 
-    while (currentTime < beforeStart)
+    // Wait for the kettle
+    if (!item->canChangeCupTexture)
     {
-        WindowUpdate(camera);
-        currentTime = GetTime() - startTime;
+        if (!triggerHotWater)
+            boilWater(item);
+        return;
+    }
 
-        BeginDrawing();
-        BeginMode2D(*camera);
-        float alpha = (float)(255.0 * (1.0 - fmin(currentTime / beforeStart, 1.0)));
+    if (UpdateCup(cup, id) && (ingredientTable[id].flags & INGREDIENT_BOILS))
+        StopBoiling(item);
 
-        DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
-        DrawRectangle(baseX, baseY, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, (Color) { 255, 255, 255, alpha });
+    barista->busyTime = barista->stepTime;
+}
 
-        if (options->showDebug)
-            DrawDebugOverlay(camera);
+// Runs one round of the given length and prints the score and customer statistics
+// A rush interval above 0 sends an extra customer into the queue every that many seconds
+void RunHeadlessSimulation(Difficulty difficulty, unsigned int seed, double duration, double rushInterval)
+{
+    options->difficulty = difficulty;
+    SeedRandomStreams(seed);
 
-        EndMode2D();
-        EndDrawing();
-    }
+    // Only the logic state, nothing that needs the atlas or a texture
+    for (int i = 0; i < INGREDIENT_COUNT; i++)
+        ingredients[i] = (Ingredient){ .canChangeCupTexture = IsIngredientReady(&ingredientTable[i]), .currentFrame = 1 };
 
-    const Sound systemLoad = LoadSound(ASSETS_PATH"audio/Meow1.mp3");
-    PlaySound(systemLoad);
+    Cup cup = { .contents = DRINK_EMPTY };
+    SimulatedBarista barista = { .stepTime = SIMULATION_BARISTA_STEP, .customer = -1 };
 
-    bool doLoadGlobalAssets = true;
+    global_score = 0;
+    sessionStats = (SessionStats){ 0 };
+    InitCustomerPool(&customerPool, 3, (Vector2) { baseX + 50, baseY + 100 }, 600, rushInterval);
 
-    // Reset time
-    startTime = GetTime();
+    int frames = (int)(duration / SIMULATION_STEP);
+    clock_t start = clock();
 
-    while (currentTime < splashDuration)
+    for (int frame = 0; frame < frames; frame++)
     {
-        WindowUpdate(camera);
-        currentTime = GetTime() - startTime;
+        BeginAllocationFrame(true, false, false);
+        BeginUpdateAllocations();
+        RunGameEvents(SIMULATION_STEP);
+        UpdateSimulatedBarista(&barista, &cup, &customerPool, SIMULATION_STEP);
+        EndUpdateAllocations();
+    }
 
-        int alpha = 0;
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    int finished = sessionStats.ordersServed + sessionStats.timeouts;
 
-        // Calculate alpha based on the current time
-        if (currentTime < fadeInDuration) {
-            // Fading in
-            alpha = (int)(255.0 * (currentTime / fadeInDuration));
-        }
-        else if (currentTime < fadeInDuration + stayDuration) {
-            // Fully visible (staying)
-            alpha = 255;
-            if(doLoadGlobalAssets)
-			{
-				LoadGlobalAssets();
-				doLoadGlobalAssets = false;
-			}
-        }
-        else {
-            // Fading out
-            alpha = (int)(255.0 * (1.0 - fmin((currentTime - fadeInDuration - stayDuration) / fadeOutDuration, 1.0)));
-        }
+    printf("Difficulty %s, seed %u, %.0f s simulated in %.3f s (%d frames)\n", StringFromDifficultyEnum(difficulty), seed, duration, elapsed, frames);
+    printf("Score            %d\n", global_score);
+    printf("Customers seated %d, still at the counter %d\n", sessionStats.customersSeated, customerPool.activeCount);
+    if (rushInterval > 0)
+        printf("Rush every %.1f s, %d queued, longest queue %d, still waiting %d\n", rushInterval, sessionStats.customersQueued, sessionStats.longestQueue, customerPool.waitingCount);
+    printf("Orders served    %d, wrong %d, average wait %.1f s\n", sessionStats.ordersServed, sessionStats.wrongOrders, sessionStats.ordersServed > 0 ? sessionStats.servedWaitTime / sessionStats.ordersServed : 0.0);
+    printf("Timeouts         %d (%.1f%% of finished customers), drinks trashed %d\n", sessionStats.timeouts, finished > 0 ? 100.0 * sessionStats.timeouts / finished : 0.0, barista.drinksTrashed);
 
-        // Extends splash screen duration if loading takes too long
-        if (currentTime > fadeInDuration + stayDuration && doLoadGlobalAssets)
-		{
-			splashDuration += 0.1;
-		}
+    ClearScheduler(&gameEvents);
+}
 
-        BeginDrawing();
-        BeginMode2D(*camera);
-        ClearBackground(RAYWHITE);
-        DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
-        DrawTextureEx(splashOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), (Color) { 255, 255, 255, alpha });
-        
-        if (options->showDebug)
-            DrawDebugOverlay(camera);
+#if defined(MEOW_HEADLESS)
+// meow_sim, the game logic without a window, see the meow_sim target in CMakeLists.txt
+int main(int argc, char** argv)
+{
+    static const char* difficultyNames[] = { "easy", "medium", "hard", "freeplay_easy", "freeplay_medium", "freeplay_hard" };
+    const int difficultyCount = (int)(sizeof(difficultyNames) / sizeof(difficultyNames[0]));
 
-        EndMode2D();
-        EndDrawing();
+    int difficulty = -1;
+    for (int i = 0; argc > 1 && i < difficultyCount; i++)
+    {
+        if (strcmp(argv[1], difficultyNames[i]) == 0)
+            difficulty = i;
     }
 
-    // Reset time
-    startTime = GetTime();
-
-
-    while (currentTime < afterEnd)
+    double rushInterval = argc > 4 ? atof(argv[4]) : 0.0;
+    if (argc < 4 || difficulty < 0 || atof(argv[3]) <= 0 || rushInterval < 0)
     {
-        WindowUpdate(camera);
-        currentTime = GetTime() - startTime;
-
-        BeginDrawing();
-        BeginMode2D(*camera);
-        ClearBackground(RAYWHITE);
-        DrawTextureEx(splashBackgroundTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
-        DrawTextureEx(splashOverlayTexture, (Vector2) { baseX, baseY }, 0.0f, fmax(scaleX, scaleY), WHITE);
-        EndMode2D();
-        EndDrawing();
+        fprintf(stderr, "Usage: %s <easy|medium|hard|freeplay_easy|freeplay_medium|freeplay_hard> <seed> <seconds> [rush interval]\n", argv[0]);
+        return 1;
     }
 
-    // UnloadSound(systemLoad);
+    minimumLogLevel = LOG_WARNING;
+    SetTraceLogCallback(CustomLogger);
 
-    MainMenuUpdate(camera, true);
-}
+    GameOptions _options = { 0 };
+    _options.soundFxEnabled = false;
+    _options.musicEnabled = false;
+    options = &_options;
 
-int main(void)
+    InitAllocationTracker();
+    RunHeadlessSimulation((Difficulty)difficulty, (unsigned int)strtoul(argv[2], NULL, 10), atof(argv[3]), rushInterval);
+    return 0;
+}
+#else
+int main(int argc, char** argv)
 {
-    // Initialize random seed once at program start
-    srand(time(NULL));
+    // Every session starts from a new seed, unless a recording, the autoplayer or the benchmark picks one
+    SeedRandomStreams((uint64_t)time(NULL));
     
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     SetConfigFlags(FLAG_MSAA_4X_HINT);
 
+    OpenLogRing();
     SetTraceLogCallback(CustomLogger);
+
+    // MEOW_LOADER_THREADS=0 decodes on the main thread, to compare cold starts against the worker threads
+    const char* loaderThreads = getenv("MEOW_LOADER_THREADS");
+    assetLoader.pool = CreateTaskPool(loaderThreads != NULL ? atoi(loaderThreads) : GetDefaultTaskThreadCount());
+
     InitWindow(BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, "SuperMeowMeow");
+
+    // MEOW_ARCHIVE=0 loads every file on its own, to compare startup time and memory with the archive
+    const char* useArchive = getenv("MEOW_ARCHIVE");
+    if (useArchive == NULL || atoi(useArchive) != 0)
+    {
+        assetArchive = OpenAssetArchive(ARCHIVE_PATH);
+        if (assetArchive != NULL)
+            Log(LOG_INFO, "Asset archive %s %s, %.1f MB", ARCHIVE_PATH, IsAssetArchiveMapped(assetArchive) ? "mapped" : "read", GetAssetArchiveSize(assetArchive) / (1024.0 * 1024.0));
+        else if (FileExists(ARCHIVE_PATH))
+            Log(LOG_WARNING, "Asset archive %s is damaged or out of date, loading individual files", ARCHIVE_PATH);
+    }
+    InitGpuCounters();
     InitAudioDevice();
     // Center of screen
     SetWindowPosition(200, 200);
 
-    Camera2D camera = { 0 };
+    // Static, like the options below, so they outlive main() when the browser owns the loop
+    static Camera2D camera = { 0 };
     camera.target = (Vector2){ 0.0f, 0.0f };
     camera.offset = (Vector2){ BASE_SCREEN_WIDTH / 2.0f, BASE_SCREEN_HEIGHT / 2.0f };
     camera.rotation = 0.0f;
     camera.zoom = 1.0f;
 
-    GameOptions _options;
+    static GameOptions _options = { 0 };
     _options.difficulty = EASY;
 
 #ifdef IS_WEB
@@ -3485,21 +7017,69 @@ int main(void)
 
     options = &_options;
 
-    SetTargetFPS(options->targetFps);
+    ApplyTargetFps(options->targetFps);
     SetRuntimeResolution(&camera, options->resolution.x, options->resolution.y);
 
+    OpenInputRecorder();
+    InitAutoplayer();
+    OpenProfilerTrace(argc, argv);
+    InitAllocationTracker();
+    const char* replayFast = getenv("MEOW_REPLAY_FAST");
+    if (inputRecorder.mode == INPUT_REPLAYING && replayFast != NULL && atoi(replayFast) != 0)
+        ApplyTargetFps(0);
+
 
     meowFont = LoadFontEx(ASSETS_PATH"font/SantJoanDespi-Regular.otf", 256, 0, 250);
     SetTextureFilter(meowFont.texture, TEXTURE_FILTER_ANISOTROPIC_4X);
 
-    logoTexture = LoadTexture(ASSETS_PATH"image/elements/studio_logo.png");
-    splashBackgroundTexture = LoadTexture(ASSETS_PATH"image/backgrounds/splash.png");
-    splashOverlayTexture = LoadTexture(ASSETS_PATH"image/backgrounds/splash_overlay.png");
+    logoTexture = LoadAssetTexture(ASSETS_PATH"image/elements/studio_logo.png");
+    splashBackgroundTexture = LoadAssetTexture(ASSETS_PATH"image/backgrounds/splash.png");
+    splashOverlayTexture = LoadAssetTexture(ASSETS_PATH"image/backgrounds/splash_overlay.png");
 
 
     SetExitKey(KEY_NULL);
 
-    SplashUpdate(&camera);
+    ChangeScene(SCENE_SPLASH);
+
+#if USE_BROWSER_MAIN_LOOP
+    // Never returns, the browser calls UpdateDrawFrameWeb at its own refresh rate
+    emscripten_set_main_loop_arg(UpdateDrawFrameWeb, &camera, 0, 1);
+#else
+    const char* benchPath = getenv("MEOW_BENCH");
+    if (benchPath != NULL)
+    {
+        RunBenchmarkSuite(&camera, benchPath);
+        applicationShouldExit = true;
+    }
+
+    // One loop drives every scene, the stack stays flat no matter how many rounds are played
+    while (!WindowShouldClose() && !applicationShouldExit)
+    {
+        UpdateDrawFrame(&camera);
+    }
+#endif
+
+    // Nothing may still be on its way into a global that is about to be unloaded
+    FlushAssetLoader();
+
+    if (currentScene != SCENE_NONE)
+    {
+        if (scenes[currentScene].exit != NULL)
+            scenes[currentScene].exit(&camera);
+
+        ReleaseAssetSet(scenes[currentScene].assets);
+    }
+
+    CloseInputRecorder();
+    CloseProfilerTrace();
+    ReportAssetLeaks();
     UnloadGlobalAssets();
+    DestroyTaskPool(assetLoader.pool);
+    CloseAssetArchive(assetArchive);
+    CloseAudioDevice();
+    UnloadGpuCounters();
+    CloseWindow();
+    CloseLogRing();
     return 0;
 }
+#endif
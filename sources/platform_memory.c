@@ -0,0 +1,79 @@
+// sysconf is not part of strict C99 with glibc
+#define _DEFAULT_SOURCE
+
+#include "platform_memory.h"
+
+#include <stdio.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#elif defined(__EMSCRIPTEN__)
+#include <malloc.h>
+#else
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#endif
+
+size_t GetResidentMemoryBytes(void)
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return (size_t)counters.WorkingSetSize;
+    return 0;
+#elif defined(__APPLE__)
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+        return (size_t)info.resident_size;
+    return 0;
+#elif defined(__EMSCRIPTEN__)
+    return 0;
+#else
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == NULL)
+        return 0;
+
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    int read = fscanf(file, "%lu %lu", &pages, &resident);
+    fclose(file);
+
+    return read == 2 ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+size_t GetHeapBytesInUse(void)
+{
+#if defined(_WIN32)
+    // The heap malloc allocates from, HeapSummary needs Windows 7
+    HEAP_SUMMARY summary = { 0 };
+    summary.cb = sizeof(summary);
+    if (HeapSummary((HANDLE)_get_heap_handle(), 0, &summary))
+        return (size_t)summary.cbAllocated;
+    return 0;
+#elif defined(__APPLE__)
+    malloc_statistics_t statistics;
+    malloc_zone_statistics(NULL, &statistics);
+    return statistics.size_in_use;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__) || defined(__EMSCRIPTEN__)
+    // Fields are int before glibc 2.33 and wrap past 2 GB, far more than the game uses
+    struct mallinfo info = mallinfo();
+    return (size_t)(unsigned int)info.uordblks + (size_t)(unsigned int)info.hblkhd;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,15 @@
+// Platform memory, what the process holds according to the system and the C allocator
+// Both figures cover the whole process: the loader workers, the log flush thread and raylib's audio thread included.
+
+#ifndef PLATFORM_MEMORY_H
+#define PLATFORM_MEMORY_H
+
+#include <stddef.h>
+
+// Resident set size of the process, 0 where the platform does not report it
+size_t GetResidentMemoryBytes(void);
+
+// Bytes malloc handed out and that were not freed yet, 0 where the allocator does not report it
+size_t GetHeapBytesInUse(void);
+
+#endif
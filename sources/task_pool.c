@@ -0,0 +1,363 @@
+#include "task_pool.h"
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef CRITICAL_SECTION PoolLock;
+typedef CONDITION_VARIABLE PoolCondition;
+typedef HANDLE PoolThread;
+
+#define POOL_THREADS 1
+#elif defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+// Single threaded web build, the main thread runs every task
+typedef int PoolLock;
+typedef int PoolCondition;
+typedef int PoolThread;
+
+#define POOL_THREADS 0
+#else
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_mutex_t PoolLock;
+typedef pthread_cond_t PoolCondition;
+typedef pthread_t PoolThread;
+
+#define POOL_THREADS 1
+#endif
+
+#define TASK_POOL_MAX_THREADS 16
+
+typedef struct Task {
+    TaskFunction function;
+    void* data;
+} Task;
+
+struct TaskPool {
+    PoolLock lock;
+    PoolCondition wake;
+    PoolThread threads[TASK_POOL_MAX_THREADS];
+    int threadCount;
+    bool stopping;
+
+    Task pending[TASK_POOL_CAPACITY];
+    int pendingStart;
+    int pendingCount;
+
+    void* completed[TASK_POOL_CAPACITY];
+    int completedStart;
+    int completedCount;
+
+    // Queued, running and completed but not popped yet
+    int outstanding;
+};
+
+static void InitLock(PoolLock* lock)
+{
+#if defined(_WIN32)
+    InitializeCriticalSection(lock);
+#elif POOL_THREADS
+    pthread_mutex_init(lock, NULL);
+#else
+    (void)lock;
+#endif
+}
+
+static void DestroyLock(PoolLock* lock)
+{
+#if defined(_WIN32)
+    DeleteCriticalSection(lock);
+#elif POOL_THREADS
+    pthread_mutex_destroy(lock);
+#else
+    (void)lock;
+#endif
+}
+
+static void Lock(PoolLock* lock)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(lock);
+#elif POOL_THREADS
+    pthread_mutex_lock(lock);
+#else
+    (void)lock;
+#endif
+}
+
+static void Unlock(PoolLock* lock)
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(lock);
+#elif POOL_THREADS
+    pthread_mutex_unlock(lock);
+#else
+    (void)lock;
+#endif
+}
+
+static void InitCondition(PoolCondition* condition)
+{
+#if defined(_WIN32)
+    InitializeConditionVariable(condition);
+#elif POOL_THREADS
+    pthread_cond_init(condition, NULL);
+#else
+    (void)condition;
+#endif
+}
+
+static void DestroyCondition(PoolCondition* condition)
+{
+#if defined(_WIN32)
+    (void)condition;
+#elif POOL_THREADS
+    pthread_cond_destroy(condition);
+#else
+    (void)condition;
+#endif
+}
+
+static void WaitCondition(PoolCondition* condition, PoolLock* lock)
+{
+#if defined(_WIN32)
+    SleepConditionVariableCS(condition, lock, INFINITE);
+#elif POOL_THREADS
+    pthread_cond_wait(condition, lock);
+#else
+    (void)condition;
+    (void)lock;
+#endif
+}
+
+static void WakeOne(PoolCondition* condition)
+{
+#if defined(_WIN32)
+    WakeConditionVariable(condition);
+#elif POOL_THREADS
+    pthread_cond_signal(condition);
+#else
+    (void)condition;
+#endif
+}
+
+static void WakeAll(PoolCondition* condition)
+{
+#if defined(_WIN32)
+    WakeAllConditionVariable(condition);
+#elif POOL_THREADS
+    pthread_cond_broadcast(condition);
+#else
+    (void)condition;
+#endif
+}
+
+// Both take the pool lock held
+static bool PopPending(TaskPool* pool, Task* task)
+{
+    if (pool->pendingCount == 0)
+        return false;
+
+    *task = pool->pending[pool->pendingStart];
+    pool->pendingStart = (pool->pendingStart + 1) % TASK_POOL_CAPACITY;
+    pool->pendingCount--;
+    return true;
+}
+
+static void PushCompleted(TaskPool* pool, void* data)
+{
+    int index = (pool->completedStart + pool->completedCount) % TASK_POOL_CAPACITY;
+    pool->completed[index] = data;
+    pool->completedCount++;
+}
+
+#if POOL_THREADS
+#if defined(_WIN32)
+static DWORD WINAPI TaskWorker(LPVOID argument)
+#else
+static void* TaskWorker(void* argument)
+#endif
+{
+    TaskPool* pool = (TaskPool*)argument;
+    Task task;
+
+    Lock(&pool->lock);
+
+    for (;;)
+    {
+        while (!pool->stopping && pool->pendingCount == 0)
+            WaitCondition(&pool->wake, &pool->lock);
+
+        if (pool->stopping)
+            break;
+
+        PopPending(pool, &task);
+        Unlock(&pool->lock);
+
+        task.function(task.data);
+
+        Lock(&pool->lock);
+        PushCompleted(pool, task.data);
+    }
+
+    Unlock(&pool->lock);
+    return 0;
+}
+#endif
+
+int GetDefaultTaskThreadCount(void)
+{
+    int processors = 1;
+
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    processors = (int)info.dwNumberOfProcessors;
+#elif POOL_THREADS
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online > 0)
+        processors = (int)online;
+#else
+    return 0;
+#endif
+
+    int threads = processors - 1;
+    if (threads < 1)
+        threads = 1;
+    if (threads > TASK_POOL_MAX_THREADS)
+        threads = TASK_POOL_MAX_THREADS;
+    return threads;
+}
+
+TaskPool* CreateTaskPool(int threadCount)
+{
+    TaskPool* pool = (TaskPool*)calloc(1, sizeof(TaskPool));
+    if (pool == NULL)
+        return NULL;
+
+    InitLock(&pool->lock);
+    InitCondition(&pool->wake);
+
+    if (threadCount < 0)
+        threadCount = 0;
+    if (threadCount > TASK_POOL_MAX_THREADS)
+        threadCount = TASK_POOL_MAX_THREADS;
+#if !POOL_THREADS
+    threadCount = 0;
+#endif
+
+    for (int i = 0; i < threadCount; i++)
+    {
+#if defined(_WIN32)
+        pool->threads[i] = CreateThread(NULL, 0, TaskWorker, pool, 0, NULL);
+        if (pool->threads[i] == NULL)
+            break;
+#elif POOL_THREADS
+        if (pthread_create(&pool->threads[i], NULL, TaskWorker, pool) != 0)
+            break;
+#endif
+        pool->threadCount++;
+    }
+
+    return pool;
+}
+
+void DestroyTaskPool(TaskPool* pool)
+{
+    if (pool == NULL)
+        return;
+
+    Lock(&pool->lock);
+    pool->stopping = true;
+    WakeAll(&pool->wake);
+    Unlock(&pool->lock);
+
+    for (int i = 0; i < pool->threadCount; i++)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#elif POOL_THREADS
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+    DestroyCondition(&pool->wake);
+    DestroyLock(&pool->lock);
+    free(pool);
+}
+
+int GetTaskPoolThreadCount(TaskPool* pool)
+{
+    return pool != NULL ? pool->threadCount : 0;
+}
+
+bool SubmitTask(TaskPool* pool, TaskFunction function, void* data)
+{
+    if (pool == NULL || function == NULL)
+        return false;
+
+    Lock(&pool->lock);
+
+    if (pool->outstanding >= TASK_POOL_CAPACITY)
+    {
+        Unlock(&pool->lock);
+        return false;
+    }
+
+    int index = (pool->pendingStart + pool->pendingCount) % TASK_POOL_CAPACITY;
+    pool->pending[index] = (Task){ function, data };
+    pool->pendingCount++;
+    pool->outstanding++;
+
+    WakeOne(&pool->wake);
+    Unlock(&pool->lock);
+    return true;
+}
+
+bool RunPendingTask(TaskPool* pool)
+{
+    if (pool == NULL)
+        return false;
+
+    Task task;
+
+    Lock(&pool->lock);
+    bool found = PopPending(pool, &task);
+    Unlock(&pool->lock);
+
+    if (!found)
+        return false;
+
+    task.function(task.data);
+
+    Lock(&pool->lock);
+    PushCompleted(pool, task.data);
+    Unlock(&pool->lock);
+    return true;
+}
+
+bool PopCompletedTask(TaskPool* pool, void** data)
+{
+    if (pool == NULL)
+        return false;
+
+    Lock(&pool->lock);
+
+    if (pool->completedCount == 0)
+    {
+        Unlock(&pool->lock);
+        return false;
+    }
+
+    *data = pool->completed[pool->completedStart];
+    pool->completedStart = (pool->completedStart + 1) % TASK_POOL_CAPACITY;
+    pool->completedCount--;
+    pool->outstanding--;
+
+    Unlock(&pool->lock);
+    return true;
+}
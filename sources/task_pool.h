@@ -0,0 +1,35 @@
+// Task pool, a few worker threads for background jobs such as decoding assets
+// Lives outside main.c because windows.h and raylib.h cannot be included in the same file.
+//
+// Tasks are submitted from the main thread. Finished tasks are collected with PopCompletedTask, again on the
+// main thread, so anything that must not run on a worker (GPU uploads, audio device calls) happens there.
+// A pool created with 0 threads (always the case on web builds without pthreads) never runs anything by
+// itself, the main thread drives it with RunPendingTask.
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <stdbool.h>
+
+#define TASK_POOL_CAPACITY 256
+
+typedef void (*TaskFunction)(void* data);
+
+typedef struct TaskPool TaskPool;
+
+// Number of logical processors minus the main thread, at least 1 where threads are available
+int GetDefaultTaskThreadCount(void);
+
+TaskPool* CreateTaskPool(int threadCount);
+// Waits for running tasks to finish, queued tasks are dropped
+void DestroyTaskPool(TaskPool* pool);
+int GetTaskPoolThreadCount(TaskPool* pool);
+
+// Fails when TASK_POOL_CAPACITY tasks are queued, running or waiting to be popped
+bool SubmitTask(TaskPool* pool, TaskFunction function, void* data);
+// Runs one queued task on the calling thread, returns false when nothing was queued
+bool RunPendingTask(TaskPool* pool);
+// Returns the data of one finished task, false when none finished since the last call
+bool PopCompletedTask(TaskPool* pool, void** data);
+
+#endif